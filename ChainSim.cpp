@@ -1,4 +1,6 @@
 #include "ChainSim.h"
+#include <algorithm>
+#include <cmath>
 
 qz::ChainSim::ChainSim() : QObject()
 {
@@ -11,21 +13,109 @@ qz::ChainSim::ChainSim() : QObject()
         QStringLiteral("lost_sale_quantity")};
 }
 
+namespace
+{
+    std::unique_ptr<qz::DemandSampler> make_demand_sampler(const qz::ChainSimConfig &config)
+    {
+        if (config.deterministic)
+        {
+            return std::make_unique<qz::FixedDemandSampler>(config.average_demand);
+        }
+
+        switch (config.demand_distribution)
+        {
+        case qz::DemandDistribution::Fixed:
+            return std::make_unique<qz::FixedDemandSampler>(config.average_demand);
+        case qz::DemandDistribution::Normal:
+            return std::make_unique<qz::NormalDemandSampler>(config.average_demand, config.demand_stddev, config.seed);
+        case qz::DemandDistribution::Gamma:
+            return std::make_unique<qz::GammaDemandSampler>(config.gamma_shape, config.gamma_scale, config.seed);
+        case qz::DemandDistribution::Poisson:
+            return std::make_unique<qz::PoissonDemandSampler>(config.average_demand, config.seed);
+        case qz::DemandDistribution::Uniform:
+            return std::make_unique<qz::UniformDemandSampler>(config.uniform_min, config.uniform_max, config.seed);
+        }
+        throw std::invalid_argument("Invalid demand distribution");
+    }
+
+    // Whether two configurations draw from the same distribution, seeds aside
+    bool same_demand_model(const qz::ChainSimConfig &a, const qz::ChainSimConfig &b)
+    {
+        return a.deterministic == b.deterministic && a.demand_distribution == b.demand_distribution &&
+               a.average_demand == b.average_demand && a.demand_stddev == b.demand_stddev &&
+               a.gamma_shape == b.gamma_shape && a.gamma_scale == b.gamma_scale &&
+               a.uniform_min == b.uniform_min && a.uniform_max == b.uniform_max;
+    }
+}
+
+void qz::ChainSim::reset(const ChainSimConfig &config)
+{
+    if (m_demandSampler && same_demand_model(m_config, config))
+    {
+        if (m_demand_tilted)
+        {
+            set_demand_tilt(1.0);
+        }
+        m_demandSampler->reseed(config.seed);
+    }
+    else
+    {
+        m_demandSampler = make_demand_sampler(config);
+        m_demand_tilted = false;
+    }
+    m_config = config;
+
+    m_simulation_name = config.simulation_name;
+    m_simulation_length = config.simulation_length;
+    m_lead_time = config.lead_time;
+    m_starting_inventory = config.starting_inventory;
+    m_logging_level = config.logging_level;
+    m_record_history = config.record_history;
+    m_track_distributions = config.track_distributions;
+    m_trace_decisions = config.trace_decisions;
+    // About sqrt(horizon) checkpoints of sqrt(horizon) days: bounded memory and rewind cost
+    m_checkpoint_interval = config.resumable
+                                ? qMax<quint64>(16, static_cast<quint64>(std::ceil(std::sqrt(static_cast<double>(m_simulation_length)))))
+                                : 0;
+    m_current_day = 1;
+}
+
 void qz::ChainSim::initialize_simulation()
 {
-    for (const auto &col : m_records_columns)
+    // Columns are refilled in place, so a reused engine only allocates when its records were shared
+    if (m_record_history)
     {
-        m_records[col].fill(0, m_simulation_length);
+        for (const auto &col : m_records_columns)
+        {
+            m_records[col].fill(0, m_simulation_length);
+        }
+    }
+    else
+    {
+        m_records.clear();
     }
 
-    // Sample demand for each day
-    for (int i = 0; i < m_simulation_length; ++i)
+    m_kpis.reset(m_track_distributions);
+    m_decisions.reset(m_trace_decisions ? m_simulation_length : 0);
+    m_checkpoints.clear();
+    if (m_demand_tilted)
     {
-        m_records[QStringLiteral("demand_quantity")][i] =
-            static_cast<qint64>(m_demandSampler->sample());
+        set_demand_tilt(1.0);
     }
+    m_log_likelihood_ratio = 0.0;
+    m_procurements.assign(m_lead_time + 1, 0);
+    m_on_hand = static_cast<qint64>(m_starting_inventory);
+    m_pipeline = 0;
 
-    m_records[QStringLiteral("inventory_quantity")][0] = m_starting_inventory;
+    // Demand is drawn day by day as the simulation runs; day 0 draws too so the sequence
+    // seen by later days does not depend on whether the history is recorded
+    auto day_zero_demand = static_cast<qint64>(m_demandSampler->sample());
+    if (m_record_history)
+    {
+        m_records[QStringLiteral("demand_quantity")][0] = day_zero_demand;
+        m_records[QStringLiteral("inventory_quantity")][0] = m_on_hand;
+    }
+    m_kpis.add_day(m_on_hand, day_zero_demand, 0, 0, 0);
     m_current_day = 1; // Reset current day
 
     m_logger = ChainLogger(m_logging_level);
@@ -34,6 +124,12 @@ void qz::ChainSim::initialize_simulation()
     Q_EMIT simulationStarted();
 }
 
+void qz::ChainSim::set_demand_tilt(double mean_factor)
+{
+    m_demandSampler->setTilt(mean_factor);
+    m_demand_tilted = mean_factor != 1.0;
+}
+
 void qz::ChainSim::simulate(const PurchasePolicy &purchasePolicy)
 {
     m_logger.info(QString("Starting simulation {{%1}} ...").arg(m_simulation_name));
@@ -64,10 +160,34 @@ void qz::ChainSim::simulate_days(const PurchasePolicy &purchasePolicy, quint64 d
         Q_EMIT daySimulated(m_current_day);
         m_current_day++;
     }
+
+    if (m_current_day == m_simulation_length)
+    {
+        Q_EMIT simulationFinished();
+    }
 }
 
 void qz::ChainSim::simulate_day(const PurchasePolicy &purchasePolicy, quint64 day)
 {
+    auto sampled_demand = m_demandSampler->sample();
+    if (m_demand_tilted)
+    {
+        m_log_likelihood_ratio += m_demandSampler->logLikelihoodRatio(sampled_demand);
+    }
+    advance_day(purchasePolicy, day, static_cast<qint64>(sampled_demand));
+}
+
+void qz::ChainSim::advance_day(const PurchasePolicy &purchasePolicy, quint64 day, qint64 current_demand)
+{
+    if (m_checkpoint_interval > 0 && (day - 1) % m_checkpoint_interval == 0)
+    {
+        auto index = (day - 1) / m_checkpoint_interval;
+        if (index < m_checkpoints.size())
+            m_checkpoints[index] = m_kpis; // Replaying after a rewind
+        else
+            m_checkpoints.push_back(m_kpis);
+    }
+
     // Setup field widths for consistent formatting
     const int leftMargin = 3;    // Left margin space
     const int labelWidth = 22;   // Width for labels
@@ -100,22 +220,27 @@ void qz::ChainSim::simulate_day(const PurchasePolicy &purchasePolicy, quint64 da
         return row;
     };
 
-    // Day header
-    m_logger.info(QString(80, '-'));
-    m_logger.info(QString("%1Day #%2").arg(QString(leftMargin, ' ')).arg(day, 4, 10, QLatin1Char('0')));
+    auto current_inventory = m_on_hand;
+    auto &delivery_slot = m_procurements[day % m_procurements.size()];
+    auto current_procurement = delivery_slot;
+    delivery_slot = 0;
 
-    auto current_inventory = m_records[QStringLiteral("inventory_quantity")][day - 1];
-    auto current_demand = m_records[QStringLiteral("demand_quantity")][day];
-    auto current_procurement = m_records[QStringLiteral("procurement_quantity")][day];
+    if (m_logger.enabled())
+    {
+        // Day header
+        m_logger.info(QString(80, '-'));
+        m_logger.info(QString("%1Day #%2").arg(QString(leftMargin, ' ')).arg(day, 4, 10, QLatin1Char('0')));
 
-    // First line: Initial state
-    m_logger.info(formatRow(
-        QStringLiteral("Starting inventory:"), current_inventory,
-        QStringLiteral("Current demand:"), current_demand,
-        QStringLiteral("Incoming procurement:"), current_procurement));
+        // First line: Initial state
+        m_logger.info(formatRow(
+            QStringLiteral("Starting inventory:"), current_inventory,
+            QStringLiteral("Current demand:"), current_demand,
+            QStringLiteral("Incoming procurement:"), current_procurement));
+    }
 
     // Process day's transactions
     current_inventory += current_procurement;
+    m_pipeline -= current_procurement;
     qint64 sales{}, lost_sales{};
 
     if (current_inventory >= current_demand)
@@ -131,38 +256,240 @@ void qz::ChainSim::simulate_day(const PurchasePolicy &purchasePolicy, quint64 da
     }
 
     // Second line: Transaction results
-    m_logger.info(formatRow(
-        QStringLiteral("Sales completed:"), sales,
-        QStringLiteral("Lost sales:"), lost_sales,
-        QStringLiteral("Ending inventory:"), current_inventory));
+    if (m_logger.enabled())
+    {
+        m_logger.info(formatRow(
+            QStringLiteral("Sales completed:"), sales,
+            QStringLiteral("Lost sales:"), lost_sales,
+            QStringLiteral("Ending inventory:"), current_inventory));
+    }
 
     // Update records
-    m_records[QStringLiteral("inventory_quantity")][day] = current_inventory;
-    m_records[QStringLiteral("sale_quantity")][day] = sales;
-    m_records[QStringLiteral("lost_sale_quantity")][day] = lost_sales;
+    m_on_hand = current_inventory;
+    if (m_record_history)
+    {
+        m_records[QStringLiteral("inventory_quantity")][day] = current_inventory;
+        m_records[QStringLiteral("demand_quantity")][day] = current_demand;
+        m_records[QStringLiteral("sale_quantity")][day] = sales;
+        m_records[QStringLiteral("lost_sale_quantity")][day] = lost_sales;
+    }
 
     // Purchase decision
-    auto purchase_quantity = purchasePolicy.get_purchase(m_records, day);
+    InventoryPosition state{day, m_on_hand, m_pipeline};
+    auto purchase_quantity = purchasePolicy.get_purchase(state);
+    if (m_trace_decisions)
+    {
+        m_decisions.add(purchasePolicy.record_decision(state, purchase_quantity));
+    }
 
     if (purchase_quantity > 0)
     {
-        m_records[QStringLiteral("purchase_quantity")][day] = purchase_quantity;
         auto delivery_date = qMin(day + m_lead_time, m_simulation_length - 1);
-        m_records[QStringLiteral("procurement_quantity")][delivery_date] += purchase_quantity;
+        m_procurements[delivery_date % m_procurements.size()] += purchase_quantity;
+        m_pipeline += purchase_quantity;
+        if (m_record_history)
+        {
+            m_records[QStringLiteral("purchase_quantity")][day] = purchase_quantity;
+            m_records[QStringLiteral("procurement_quantity")][delivery_date] += purchase_quantity;
+        }
 
         // Lines 3-5: Calculation details
-        m_logger.info(QString("%1Calculation Details:").arg(QString(leftMargin, ' ')));
-        QString details = purchasePolicy.get_calculation_details(m_records, day);
-        for (const QString &line : details.split('\n'))
+        if (m_logger.enabled())
         {
-            m_logger.info(QString("%1%2").arg(QString(leftMargin + 2, ' ')).arg(line));
+            m_logger.info(QString("%1Calculation Details:").arg(QString(leftMargin, ' ')));
+            QString details = purchasePolicy.explain(purchasePolicy.record_decision(state, purchase_quantity));
+            for (const QString &line : details.split('\n'))
+            {
+                m_logger.info(QString("%1%2").arg(QString(leftMargin + 2, ' ')).arg(line));
+            }
         }
     }
 
+    m_kpis.add_day(current_inventory, current_demand, sales, lost_sales, qMax<qint64>(0, purchase_quantity),
+                   current_procurement);
+
     m_logger.info(QString()); // Empty line between days
 }
 
+quint64 qz::ChainSim::first_affected_day(const PurchasePolicy &policy, quint64 from_day) const
+{
+    if (!m_record_history)
+    {
+        throw std::invalid_argument("Incremental re-simulation needs the per-day records");
+    }
+
+    // Replays the recorded inventory positions; only the decisions are recomputed
+    const auto &inventory = m_records[QStringLiteral("inventory_quantity")];
+    const auto &procurement = m_records[QStringLiteral("procurement_quantity")];
+    const auto &purchase = m_records[QStringLiteral("purchase_quantity")];
+    qint64 pipeline = 0;
+    for (quint64 day = 1; day < m_current_day; ++day)
+    {
+        // The last day's record also books orders placed that day, which are never received
+        pipeline -= procurement[day] - (day == m_simulation_length - 1 ? purchase[day] : 0);
+        if (day >= from_day)
+        {
+            InventoryPosition state{day, inventory[day], pipeline};
+            if (qMax<qint64>(0, policy.get_purchase(state)) != purchase[day])
+                return day;
+            // Traced decisions also keep the level they were compared with
+            const auto *decision = m_trace_decisions ? m_decisions.find(day) : nullptr;
+            if (decision && decision->threshold != policy.decision_threshold())
+                return day;
+        }
+        pipeline += purchase[day];
+    }
+    return m_current_day;
+}
+
+void qz::ChainSim::resimulate_from(const PurchasePolicy &policy, quint64 day)
+{
+    if (m_checkpoint_interval == 0 || !m_record_history)
+    {
+        throw std::invalid_argument("Incremental re-simulation needs a resumable run with per-day records");
+    }
+    if (m_demand_tilted)
+    {
+        throw std::invalid_argument("Tilted runs cannot be re-simulated");
+    }
+    if (day == 0 || day > m_current_day)
+    {
+        throw std::invalid_argument("Re-simulation must start between day 1 and the current day");
+    }
+
+    if (day == m_current_day)
+    {
+        return; // Nothing simulated yet from `day` on
+    }
+
+    auto end_day = m_current_day;
+    rewind_to(day);
+    while (m_current_day < end_day)
+    {
+        auto demand = m_records[QStringLiteral("demand_quantity")][m_current_day];
+        advance_day(policy, m_current_day, demand);
+        Q_EMIT daySimulated(m_current_day);
+        m_current_day++;
+    }
+}
+
+void qz::ChainSim::rewind_to(quint64 day)
+{
+    auto &inventory = m_records[QStringLiteral("inventory_quantity")];
+    auto &demand = m_records[QStringLiteral("demand_quantity")];
+    auto &procurement = m_records[QStringLiteral("procurement_quantity")];
+    auto &purchase = m_records[QStringLiteral("purchase_quantity")];
+    auto &sales = m_records[QStringLiteral("sale_quantity")];
+    auto &lost_sales = m_records[QStringLiteral("lost_sale_quantity")];
+
+    // KPIs: the last checkpoint at or before `day`, plus the recorded days since
+    auto index = qMin<quint64>((day - 1) / m_checkpoint_interval, m_checkpoints.size() - 1);
+    m_kpis = m_checkpoints[index];
+    m_checkpoints.resize(index + 1);
+    for (auto d = index * m_checkpoint_interval + 1; d < day; ++d)
+    {
+        m_kpis.add_day(inventory[d], demand[d], sales[d], lost_sales[d], purchase[d], procurement[d]);
+    }
+
+    // Orders placed in the last lead time that have not arrived by `day` are still in the pipeline
+    m_on_hand = inventory[day - 1];
+    m_pipeline = 0;
+    std::fill(m_procurements.begin(), m_procurements.end(), 0);
+    for (auto d = day > m_lead_time ? day - m_lead_time : 1; d < day; ++d)
+    {
+        auto delivery_date = qMin(d + m_lead_time, m_simulation_length - 1);
+        if (purchase[d] > 0 && delivery_date >= day)
+        {
+            m_procurements[delivery_date % m_procurements.size()] += purchase[d];
+            m_pipeline += purchase[d];
+        }
+    }
+
+    // Days from `day` on are simulated again; only the deliveries already ordered stay booked
+    for (auto d = day; d < m_simulation_length; ++d)
+    {
+        inventory[d] = 0;
+        procurement[d] = d <= day + m_lead_time ? m_procurements[d % m_procurements.size()] : 0;
+        purchase[d] = 0;
+        sales[d] = 0;
+        lost_sales[d] = 0;
+    }
+    m_decisions.truncate(day);
+    m_current_day = day;
+}
+
+std::vector<qz::SimulationKpis> qz::ChainSim::simulate_policies(const std::vector<const PurchasePolicy *> &policies)
+{
+    initialize_simulation(); // Draws day 0, so the demand path is the one a single run would see
+
+    // One column per state variable, one slot per policy: a day's update of every lane is contiguous
+    const auto lanes = policies.size();
+    const auto slots = m_procurements.size();
+    std::vector<qint64> on_hand(lanes, m_on_hand);
+    std::vector<qint64> pipeline(lanes, 0);
+    std::vector<qint64> procurements(slots * lanes, 0); // Row per delivery day, as m_procurements
+    std::vector<KpiAccumulator> kpis(lanes, m_kpis);
+
+    for (quint64 day = 1; day < m_simulation_length; ++day)
+    {
+        auto sampled_demand = m_demandSampler->sample();
+        if (m_demand_tilted)
+        {
+            m_log_likelihood_ratio += m_demandSampler->logLikelihoodRatio(sampled_demand);
+        }
+        auto demand = static_cast<qint64>(sampled_demand);
+        auto *deliveries = &procurements[(day % slots) * lanes];
+        auto *orders = &procurements[(qMin(day + m_lead_time, m_simulation_length - 1) % slots) * lanes];
+
+        for (std::size_t lane = 0; lane < lanes; ++lane)
+        {
+            auto procurement = deliveries[lane];
+            deliveries[lane] = 0;
+            auto inventory = on_hand[lane] + procurement;
+            pipeline[lane] -= procurement;
+
+            auto sales = qMin(inventory, demand);
+            auto lost_sales = demand - sales;
+            inventory -= sales;
+            on_hand[lane] = inventory;
+
+            auto purchase = policies[lane]->get_purchase({day, inventory, pipeline[lane]});
+            if (purchase > 0)
+            {
+                orders[lane] += purchase;
+                pipeline[lane] += purchase;
+            }
+            kpis[lane].add_day(inventory, demand, sales, lost_sales, qMax<qint64>(0, purchase), procurement);
+        }
+    }
+    m_current_day = m_simulation_length;
+
+    std::vector<SimulationKpis> summaries;
+    summaries.reserve(lanes);
+    for (const auto &lane : kpis)
+    {
+        summaries.push_back(lane.summary());
+    }
+    return summaries;
+}
+
 qz::ChainSim::simulation_records_t qz::ChainSim::get_simulation_records() const
 {
     return m_records;
 }
+
+qz::ChainSim::simulation_records_t qz::ChainSim::get_simulation_records(quint64 first_day, quint64 last_day) const
+{
+    simulation_records_t slice;
+    if (first_day > last_day || first_day >= m_simulation_length)
+    {
+        return slice;
+    }
+
+    auto count = qMin(last_day, m_simulation_length - 1) - first_day + 1;
+    for (auto it = m_records.cbegin(); it != m_records.cend(); ++it)
+    {
+        slice[it.key()] = it.value().mid(first_day, count);
+    }
+    return slice;
+}
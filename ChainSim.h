@@ -7,13 +7,48 @@
 #include <QMap>
 #include <QDebug>
 #include <memory>
+#include <vector>
 
 #include "purchase_policies/PurchasePolicy.h"
 #include "utils/ChainLogger.hpp"
+#include "utils/DecisionTrace.hpp"
 #include "utils/DemandSampler.hpp"
+#include "utils/KpiAccumulator.hpp"
 
 namespace qz
 {
+        enum class DemandDistribution
+        {
+                Fixed,
+                Normal,
+                Gamma,
+                Poisson,
+                Uniform
+        };
+
+        // Everything ChainSimBuilder configures, so an existing engine can be re-targeted with ChainSim::reset
+        struct ChainSimConfig
+        {
+                QString simulation_name;
+                quint64 simulation_length{30};
+                quint64 lead_time{5};
+                double average_demand{50.0};
+                double demand_stddev{10.0};
+                bool deterministic{false}; // Fixed demand at average_demand, whatever the distribution
+                unsigned seed{7};
+                quint64 starting_inventory{0};
+                quint32 logging_level{0};
+                DemandDistribution demand_distribution{DemandDistribution::Normal};
+                double gamma_shape{1.0};
+                double gamma_scale{1.0};
+                double uniform_min{0.0};
+                double uniform_max{100.0};
+                bool record_history{true};
+                bool track_distributions{true};
+                bool trace_decisions{false};
+                bool resumable{false};
+        };
+
         class ChainSim : public QObject
         {
                 Q_OBJECT
@@ -21,6 +56,10 @@ namespace qz
         public:
                 using simulation_records_t = QMap<QString, QVector<qint64>>;
 
+                // Applies a configuration validated by ChainSimBuilder, keeping the record buffers and,
+                // when the demand model is unchanged, the sampler (reseeded); initialize_simulation next
+                void reset(const ChainSimConfig &config);
+
                 void initialize_simulation();
 
                 // Simulate entire duration
@@ -32,8 +71,39 @@ namespace qz
                 // Simulate single day
                 void simulate_day(const PurchasePolicy &purchasePolicy, quint64 day);
 
+                // Initializes and runs every policy over one shared demand path in a single pass,
+                // returning each policy's KPIs in order. Each lane's KPIs equal those of a separate
+                // run with the same seed; records, get_kpis() and logging are not updated.
+                std::vector<SimulationKpis> simulate_policies(const std::vector<const PurchasePolicy *> &policies);
+
                 [[nodiscard]] simulation_records_t get_simulation_records() const;
+                // Records for days [first_day, last_day], e.g. the rows produced by the last step
+                [[nodiscard]] simulation_records_t get_simulation_records(quint64 first_day, quint64 last_day) const;
+                [[nodiscard]] quint64 get_simulation_length() const { return m_simulation_length; }
                 [[nodiscard]] quint64 get_current_day() const { return m_current_day; }
+                // KPIs over days [0, current_day), kept up to date as days are simulated
+                [[nodiscard]] SimulationKpis get_kpis() const { return m_kpis.summary(); }
+                // Quantile sketches and histograms of the same days, mergeable across runs
+                [[nodiscard]] const KpiDistributions &get_distributions() const { return m_kpis.distributions(); }
+                // False in summary-only mode, where get_simulation_records() is empty
+                [[nodiscard]] bool is_recording_history() const { return m_record_history; }
+                [[nodiscard]] qsizetype get_record_column_count() const { return m_records_columns.size(); }
+                // Decisions of days [1, current_day) when tracing is on, rendered with PurchasePolicy::explain
+                [[nodiscard]] const DecisionTrace &get_decisions() const { return m_decisions; }
+
+                // Incremental re-simulation of a resumable run (see ChainSimBuilder::setResumable).
+                // First day in [from_day, current_day) on which `policy` would order differently from
+                // the recorded run, given the same demand; current_day if it never would
+                [[nodiscard]] quint64 first_affected_day(const PurchasePolicy &policy, quint64 from_day = 1) const;
+                // Rewinds to the start of `day` and simulates days [day, current_day) again with
+                // `policy`, replaying the recorded demand; earlier days, their KPIs and decisions are kept
+                void resimulate_from(const PurchasePolicy &policy, quint64 day);
+
+                // Importance sampling: demand for the following days comes from the exponentially
+                // tilted distribution (see DemandSampler::setTilt), 1 restores the nominal one
+                void set_demand_tilt(double mean_factor);
+                // log of the likelihood ratio (nominal / tilted) of the demand drawn since initialization
+                [[nodiscard]] double get_log_likelihood_ratio() const { return m_log_likelihood_ratio; }
 
         Q_SIGNALS:
                 void simulationStarted();
@@ -44,7 +114,14 @@ namespace qz
         private:
                 ChainSim();
                 friend class ChainSimBuilder;
+                friend class ChainSimPool;
+
+                // The day's sales, purchase decision and bookkeeping, once its demand is known
+                void advance_day(const PurchasePolicy &purchasePolicy, quint64 day, qint64 current_demand);
+                // Restores the running state at the start of `day` from the records and a KPI checkpoint
+                void rewind_to(quint64 day);
 
+                ChainSimConfig m_config;
                 quint64 m_simulation_length{};
                 quint64 m_starting_inventory{};
                 quint64 m_lead_time{};
@@ -54,6 +131,21 @@ namespace qz
                 QString m_simulation_name;
                 QVector<QString> m_records_columns;
                 simulation_records_t m_records;
+                bool m_record_history{true};
+                bool m_track_distributions{true};
+                bool m_trace_decisions{false};
+                DecisionTrace m_decisions;
+
+                // Running state, enough to simulate without looking back at the records
+                KpiAccumulator m_kpis;
+                qint64 m_on_hand{0};
+                qint64 m_pipeline{0};
+                std::vector<qint64> m_procurements; // Ring of upcoming deliveries, indexed by day % (lead time + 1)
+                // KPIs at the start of days 1, 1 + interval, ... so a rewind re-adds at most interval days
+                quint64 m_checkpoint_interval{0}; // 0 = not resumable
+                std::vector<KpiAccumulator> m_checkpoints;
+                bool m_demand_tilted{false};
+                double m_log_likelihood_ratio{0.0};
 
                 quint32 m_logging_level{0};
                 ChainLogger m_logger{};
@@ -0,0 +1,269 @@
+#include "ChainSimBinaryServer.h"
+#include "ChainSimPool.h"
+#include <QLocalSocket>
+#include <QTcpSocket>
+#include "purchase_policies/PurchaseROP.h"
+#include "purchase_policies/PurchaseEOQ.h"
+#include "purchase_policies/PurchaseTPOP.h"
+#include "utils/Metrics.hpp"
+#include "utils/Trace.hpp"
+
+namespace qz
+{
+
+    ChainSimBinaryServer::ChainSimBinaryServer(QObject *parent)
+        : QObject(parent), m_logger(2)
+    {
+        connect(&m_tcpServer, &QTcpServer::newConnection, this, [this]()
+                {
+                    while (QTcpSocket *socket = m_tcpServer.nextPendingConnection())
+                    {
+                        // Responses are small and latency-bound; do not let Nagle hold them back
+                        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+                        accept(socket);
+                    } });
+        connect(&m_localServer, &QLocalServer::newConnection, this, [this]()
+                {
+                    while (QLocalSocket *socket = m_localServer.nextPendingConnection())
+                        accept(socket); });
+    }
+
+    ChainSimBinaryServer::~ChainSimBinaryServer()
+    {
+        // Workers post their replies back to this object
+        m_workers.waitForDone();
+    }
+
+    bool ChainSimBinaryServer::listen(quint16 port)
+    {
+        if (!m_tcpServer.listen(QHostAddress::AnyIPv4, port))
+        {
+            m_logger.error(QString("Failed to start binary server on port %1: %2")
+                               .arg(port)
+                               .arg(m_tcpServer.errorString()));
+            return false;
+        }
+
+        m_logger.info(QString("Binary protocol server running on tcp://127.0.0.1:%1").arg(m_tcpServer.serverPort()));
+        return true;
+    }
+
+    bool ChainSimBinaryServer::listenLocal(const QString &name)
+    {
+        // A socket file left behind by a crashed server would otherwise make listen() fail
+        QLocalServer::removeServer(name);
+        if (!m_localServer.listen(name))
+        {
+            m_logger.error(QString("Failed to start binary server on socket %1: %2")
+                               .arg(name)
+                               .arg(m_localServer.errorString()));
+            return false;
+        }
+
+        m_logger.info(QString("Binary protocol server running on unix://%1").arg(m_localServer.fullServerName()));
+        return true;
+    }
+
+    template <typename Socket>
+    void ChainSimBinaryServer::accept(Socket *socket)
+    {
+        // A bounded read buffer leaves unread requests in the kernel, whose window then stalls the client
+        socket->setReadBufferSize(static_cast<qint64>(kMaxInFlight * wire::kMaxRequestBytes));
+
+        auto id = ++m_nextConnection;
+        m_connections.insert(id, Connection{socket, {}, {}, false});
+        connect(socket, &Socket::readyRead, this, [this, id]()
+                { onReadyRead(id); });
+        connect(socket, &Socket::bytesWritten, this, [this, id]()
+                { onReadyRead(id); });
+        connect(socket, &Socket::disconnected, this, [this, id, socket]()
+                {
+                    m_connections.remove(id);
+                    socket->deleteLater(); });
+    }
+
+    void ChainSimBinaryServer::onReadyRead(quint64 id)
+    {
+        auto it = m_connections.find(id);
+        if (it == m_connections.end() || it->closing)
+            return;
+
+        Connection &connection = it.value();
+        auto paused = [&connection]()
+        {
+            return connection.replies.size() >= kMaxInFlight || connection.socket->bytesToWrite() >= kMaxQueuedBytes;
+        };
+        if (paused())
+            return;
+
+        QByteArray &buffer = connection.buffer;
+        buffer.append(connection.socket->readAll());
+
+        qsizetype offset = 0;
+        try
+        {
+            while (!paused())
+            {
+                auto size = wire::frame_size(buffer.constData() + offset, buffer.size() - offset, wire::kMaxRequestBytes);
+                if (size == 0)
+                    break;
+
+                auto reply = std::make_shared<Reply>();
+                connection.replies.push_back(reply);
+                auto payload = buffer.mid(offset + static_cast<qsizetype>(wire::kLengthBytes),
+                                          static_cast<qsizetype>(size - wire::kLengthBytes));
+                m_workers.start([this, id, reply, payload]()
+                                {
+                                    handleRequest(payload.constData(), static_cast<std::size_t>(payload.size()), reply->frame);
+                                    QMetaObject::invokeMethod(this, [this, id, reply]()
+                                                              {
+                                                                  reply->ready = true;
+                                                                  flush(id); }, Qt::QueuedConnection); });
+                offset += static_cast<qsizetype>(size);
+            }
+        }
+        catch (const std::exception &e)
+        {
+            // An impossible length leaves no way to find the next frame; answer what came before it
+            m_logger.error(QString("Closing binary connection: %1").arg(e.what()));
+            connection.closing = true;
+            buffer.clear();
+            flush(id);
+            return;
+        }
+
+        buffer.remove(0, offset);
+    }
+
+    void ChainSimBinaryServer::flush(quint64 id)
+    {
+        auto it = m_connections.find(id);
+        if (it == m_connections.end())
+            return;
+
+        Connection &connection = it.value();
+        std::string out;
+        while (!connection.replies.empty() && connection.replies.front()->ready)
+        {
+            out += connection.replies.front()->frame;
+            connection.replies.pop_front();
+        }
+        if (!out.empty())
+            connection.socket->write(out.data(), static_cast<qint64>(out.size()));
+
+        if (!connection.closing)
+            onReadyRead(id); // Frames left buffered while the connection was paused
+        else if (connection.replies.empty())
+            connection.socket->close();
+    }
+
+    void ChainSimBinaryServer::handleRequest(const char *payload, std::size_t size, std::string &out)
+    {
+        ScopedRequest metrics(ServerMetrics::Route::Binary);
+        auto id = wire::peek_id(payload, size);
+        auto start = out.size();
+        try
+        {
+            ChainSimPool::Handle simulation;
+            std::unique_ptr<PurchasePolicy> policy;
+            {
+                ScopedPhase phase(ServerMetrics::Phase::Parse);
+                auto request = wire::decode_request(payload, size);
+                ChainSimBuilder builder;
+                configureBuilder(builder, request);
+                policy = createPolicy(request);
+                TraceSpan span("ChainSimPool::acquire", "engine");
+                simulation = ChainSimPool::shared().acquire(builder.config());
+            }
+            if (simulation->is_recording_history() &&
+                wire::result_bytes(static_cast<std::uint64_t>(simulation->get_record_column_count()),
+                                   simulation->get_simulation_length()) > wire::kMaxResultBytes)
+            {
+                throw std::invalid_argument("Result too large to send; shorten simulation_length or set summary_only");
+            }
+
+            auto started = std::chrono::steady_clock::now();
+            {
+                ScopedPhase phase(ServerMetrics::Phase::Simulate);
+                simulation->initialize_simulation();
+                simulation->simulate(*policy);
+            }
+            ServerMetrics::instance().record_simulated_days(simulation->get_simulation_length(),
+                                                            std::chrono::steady_clock::now() - started);
+
+            ScopedPhase phase(ServerMetrics::Phase::Serialize);
+            wire::Writer writer(out);
+            const auto records = simulation->is_recording_history() ? simulation->get_simulation_records()
+                                                                     : ChainSim::simulation_records_t();
+            wire::begin_result(writer, id, simulation->get_kpis(), static_cast<std::uint16_t>(records.size()));
+            for (auto column = records.cbegin(); column != records.cend(); ++column)
+            {
+                auto name = column.key().toUtf8();
+                wire::write_column(writer, std::string_view(name.constData(), name.size()),
+                                   column.value().constData(), static_cast<std::uint32_t>(column.value().size()));
+            }
+            writer.end_frame();
+        }
+        catch (const std::exception &e)
+        {
+            metrics.set_status(400);
+            out.resize(start);
+            wire::encode_error(out, id, e.what());
+        }
+    }
+
+    void ChainSimBinaryServer::configureBuilder(ChainSimBuilder &builder, const wire::SimulateRequest &request)
+    {
+        // Indexed by wire::Distribution
+        static const QString kDistributions[] = {"fixed", "normal", "gamma", "poisson", "uniform"};
+
+        builder.setSimulationName("ChainSim")
+            .setSimulationLength(request.simulation_length)
+            .setLeadTime(request.lead_time)
+            .setDemandDistribution(kDistributions[static_cast<int>(request.distribution)])
+            .setDeterministic(request.flags & wire::kDeterministic)
+            .setSeed(request.seed)
+            .setStartingInventory(request.starting_inventory)
+            .setRecordHistory(!(request.flags & wire::kSummaryOnly))
+            .setTrackDistributions(false) // Results carry KPIs, not their distributions
+            .setTraceDecisions(false);
+
+        // The same distribution parameters ChainSimServer::configureBuilder reads from a query
+        switch (request.distribution)
+        {
+        case wire::Distribution::Normal:
+            builder.setAverageDemand(request.average_demand)
+                .setDemandStdDev(request.std_demand);
+            break;
+        case wire::Distribution::Gamma:
+            builder.setGammaParameters(request.gamma_shape, request.gamma_scale);
+            break;
+        case wire::Distribution::Poisson:
+            builder.setAverageDemand(request.average_demand);
+            break;
+        case wire::Distribution::Uniform:
+            builder.setUniformParameters(request.uniform_min, request.uniform_max);
+            break;
+        case wire::Distribution::Fixed:
+            builder.setAverageDemand(request.average_demand)
+                .setDeterministic(true);
+            break;
+        }
+    }
+
+    std::unique_ptr<PurchasePolicy> ChainSimBinaryServer::createPolicy(const wire::SimulateRequest &request)
+    {
+        switch (request.policy)
+        {
+        case wire::Policy::ROP:
+            return std::make_unique<PurchaseROP>(request.lead_time, request.average_demand);
+        case wire::Policy::EOQ:
+            return std::make_unique<PurchaseEOQ>(request.lead_time, request.average_demand,
+                                                 request.ordering_cost, request.holding_cost);
+        case wire::Policy::TPOP:
+            return std::make_unique<PurchaseTPOP>(request.lead_time, request.average_demand, request.purchase_period);
+        }
+        throw std::invalid_argument("Unsupported policy");
+    }
+
+} // namespace qz
@@ -0,0 +1,89 @@
+#ifndef CHAINSIM_BINARYSERVER_H
+#define CHAINSIM_BINARYSERVER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QLocalServer>
+#include <QTcpServer>
+#include <QThreadPool>
+#include <deque>
+#include <memory>
+#include <string>
+#include "ChainSimBuilder.h"
+#include "purchase_policies/PurchasePolicy.h"
+#include "utils/ChainLogger.hpp"
+#include "utils/WireProtocol.hpp"
+
+namespace qz
+{
+
+    /* /simulate for programmatic clients, over the framed binary protocol of utils/WireProtocol.hpp.
+     *
+     * Listens on TCP, on a Unix domain socket, or both. Requests carry the scenario as fixed
+     * binary fields instead of a URL query, and results come back as KPIs plus raw i64 columns,
+     * so a call skips HTTP parsing, query decoding, CORS and JSON on both ends. Requests run on
+     * a worker pool, so simulations neither stall the event loop (and the other listeners on it)
+     * nor stay on one core. Answers go out in request order, every run of finished ones in a
+     * single write, so pipelined requests cost one round trip per batch. A connection is not
+     * read while kMaxInFlight of its requests are running or kMaxQueuedBytes of answers wait to
+     * be sent, so a client that stops reading cannot make the server buffer without bound.
+     * Engines come from the same ChainSimPool as /simulate.
+     */
+    class ChainSimBinaryServer : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        explicit ChainSimBinaryServer(QObject *parent = nullptr);
+        ~ChainSimBinaryServer() override;
+
+        bool listen(quint16 port = 47763);
+        // A socket path, or a name placed in the runtime directory (e.g. /tmp/<name>)
+        bool listenLocal(const QString &name);
+        [[nodiscard]] quint16 port() const { return m_tcpServer.serverPort(); }
+        [[nodiscard]] QString localPath() const { return m_localServer.fullServerName(); }
+
+        // Appends the Result or Error frame answering one request payload to `out`
+        static void handleRequest(const char *payload, std::size_t size, std::string &out);
+
+    private:
+        // One answer, encoded by a worker and written once every earlier one on its connection is
+        struct Reply
+        {
+            std::string frame;
+            bool ready{false}; // Set on the server's thread when the worker has finished
+        };
+
+        struct Connection
+        {
+            QIODevice *socket{nullptr};
+            QByteArray buffer;                          // Received bytes not yet framed
+            std::deque<std::shared_ptr<Reply>> replies; // In request order
+            bool closing{false};                        // Close once the replies are out
+        };
+
+        // Requests running per connection, and answers waiting to be sent, beyond which reading pauses
+        static constexpr std::size_t kMaxInFlight = 64;
+        static constexpr qint64 kMaxQueuedBytes = 4 << 20;
+
+        QTcpServer m_tcpServer;
+        QLocalServer m_localServer;
+        QHash<quint64, Connection> m_connections;
+        quint64 m_nextConnection{0};
+        QThreadPool m_workers;
+        ChainLogger m_logger;
+
+        template <typename Socket>
+        void accept(Socket *socket);
+        void onReadyRead(quint64 id);
+        // Writes the finished replies at the head of the connection's queue, then reads on
+        void flush(quint64 id);
+
+        static void configureBuilder(ChainSimBuilder &builder, const wire::SimulateRequest &request);
+        static std::unique_ptr<PurchasePolicy> createPolicy(const wire::SimulateRequest &request);
+    };
+
+} // namespace qz
+
+#endif // CHAINSIM_BINARYSERVER_H
@@ -1,4 +1,5 @@
 #include "ChainSimBuilder.h"
+#include <QHash>
 
 qz::ChainSimBuilder::ChainSimBuilder(QObject *parent)
     : QObject(parent)
@@ -11,7 +12,7 @@ qz::ChainSimBuilder &qz::ChainSimBuilder::setSimulationName(const QString &simul
     {
         throw std::invalid_argument("Simulation name cannot be empty");
     }
-    m_simulation_name = simulationName;
+    m_config.simulation_name = simulationName;
     return *this;
 }
 
@@ -21,7 +22,7 @@ qz::ChainSimBuilder &qz::ChainSimBuilder::setSimulationLength(quint64 simulation
     {
         throw std::invalid_argument("Simulation length must be greater than zero");
     }
-    m_simulation_length = simulationLength;
+    m_config.simulation_length = simulationLength;
     return *this;
 }
 
@@ -31,11 +32,11 @@ qz::ChainSimBuilder &qz::ChainSimBuilder::setLeadTime(quint64 leadTime)
     {
         throw std::invalid_argument("Lead time must be greater than zero");
     }
-    if (leadTime >= m_simulation_length)
+    if (leadTime >= m_config.simulation_length)
     {
         throw std::invalid_argument("Lead time must be less than simulation length");
     }
-    m_lead_time = leadTime;
+    m_config.lead_time = leadTime;
     return *this;
 }
 
@@ -45,7 +46,7 @@ qz::ChainSimBuilder &qz::ChainSimBuilder::setAverageDemand(double averageDemand)
     {
         throw std::invalid_argument("Average demand must be positive");
     }
-    m_average_demand = averageDemand;
+    m_config.average_demand = averageDemand;
     return *this;
 }
 
@@ -55,25 +56,25 @@ qz::ChainSimBuilder &qz::ChainSimBuilder::setDemandStdDev(double stdDev)
     {
         throw std::invalid_argument("Standard deviation cannot be negative");
     }
-    m_demand_stddev = stdDev;
+    m_config.demand_stddev = stdDev;
     return *this;
 }
 
 qz::ChainSimBuilder &qz::ChainSimBuilder::setDeterministic(bool deterministic)
 {
-    m_deterministic = deterministic;
+    m_config.deterministic = deterministic;
     return *this;
 }
 
 qz::ChainSimBuilder &qz::ChainSimBuilder::setSeed(unsigned seed)
 {
-    m_seed = seed;
+    m_config.seed = seed;
     return *this;
 }
 
 qz::ChainSimBuilder &qz::ChainSimBuilder::setStartingInventory(quint64 startingInventory)
 {
-    m_starting_inventory = startingInventory;
+    m_config.starting_inventory = startingInventory;
     return *this;
 }
 
@@ -83,21 +84,26 @@ qz::ChainSimBuilder &qz::ChainSimBuilder::setLoggingLevel(quint32 loggingLevel)
     {
         throw std::invalid_argument("Logging level must be between 0 and 2");
     }
-    m_logging_level = loggingLevel;
+    m_config.logging_level = loggingLevel;
     return *this;
 }
 
 qz::ChainSimBuilder &qz::ChainSimBuilder::setDemandDistribution(const QString &distribution)
 {
-    if (distribution != "fixed" &&
-        distribution != "normal" &&
-        distribution != "gamma" &&
-        distribution != "poisson" &&
-        distribution != "uniform")
+    // Parsed once here, so neither create() nor ChainSim::reset compares names
+    static const QHash<QString, DemandDistribution> distributions = {
+        {"fixed", DemandDistribution::Fixed},
+        {"normal", DemandDistribution::Normal},
+        {"gamma", DemandDistribution::Gamma},
+        {"poisson", DemandDistribution::Poisson},
+        {"uniform", DemandDistribution::Uniform}};
+
+    auto it = distributions.constFind(distribution);
+    if (it == distributions.constEnd())
     {
         throw std::invalid_argument("Invalid demand distribution");
     }
-    m_demand_distribution = distribution;
+    m_config.demand_distribution = it.value();
     return *this;
 }
 
@@ -107,8 +113,8 @@ qz::ChainSimBuilder &qz::ChainSimBuilder::setGammaParameters(double shape, doubl
     {
         throw std::invalid_argument("Gamma parameters must be positive");
     }
-    m_gamma_shape = shape;
-    m_gamma_scale = scale;
+    m_config.gamma_shape = shape;
+    m_config.gamma_scale = scale;
     return *this;
 }
 
@@ -118,26 +124,56 @@ qz::ChainSimBuilder &qz::ChainSimBuilder::setUniformParameters(double min, doubl
     {
         throw std::invalid_argument("Uniform min must be less than max");
     }
-    m_uniform_min = min;
-    m_uniform_max = max;
+    m_config.uniform_min = min;
+    m_config.uniform_max = max;
+    return *this;
+}
+
+qz::ChainSimBuilder &qz::ChainSimBuilder::setRecordHistory(bool recordHistory)
+{
+    m_config.record_history = recordHistory;
     return *this;
 }
 
-void qz::ChainSimBuilder::validateConfiguration() const
+qz::ChainSimBuilder &qz::ChainSimBuilder::setTrackDistributions(bool trackDistributions)
 {
-    if (m_simulation_name.isEmpty())
+    m_config.track_distributions = trackDistributions;
+    return *this;
+}
+
+qz::ChainSimBuilder &qz::ChainSimBuilder::setTraceDecisions(bool traceDecisions)
+{
+    m_config.trace_decisions = traceDecisions;
+    return *this;
+}
+
+qz::ChainSimBuilder &qz::ChainSimBuilder::setResumable(bool resumable)
+{
+    m_config.resumable = resumable;
+    return *this;
+}
+
+qz::ChainSimBuilder &qz::ChainSimBuilder::setConfig(const ChainSimConfig &config)
+{
+    m_config = config;
+    return *this;
+}
+
+void qz::ChainSimBuilder::validateConfiguration(const ChainSimConfig &config)
+{
+    if (config.simulation_name.isEmpty())
     {
         throw std::invalid_argument("Simulation name not set");
     }
-    if (m_simulation_length == 0)
+    if (config.simulation_length == 0)
     {
         throw std::invalid_argument("Simulation length not set or invalid");
     }
-    if (m_lead_time == 0)
+    if (config.lead_time == 0)
     {
         throw std::invalid_argument("Lead time not set or invalid");
     }
-    if (m_average_demand <= 0)
+    if (config.average_demand <= 0)
     {
         throw std::invalid_argument("Average demand not set or invalid");
     }
@@ -145,45 +181,9 @@ void qz::ChainSimBuilder::validateConfiguration() const
 
 std::unique_ptr<qz::ChainSim> qz::ChainSimBuilder::create()
 {
-    validateConfiguration();
+    validateConfiguration(m_config);
 
     auto sim = std::unique_ptr<ChainSim>(new ChainSim);
-    sim->m_simulation_name = m_simulation_name;
-    sim->m_simulation_length = m_simulation_length;
-    sim->m_lead_time = m_lead_time;
-
-    if (m_deterministic)
-    {
-        sim->m_demandSampler = std::make_unique<FixedDemandSampler>(m_average_demand);
-    }
-    else if (m_demand_distribution == "normal")
-    {
-        sim->m_demandSampler = std::make_unique<NormalDemandSampler>(
-            m_average_demand, m_demand_stddev, m_seed);
-    }
-    else if (m_demand_distribution == "gamma")
-    {
-        sim->m_demandSampler = std::make_unique<GammaDemandSampler>(
-            m_gamma_shape, m_gamma_scale, m_seed);
-    }
-    else if (m_demand_distribution == "poisson")
-    {
-        sim->m_demandSampler = std::make_unique<PoissonDemandSampler>(
-            m_average_demand, m_seed);
-    }
-    else if (m_demand_distribution == "uniform")
-    {
-        sim->m_demandSampler = std::make_unique<UniformDemandSampler>(
-            m_uniform_min, m_uniform_max, m_seed);
-    }
-
-    sim->m_starting_inventory = m_starting_inventory;
-    sim->m_logging_level = m_logging_level;
-
-    for (const auto &col : sim->m_records_columns)
-    {
-        sim->m_records[col] = QVector<qint64>(m_simulation_length);
-    }
-
+    sim->reset(m_config);
     return sim;
 }
@@ -29,27 +29,27 @@ namespace qz
         ChainSimBuilder &setDemandDistribution(const QString &distribution);
         ChainSimBuilder &setGammaParameters(double shape, double scale);
         ChainSimBuilder &setUniformParameters(double min, double max);
+        // Summary-only runs keep KPIs but no per-day records, so memory stays constant in the horizon
+        ChainSimBuilder &setRecordHistory(bool recordHistory);
+        // Quantile sketches and histograms of inventory/lost sales; off for runs that only need means
+        ChainSimBuilder &setTrackDistributions(bool trackDistributions);
+        // Keep a DecisionRecord per day so decisions can be explained after the run
+        ChainSimBuilder &setTraceDecisions(bool traceDecisions);
+        // Keep KPI checkpoints so the run can be rewound and re-simulated from any day (sessions)
+        ChainSimBuilder &setResumable(bool resumable);
+
+        // Everything at once, e.g. a configuration kept from an earlier builder
+        ChainSimBuilder &setConfig(const ChainSimConfig &config);
+        [[nodiscard]] const ChainSimConfig &config() const { return m_config; }
 
         // Create and return a new ChainSim instance
         std::unique_ptr<ChainSim> create();
 
+        // Checks done by create(), also applied by ChainSimPool before it resets an engine
+        static void validateConfiguration(const ChainSimConfig &config);
+
     private:
-        void validateConfiguration() const;
-
-        QString m_simulation_name;
-        quint64 m_simulation_length{30};
-        quint64 m_lead_time{5};
-        double m_average_demand{50.0};
-        double m_demand_stddev{10.0};
-        bool m_deterministic{false};
-        unsigned m_seed{7};
-        quint64 m_starting_inventory{0};
-        quint32 m_logging_level{0};
-        QString m_demand_distribution{"normal"};
-        double m_gamma_shape{1.0};
-        double m_gamma_scale{1.0};
-        double m_uniform_min{0.0};
-        double m_uniform_max{100.0};
+        ChainSimConfig m_config;
     };
 }
 
@@ -0,0 +1,380 @@
+#include "ChainSimManifestRunner.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QTextStream>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include "ChainSimServer.h"
+#include "analysis/PolicyComparison.h"
+#include "analysis/PolicyOptimizer.h"
+#include "analysis/ReplicationRunner.h"
+#include "utils/Trace.hpp"
+#include "utils/WorkStealing.hpp"
+
+namespace qz
+{
+
+    ChainSimManifestRunner::ChainSimManifestRunner(QUrlQuery defaults, ManifestOptions options)
+        : m_defaults(std::move(defaults)), m_options(std::move(options))
+    {
+        if (m_options.shards == 0)
+        {
+            throw std::invalid_argument("The manifest needs at least one shard");
+        }
+    }
+
+    std::vector<ManifestScenario> ChainSimManifestRunner::readManifest(const QString &path)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        {
+            throw std::invalid_argument("Could not open manifest: " + path.toStdString());
+        }
+
+        QStringList lines;
+        QTextStream in(&file);
+        while (!in.atEnd())
+        {
+            lines << in.readLine();
+        }
+
+        auto suffix = QFileInfo(path).suffix().toLower();
+        bool json = suffix == "jsonl" || suffix == "ndjson" || suffix == "json";
+        if (suffix != "csv" && !json)
+        {
+            for (const auto &line : lines)
+            {
+                if (!line.trimmed().isEmpty())
+                {
+                    json = line.trimmed().startsWith('{');
+                    break;
+                }
+            }
+        }
+
+        auto scenarios = json ? readJsonLines(lines) : readCsv(lines);
+        validateIds(scenarios);
+        return scenarios;
+    }
+
+    ManifestReport ChainSimManifestRunner::run(const std::vector<ManifestScenario> &scenarios)
+    {
+        ManifestReport report;
+        report.scenarios = scenarios.size();
+
+        if (!QDir().mkpath(m_options.output_dir))
+        {
+            throw std::invalid_argument("Could not create output directory: " + m_options.output_dir.toStdString());
+        }
+
+        // Positions in the manifest, so shards do not move when a resumed run skips scenarios
+        std::vector<std::size_t> pending;
+        auto recorded = m_options.resume ? recordedScenarios() : std::set<QString>{};
+        for (std::size_t i = 0; i < scenarios.size(); ++i)
+        {
+            if (recorded.count(scenarios[i].id))
+                ++report.skipped;
+            else
+                pending.push_back(i);
+        }
+        openSummary();
+
+        std::atomic<std::size_t> succeeded{0};
+        work_stealing_for(pending.size(), m_options.threads, [&](std::size_t p)
+                          {
+                              auto index = pending[p];
+                              const auto &scenario = scenarios[index];
+                              TraceSpan span("scenario", "manifest");
+                              auto started = std::chrono::steady_clock::now();
+                              auto elapsed_ms = [&started]()
+                              {
+                                  return QString::number(std::chrono::duration<double, std::milli>(
+                                                             std::chrono::steady_clock::now() - started)
+                                                             .count(),
+                                                         'f', 3);
+                              };
+
+                              QStringList row{csvField(scenario.id)};
+                              try
+                              {
+                                  auto params = scenarioParams(scenario);
+                                  auto simulation = ChainSimServer::createSimulation(params);
+                                  auto policy = ChainSimServer::createPolicy(params);
+                                  simulation->initialize_simulation();
+                                  simulation->simulate(*policy);
+
+                                  if (simulation->is_recording_history())
+                                  {
+                                      QDir().mkpath(QFileInfo(recordsPath(scenario.id, index)).path());
+                                      QSaveFile file(recordsPath(scenario.id, index));
+                                      if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+                                      {
+                                          throw std::runtime_error("Could not open " + file.fileName().toStdString());
+                                      }
+                                      ChainSimServer::writeRecordsCsv(simulation->get_simulation_records(), file);
+                                      if (!file.commit())
+                                      {
+                                          throw std::runtime_error("Could not write " + file.fileName().toStdString());
+                                      }
+                                  }
+
+                                  auto costs = ChainSimServer::parseCosts(params);
+                                  auto kpis = simulation->get_kpis();
+                                  row << "ok" << elapsed_ms();
+                                  for (const auto &name : ReplicationRunner::kpi_names())
+                                  {
+                                      row << QString::number(ReplicationRunner::kpi_value(kpis, name), 'g', 10);
+                                  }
+                                  row << QString::number(PolicyOptimizer::run_cost(kpis, costs), 'g', 10) << QString();
+                                  ++succeeded;
+                              }
+                              catch (const std::exception &e)
+                              {
+                                  row << "failed" << elapsed_ms();
+                                  for (qsizetype k = 0; k < PolicyComparison::kpi_names().size(); ++k)
+                                  {
+                                      row << QString();
+                                  }
+                                  row << csvField(QString::fromUtf8(e.what()));
+                              }
+                              appendSummary(row);
+                          });
+
+        m_summary.close();
+        report.succeeded = succeeded.load();
+        report.failed = pending.size() - report.succeeded;
+        return report;
+    }
+
+    QUrlQuery ChainSimManifestRunner::scenarioParams(const ManifestScenario &scenario) const
+    {
+        QUrlQuery params(scenario.params);
+        for (const auto &[name, value] : m_defaults.queryItems())
+        {
+            if (!params.hasQueryItem(name))
+                params.addQueryItem(name, value);
+        }
+
+        // The engine treats a present flag as set, so "0"/"false" from a manifest must remove it
+        for (const char *flag : {"deterministic", "summary_only"})
+        {
+            auto value = params.queryItemValue(flag).toLower();
+            if (value == "0" || value == "false")
+                params.removeAllQueryItems(flag);
+        }
+        return params;
+    }
+
+    QString ChainSimManifestRunner::recordsPath(const QString &id, std::size_t index) const
+    {
+        return QString("%1/shard-%2/%3.csv")
+            .arg(m_options.output_dir)
+            .arg(index % m_options.shards, 2, 10, QChar('0'))
+            .arg(id);
+    }
+
+    QStringList ChainSimManifestRunner::summaryColumns() const
+    {
+        QStringList columns{"id", "status", "elapsed_ms"};
+        columns << PolicyComparison::kpi_names() << "error";
+        return columns;
+    }
+
+    std::set<QString> ChainSimManifestRunner::recordedScenarios()
+    {
+        std::set<QString> recorded;
+        QFile file(m_options.output_dir + "/summary.csv");
+        if (!file.open(QIODevice::ReadWrite))
+            return recorded;
+
+        // A run killed mid-write leaves a line without its newline; drop it so the next row starts clean
+        auto contents = file.readAll();
+        auto complete = contents.lastIndexOf('\n') + 1;
+        if (complete < contents.size() && !file.resize(complete))
+        {
+            throw std::invalid_argument("Could not truncate " + file.fileName().toStdString());
+        }
+
+        auto lines = QString::fromUtf8(contents.left(complete)).split('\n', Qt::SkipEmptyParts);
+        for (qsizetype i = 1; i < lines.size(); ++i) // Line 0 is the header
+        {
+            auto fields = splitCsvLine(lines[i].trimmed());
+            if (fields.size() > 1)
+                recorded.insert(fields[0]);
+        }
+        return recorded;
+    }
+
+    void ChainSimManifestRunner::openSummary()
+    {
+        m_summary.setFileName(m_options.output_dir + "/summary.csv");
+        auto mode = QIODevice::WriteOnly | QIODevice::Text | (m_options.resume ? QIODevice::Append : QIODevice::Truncate);
+        if (!m_summary.open(mode))
+        {
+            throw std::invalid_argument("Could not open " + m_summary.fileName().toStdString());
+        }
+        if (m_summary.size() == 0)
+        {
+            m_summary.write(summaryColumns().join(',').toUtf8() + "\n");
+            m_summary.flush();
+        }
+    }
+
+    void ChainSimManifestRunner::appendSummary(const QStringList &row)
+    {
+        auto line = row.join(',').toUtf8() + "\n";
+        std::lock_guard<std::mutex> lock(m_summary_mutex);
+        m_summary.write(line);
+        m_summary.flush(); // A crashed run keeps every finished row for the next resume
+    }
+
+    std::vector<ManifestScenario> ChainSimManifestRunner::readJsonLines(const QStringList &lines)
+    {
+        std::vector<ManifestScenario> scenarios;
+        for (qsizetype i = 0; i < lines.size(); ++i)
+        {
+            auto line = lines[i].trimmed();
+            if (line.isEmpty())
+                continue;
+
+            auto where = "Manifest line " + std::to_string(i + 1) + ": ";
+            QJsonParseError error;
+            auto document = QJsonDocument::fromJson(line.toUtf8(), &error);
+            if (error.error != QJsonParseError::NoError || !document.isObject())
+            {
+                throw std::invalid_argument(where + "expected a JSON object");
+            }
+
+            ManifestScenario scenario;
+            auto object = document.object();
+            for (auto it = object.begin(); it != object.end(); ++it)
+            {
+                const auto &value = it.value();
+                QString text;
+                if (value.isString())
+                    text = value.toString();
+                else if (value.isDouble())
+                    text = QString::number(value.toDouble(), 'g', 17);
+                else if (value.isBool())
+                    text = value.toBool() ? "1" : "0";
+                else if (value.isNull())
+                    continue;
+                else
+                    throw std::invalid_argument(where + "\"" + it.key().toStdString() + "\" must be a string, number or boolean");
+
+                if (it.key() == "id")
+                    scenario.id = text;
+                else
+                    scenario.params.addQueryItem(it.key(), text);
+            }
+            scenarios.push_back(std::move(scenario));
+        }
+        return scenarios;
+    }
+
+    std::vector<ManifestScenario> ChainSimManifestRunner::readCsv(const QStringList &lines)
+    {
+        std::vector<ManifestScenario> scenarios;
+        QStringList header;
+        for (qsizetype i = 0; i < lines.size(); ++i)
+        {
+            if (lines[i].trimmed().isEmpty())
+                continue;
+
+            auto fields = splitCsvLine(lines[i]);
+            if (header.isEmpty())
+            {
+                header = fields;
+                continue;
+            }
+            if (fields.size() != header.size())
+            {
+                throw std::invalid_argument("Manifest line " + std::to_string(i + 1) + ": expected " +
+                                            std::to_string(header.size()) + " fields, found " +
+                                            std::to_string(fields.size()));
+            }
+
+            // Empty cells fall back to the defaults
+            ManifestScenario scenario;
+            for (qsizetype c = 0; c < header.size(); ++c)
+            {
+                if (fields[c].isEmpty())
+                    continue;
+                if (header[c] == "id")
+                    scenario.id = fields[c];
+                else
+                    scenario.params.addQueryItem(header[c], fields[c]);
+            }
+            scenarios.push_back(std::move(scenario));
+        }
+        return scenarios;
+    }
+
+    QStringList ChainSimManifestRunner::splitCsvLine(const QString &line)
+    {
+        QStringList fields;
+        QString field;
+        bool quoted = false;
+        for (qsizetype i = 0; i < line.size(); ++i)
+        {
+            auto c = line[i];
+            if (quoted)
+            {
+                if (c == '"' && i + 1 < line.size() && line[i + 1] == '"')
+                {
+                    field += '"';
+                    ++i;
+                }
+                else if (c == '"')
+                    quoted = false;
+                else
+                    field += c;
+            }
+            else if (c == '"')
+                quoted = true;
+            else if (c == ',')
+            {
+                fields << field.trimmed();
+                field.clear();
+            }
+            else
+                field += c;
+        }
+        fields << field.trimmed();
+        return fields;
+    }
+
+    QString ChainSimManifestRunner::csvField(const QString &value)
+    {
+        if (!value.contains(',') && !value.contains('"') && !value.contains('\n'))
+            return value;
+        return '"' + QString(value).replace('"', "\"\"").replace('\n', ' ') + '"';
+    }
+
+    void ChainSimManifestRunner::validateIds(std::vector<ManifestScenario> &scenarios)
+    {
+        // Ids name output files, so keep them to characters that are safe in a path
+        static const QRegularExpression pattern("^[A-Za-z0-9._-]+$");
+        std::set<QString> seen;
+        for (std::size_t i = 0; i < scenarios.size(); ++i)
+        {
+            auto &id = scenarios[i].id;
+            if (id.isEmpty())
+                id = QString("scenario-%1").arg(i + 1);
+            if (!pattern.match(id).hasMatch() || id.startsWith('.'))
+            {
+                throw std::invalid_argument("Invalid scenario id: " + id.toStdString());
+            }
+            if (!seen.insert(id).second)
+            {
+                throw std::invalid_argument("Duplicate scenario id: " + id.toStdString());
+            }
+        }
+    }
+
+} // namespace qz
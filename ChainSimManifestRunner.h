@@ -0,0 +1,82 @@
+#ifndef CHAINSIM_MANIFESTRUNNER_H
+#define CHAINSIM_MANIFESTRUNNER_H
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QUrlQuery>
+#include <mutex>
+#include <set>
+#include <vector>
+
+namespace qz
+{
+
+    // One manifest line: an id and the /simulate parameters it sets
+    struct ManifestScenario
+    {
+        QString id;
+        QUrlQuery params;
+    };
+
+    struct ManifestOptions
+    {
+        QString output_dir{"manifest_output"};
+        unsigned threads{0}; // 0 = one per core
+        unsigned shards{16};
+        bool resume{true}; // Skip scenarios summary.csv already has a row for, ok or failed
+    };
+
+    struct ManifestReport
+    {
+        std::size_t scenarios{0};
+        std::size_t skipped{0};
+        std::size_t succeeded{0};
+        std::size_t failed{0};
+    };
+
+    /* Runs every scenario of a manifest and writes their outputs under one directory.
+     *
+     * A manifest is a JSON-lines file of objects or a CSV file with a header row; keys and
+     * columns are /simulate parameters plus an optional `id`, and anything a scenario leaves out
+     * is taken from the defaults. Scenarios run on a work-stealing pool, so a few long horizons
+     * do not leave the other cores idle. Each scenario's records go to
+     * shard-NN/<id>.csv (NN = position in the manifest modulo the shard count, which keeps
+     * directories small for large sweeps) and its KPIs to one row of summary.csv, appended and
+     * flushed as soon as it finishes; a rerun resumes by skipping every scenario with a row,
+     * so every scenario keeps exactly one row.
+     */
+    class ChainSimManifestRunner
+    {
+    public:
+        ChainSimManifestRunner(QUrlQuery defaults, ManifestOptions options);
+
+        // Reads a .jsonl/.ndjson or .csv manifest; other extensions are detected from the first line
+        static std::vector<ManifestScenario> readManifest(const QString &path);
+
+        ManifestReport run(const std::vector<ManifestScenario> &scenarios);
+
+    private:
+        QUrlQuery scenarioParams(const ManifestScenario &scenario) const;
+        QString recordsPath(const QString &id, std::size_t index) const;
+        QStringList summaryColumns() const;
+        // Ids with a row in summary.csv; drops a trailing row a crash left incomplete
+        std::set<QString> recordedScenarios();
+        void openSummary();
+        void appendSummary(const QStringList &row);
+
+        static std::vector<ManifestScenario> readJsonLines(const QStringList &lines);
+        static std::vector<ManifestScenario> readCsv(const QStringList &lines);
+        static QStringList splitCsvLine(const QString &line);
+        static QString csvField(const QString &value);
+        static void validateIds(std::vector<ManifestScenario> &scenarios);
+
+        QUrlQuery m_defaults;
+        ManifestOptions m_options;
+        std::mutex m_summary_mutex;
+        QFile m_summary;
+    };
+
+} // namespace qz
+
+#endif // CHAINSIM_MANIFESTRUNNER_H
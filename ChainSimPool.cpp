@@ -0,0 +1,69 @@
+#include "ChainSimPool.h"
+#include "ChainSimBuilder.h"
+
+namespace qz
+{
+
+    void ChainSimPool::Recycler::operator()(ChainSim *simulation) const
+    {
+        if (m_pool)
+            m_pool->recycle(simulation);
+        else
+            delete simulation;
+    }
+
+    ChainSimPool::ChainSimPool(std::size_t max_idle) : m_max_idle(max_idle)
+    {
+    }
+
+    ChainSimPool::~ChainSimPool() = default;
+
+    ChainSimPool &ChainSimPool::shared()
+    {
+        // Never destroyed, so handles released during static destruction still have a pool
+        static auto *pool = new ChainSimPool();
+        return *pool;
+    }
+
+    ChainSimPool::Handle ChainSimPool::acquire(const ChainSimConfig &config)
+    {
+        ChainSimBuilder::validateConfiguration(config);
+
+        std::unique_ptr<ChainSim> simulation;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_idle.empty())
+            {
+                simulation = std::move(m_idle.back());
+                m_idle.pop_back();
+            }
+        }
+        if (!simulation)
+        {
+            simulation.reset(new ChainSim);
+        }
+
+        simulation->reset(config);
+        return Handle(simulation.release(), Recycler(this));
+    }
+
+    std::size_t ChainSimPool::idle() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_idle.size();
+    }
+
+    void ChainSimPool::recycle(ChainSim *simulation)
+    {
+        std::unique_ptr<ChainSim> owned(simulation);
+        if (!owned || owned->get_simulation_length() > kMaxPooledDays)
+            return;
+
+        owned->disconnect(); // Whoever listened to this run must not hear the next one
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_idle.size() < m_max_idle)
+            m_idle.push_back(std::move(owned));
+    }
+
+} // namespace qz
@@ -0,0 +1,63 @@
+#ifndef CHAINSIM_POOL_H
+#define CHAINSIM_POOL_H
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "ChainSim.h"
+
+namespace qz
+{
+
+    /* Idle ChainSim engines kept for reuse by short, high-rate runs.
+     *
+     * acquire() takes the most recently returned engine and re-targets it with ChainSim::reset,
+     * so a request skips the QObject construction, the sampler allocation (reseeded in place
+     * when the demand model is unchanged) and, once initialize_simulation refills them, the
+     * record column allocations. Handles give the engine back when they go out of scope, from
+     * any thread. Engines with longer horizons than kMaxPooledDays are freed instead of kept,
+     * which bounds the memory parked in the pool.
+     */
+    class ChainSimPool
+    {
+    public:
+        static constexpr std::size_t kMaxIdle = 32;
+        static constexpr quint64 kMaxPooledDays = 10000;
+
+        class Recycler
+        {
+        public:
+            Recycler() = default;
+            explicit Recycler(ChainSimPool *pool) : m_pool(pool) {}
+            void operator()(ChainSim *simulation) const;
+
+        private:
+            ChainSimPool *m_pool{nullptr};
+        };
+        using Handle = std::unique_ptr<ChainSim, Recycler>;
+
+        explicit ChainSimPool(std::size_t max_idle = kMaxIdle);
+        ~ChainSimPool();
+
+        ChainSimPool(const ChainSimPool &) = delete;
+        ChainSimPool &operator=(const ChainSimPool &) = delete;
+
+        // The process-wide pool the server draws from; it outlives every handle
+        static ChainSimPool &shared();
+
+        // An engine configured as ChainSimBuilder::create() would make it; throws on an invalid config
+        Handle acquire(const ChainSimConfig &config);
+
+        [[nodiscard]] std::size_t idle() const;
+
+    private:
+        void recycle(ChainSim *simulation);
+
+        std::size_t m_max_idle;
+        mutable std::mutex m_mutex;
+        std::vector<std::unique_ptr<ChainSim>> m_idle;
+    };
+
+} // namespace qz
+
+#endif // CHAINSIM_POOL_H
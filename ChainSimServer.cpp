@@ -5,16 +5,58 @@
 #include <QHttpServerResponse>
 #include <QHttpServerRequest>
 #include <QHttpHeaders>
+#include <QHttpServerResponder>
+#include <QThread>
+#include <QTimer>
 #include "purchase_policies/PurchaseROP.h"
 #include "purchase_policies/PurchaseEOQ.h"
 #include "purchase_policies/PurchaseTPOP.h"
+#include "utils/Downsample.hpp"
+#include "utils/JsonWriter.hpp"
+#include "utils/Metrics.hpp"
+#include "utils/RequestArena.hpp"
+#include "utils/SamplingProfiler.hpp"
+#include "utils/SingleFlight.hpp"
+#include "utils/Trace.hpp"
+#include "utils/WindowAggregates.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <iterator>
+#include <map>
 
 namespace qz
 {
 
+    struct ChainSimServer::ProfileSession
+    {
+        explicit ProfileSession(QHttpServerResponder &&r) : responder(std::move(r)) {}
+
+        // Counted until the profile is sent
+        ScopedRequest metrics{ServerMetrics::Route::Debug};
+        QHttpServerResponder responder;
+    };
+
     ChainSimServer::ChainSimServer(QObject *parent)
-        : QObject(parent), m_logger(2)
+        : ChainSimServer(std::make_shared<ResultStore>(), parent)
+    {
+    }
+
+    ChainSimServer::ChainSimServer(std::shared_ptr<ResultStore> results, QObject *parent)
+        : QObject(parent), m_logger(2), m_results(std::move(results))
+    {
+    }
+
+    ChainSimServer::~ChainSimServer()
     {
+        // The timer that ends the profile dies with this server, so the profiler is stopped here
+        if (m_profile)
+        {
+            SamplingProfiler::instance().stop();
+            m_profile->metrics.set_status(503);
+            m_profile->responder.write(QJsonDocument(QJsonObject{{"error", "Server stopped before the profile finished"}}),
+                                       QHttpServerResponder::StatusCode::ServiceUnavailable);
+        }
     }
 
     bool ChainSimServer::start(quint16 port)
@@ -23,37 +65,64 @@ namespace qz
         m_tcpServer = std::make_unique<QTcpServer>();
 
         // Setup routes before binding
+        setupRoutes();
+
+        // Start listening on all interfaces with specified port
+        if (!m_tcpServer->listen(QHostAddress::AnyIPv4, port))
+        {
+            m_logger.error(QString("Failed to start TCP server on port %1: %2")
+                               .arg(port)
+                               .arg(m_tcpServer->errorString()));
+            return false;
+        }
+
+        return bindTcpServer();
+    }
+
+    bool ChainSimServer::startOnSocket(qintptr socketDescriptor)
+    {
+        m_tcpServer = std::make_unique<QTcpServer>();
+        setupRoutes();
+
+        // Adopt a socket that is already bound and listening (e.g. one of several SO_REUSEPORT sockets)
+        if (!m_tcpServer->setSocketDescriptor(socketDescriptor))
+        {
+            m_logger.error(QString("Failed to adopt listening socket: %1").arg(m_tcpServer->errorString()));
+            return false;
+        }
+
+        return bindTcpServer();
+    }
+
+    void ChainSimServer::setupRoutes()
+    {
         m_server.route("/simulate", QHttpServerRequest::Method::Post,
                        [this](const QHttpServerRequest &request)
                        {
+                           ScopedRequest metrics(ServerMetrics::Route::Simulate);
                            QUrlQuery query(request.url().query());
-                           QString origin;
+                           QString origin = requestOrigin(request);
                            try
                            {
-                               // Get the Origin header from the request
-                               origin = request.value("Origin");
-                               if (origin.isEmpty())
-                               {
-                                   origin = "*"; // Fallback to allow all if no Origin header
-                               }
-
                                // Log request if log level is 2
                                if (query.hasQueryItem("log_level") && query.queryItemValue("log_level").toUInt() >= 2)
                                {
                                    printRequestDetails(query);
                                }
 
-                               QJsonObject result = runSimulation(query);
+                               auto result = coalescedSimulation(query);
                                m_logger.info("Simulation finished successfully");
 
                                // Create response with CORS headers
-                               auto response = QHttpServerResponse(result);
+                               ScopedPhase phase(ServerMetrics::Phase::Write);
+                               auto response = QHttpServerResponse("application/json", result->body);
                                QHttpHeaders headers = response.headers();
-                               if (isAllowedOrigin(origin))
-                                   headers.append("Access-Control-Allow-Origin", origin);
-
-                               headers.append("Access-Control-Allow-Methods", "POST, OPTIONS");
-                               headers.append("Access-Control-Allow-Headers", "Content-Type, Authorization");
+                               addCorsHeaders(headers, origin);
+                               if (result->stored)
+                               {
+                                   headers.append("X-ChainSim-Result-Id", result->stored->id);
+                                   headers.append("Access-Control-Expose-Headers", "X-ChainSim-Result-Id");
+                               }
                                response.setHeaders(headers);
                                return response;
                            }
@@ -62,48 +131,204 @@ namespace qz
                                QJsonObject error{
                                    {"error", e.what()}};
                                m_logger.error(QString("Simulation failed: %1").arg(e.what()));
+                               metrics.set_status(400);
 
                                // Create error response with CORS headers
                                auto response = QHttpServerResponse(error, QHttpServerResponse::StatusCode::BadRequest);
                                QHttpHeaders headers = response.headers();
-                               if (isAllowedOrigin(origin))
-                                   headers.append("Access-Control-Allow-Origin", origin);
-
-                               headers.append("Access-Control-Allow-Methods", "POST, OPTIONS");
-                               headers.append("Access-Control-Allow-Headers", "Content-Type, Authorization");
+                               addCorsHeaders(headers, origin);
                                response.setHeaders(headers);
                                return response;
                            }
                        });
 
+        // Searches the policy's parameters for the cheapest ones meeting a service-level target
+        m_server.route("/optimize", QHttpServerRequest::Method::Post,
+                       [this](const QHttpServerRequest &request)
+                       {
+                           return jsonRoute(ServerMetrics::Route::Optimize, request, [this](const QUrlQuery &query)
+                                            { return QHttpServerResponse(runOptimization(query)); });
+                       });
+
+        // Exact steady-state KPIs for discrete demand, simulating only when the chain is intractable
+        m_server.route("/evaluate", QHttpServerRequest::Method::Post,
+                       [this](const QHttpServerRequest &request)
+                       {
+                           return jsonRoute(ServerMetrics::Route::Evaluate, request, [this](const QUrlQuery &query)
+                                            { return QHttpServerResponse(runEvaluation(query)); });
+                       });
+
+        // Independent replications until the requested confidence-interval precision is reached
+        m_server.route("/replicate", QHttpServerRequest::Method::Post,
+                       [this](const QHttpServerRequest &request)
+                       {
+                           return jsonRoute(ServerMetrics::Route::Replicate, request, [this](const QUrlQuery &query)
+                                            { return QHttpServerResponse(runReplications(query)); });
+                       });
+
+        // Importance-sampling estimates of rare stockouts, for service levels plain replications cannot resolve
+        m_server.route("/stockout_risk", QHttpServerRequest::Method::Post,
+                       [this](const QHttpServerRequest &request)
+                       {
+                           return jsonRoute(ServerMetrics::Route::StockoutRisk, request, [this](const QUrlQuery &query)
+                                            { return QHttpServerResponse(runStockoutRisk(query)); });
+                       });
+
+        // Sobol indices: which scenario parameters drive the KPIs' variance over the given ranges
+        m_server.route("/sensitivity", QHttpServerRequest::Method::Post,
+                       [this](const QHttpServerRequest &request)
+                       {
+                           return jsonRoute(ServerMetrics::Route::Sensitivity, request, [this](const QUrlQuery &query)
+                                            { return QHttpServerResponse(runSensitivity(query)); });
+                       });
+
+        // Several policies advanced side by side on the same demand, with paired differences
+        m_server.route("/compare", QHttpServerRequest::Method::Post,
+                       [this](const QHttpServerRequest &request)
+                       {
+                           return jsonRoute(ServerMetrics::Route::Compare, request, [this](const QUrlQuery &query)
+                                            { return QHttpServerResponse(runComparison(query)); });
+                       });
+
+        // Server-Sent Events stream of the same simulation, delivered in batches while it runs
+        m_server.route("/simulate/stream", QHttpServerRequest::Method::Get,
+                       [this](const QHttpServerRequest &request, QHttpServerResponder &responder)
+                       {
+                           QUrlQuery query(request.url().query());
+                           if (query.hasQueryItem("log_level") && query.queryItemValue("log_level").toUInt() >= 2)
+                           {
+                               printRequestDetails(query);
+                           }
+                           streamSimulation(query, requestOrigin(request), responder);
+                       });
+
+        // Range/projection/downsampling queries over a retained result
+        m_server.route("/results/<arg>/series", QHttpServerRequest::Method::Get,
+                       [this](const QString &id, const QHttpServerRequest &request)
+                       {
+                           return jsonRoute(ServerMetrics::Route::Series, request, [this, &id](const QUrlQuery &query)
+                                            {
+                                                auto stored = m_results->find(id);
+                                                return stored ? QHttpServerResponse(querySeries(*stored, query))
+                                                              : unknownResultResponse();
+                                            });
+                       });
+
+        // Explanations of a retained result's purchase decisions, rendered only for the requested days
+        m_server.route("/results/<arg>/explain", QHttpServerRequest::Method::Get,
+                       [this](const QString &id, const QHttpServerRequest &request)
+                       {
+                           return jsonRoute(ServerMetrics::Route::Explain, request, [this, &id](const QUrlQuery &query)
+                                            {
+                                                auto stored = m_results->find(id);
+                                                return stored ? QHttpServerResponse(explainDecisions(*stored, query))
+                                                              : unknownResultResponse();
+                                            });
+                       });
+
+        // Rolling, cumulative and per-period aggregates of a retained result's columns
+        m_server.route("/results/<arg>/aggregate", QHttpServerRequest::Method::Get,
+                       [this](const QString &id, const QHttpServerRequest &request)
+                       {
+                           return jsonRoute(ServerMetrics::Route::Aggregate, request, [this, &id](const QUrlQuery &query)
+                                            {
+                                                auto stored = m_results->find(id);
+                                                if (!stored)
+                                                    return unknownResultResponse();
+                                                auto aggregates = aggregateRecords(stored->records, query);
+                                                aggregates.insert("id", stored->id);
+                                                return QHttpServerResponse(aggregates);
+                                            });
+                       });
+
+        // Prometheus text exposition of request, latency and engine metrics
+        m_server.route("/metrics", QHttpServerRequest::Method::Get,
+                       []()
+                       {
+                           ScopedRequest metrics(ServerMetrics::Route::Metrics);
+                           return QHttpServerResponse("text/plain; version=0.0.4",
+                                                      QByteArray::fromStdString(ServerMetrics::instance().exposition()));
+                       });
+
+        // Chrome trace-event JSON of the spans buffered on every thread; enable=0|1 switches
+        // recording, clear=1 drops what was returned
+        m_server.route("/debug/trace", QHttpServerRequest::Method::Get,
+                       [](const QHttpServerRequest &request)
+                       {
+                           ScopedRequest metrics(ServerMetrics::Route::Debug);
+                           QUrlQuery query(request.url().query());
+                           auto &tracer = Tracer::instance();
+                           if (query.hasQueryItem("enable"))
+                           {
+                               tracer.set_enabled(query.queryItemValue("enable") != "0");
+                           }
+
+                           auto trace = QByteArray::fromStdString(tracer.to_json());
+                           if (query.queryItemValue("clear") == "1")
+                           {
+                               tracer.clear();
+                           }
+                           auto response = QHttpServerResponse("application/json", trace);
+                           QHttpHeaders headers = response.headers();
+                           headers.append("X-ChainSim-Tracing", tracer.enabled() ? "on" : "off");
+                           response.setHeaders(headers);
+                           return response;
+                       });
+
+        // Folded CPU stacks of every thread, sampled for `seconds`; opt-in, see profilingEnabled()
+        m_server.route("/debug/profile", QHttpServerRequest::Method::Get,
+                       [this](const QHttpServerRequest &request, QHttpServerResponder &responder)
+                       {
+                           profileProcess(QUrlQuery(request.url().query()), responder);
+                       });
+
         // Add OPTIONS route for CORS preflight
         m_server.route("/simulate", QHttpServerRequest::Method::Options,
                        [this](const QHttpServerRequest &request)
                        {
-                           QString origin = request.value("Origin");
-                           if (origin.isEmpty())
-                               origin = "*";
-
+                           ScopedRequest metrics(ServerMetrics::Route::Other);
+                           metrics.set_status(204);
                            auto response = QHttpServerResponse(QHttpServerResponse::StatusCode::NoContent);
                            QHttpHeaders headers = response.headers();
-                           if (this->isAllowedOrigin(origin))
-                               headers.append("Access-Control-Allow-Origin", origin);
-
-                           headers.append("Access-Control-Allow-Methods", "POST, OPTIONS");
-                           headers.append("Access-Control-Allow-Headers", "Content-Type, Authorization");
+                           addCorsHeaders(headers, requestOrigin(request));
                            response.setHeaders(headers);
                            return response;
                        });
+    }
 
-        // Start listening on all interfaces with specified port
-        if (!m_tcpServer->listen(QHostAddress::AnyIPv4, port))
+    QHttpServerResponse ChainSimServer::jsonRoute(ServerMetrics::Route route, const QHttpServerRequest &request,
+                                                  const std::function<QHttpServerResponse(const QUrlQuery &)> &handle)
+    {
+        ScopedRequest metrics(route);
+        QUrlQuery query(request.url().query());
+        QHttpServerResponse response = [&]()
         {
-            m_logger.error(QString("Failed to start TCP server on port %1: %2")
-                               .arg(port)
-                               .arg(m_tcpServer->errorString()));
-            return false;
-        }
+            try
+            {
+                return handle(query);
+            }
+            catch (const std::exception &e)
+            {
+                m_logger.error(QString("Request to %1 failed: %2").arg(ServerMetrics::route_label(route)).arg(e.what()));
+                return QHttpServerResponse(QJsonObject{{"error", e.what()}}, QHttpServerResponse::StatusCode::BadRequest);
+            }
+        }();
+        metrics.set_status(static_cast<int>(response.statusCode()));
 
+        QHttpHeaders headers = response.headers();
+        addCorsHeaders(headers, requestOrigin(request));
+        response.setHeaders(headers);
+        return response;
+    }
+
+    QHttpServerResponse ChainSimServer::unknownResultResponse()
+    {
+        return QHttpServerResponse(QJsonObject{{"error", "Unknown or expired result id"}},
+                                   QHttpServerResponse::StatusCode::NotFound);
+    }
+
+    bool ChainSimServer::bindTcpServer()
+    {
         // Bind HTTP server to TCP server
         if (!m_server.bind(m_tcpServer.get()))
         {
@@ -112,9 +337,25 @@ namespace qz
             return false;
         }
 
-        quint16 actualPort = m_tcpServer->serverPort();
-        m_logger.info(QString("Server running on http://127.0.0.1:%1/").arg(actualPort));
+        m_port = m_tcpServer->serverPort();
+        m_logger.info(QString("Server running on http://127.0.0.1:%1/").arg(m_port));
         m_logger.info("Use endpoint /simulate with POST method and query parameters for simulation requests");
+        m_logger.info("Use endpoint /simulate/stream with GET method to receive progress as Server-Sent Events");
+        m_logger.info("Use endpoint /results/<id>/series with GET method to query ranges of a retained result");
+        m_logger.info("Use endpoint /results/<id>/explain with GET method to explain a retained result's decisions");
+        m_logger.info("Use endpoint /results/<id>/aggregate with GET method for rolling and per-period aggregates of a retained result");
+        m_logger.info("Use endpoint /optimize with POST method to tune policy parameters for a service-level target");
+        m_logger.info("Use endpoint /evaluate with POST method for analytical steady-state KPIs");
+        m_logger.info("Use endpoint /replicate with POST method to replicate until a precision target is met");
+        m_logger.info("Use endpoint /stockout_risk with POST method for importance-sampled stockout probabilities");
+        m_logger.info("Use endpoint /sensitivity with POST method for Sobol indices of scenario parameters");
+        m_logger.info("Use endpoint /compare with POST method to compare policies on common demand paths");
+        m_logger.info("Use endpoint /metrics with GET method for Prometheus metrics");
+        m_logger.info("Use endpoint /debug/trace with GET method for a Chrome trace of request phases (enable=1 to record)");
+        if (profilingEnabled())
+        {
+            m_logger.info("Use endpoint /debug/profile with GET method for folded CPU stacks (seconds, hz)");
+        }
 
         // TCP server is now owned by HTTP server
         m_tcpServer.release();
@@ -122,6 +363,26 @@ namespace qz
         return true;
     }
 
+    QString ChainSimServer::requestOrigin(const QHttpServerRequest &request) const
+    {
+        // Get the Origin header from the request
+        QString origin = request.value("Origin");
+        if (origin.isEmpty())
+        {
+            origin = "*"; // Fallback to allow all if no Origin header
+        }
+        return origin;
+    }
+
+    void ChainSimServer::addCorsHeaders(QHttpHeaders &headers, const QString &origin)
+    {
+        if (isAllowedOrigin(origin))
+            headers.append("Access-Control-Allow-Origin", origin);
+
+        headers.append("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
+        headers.append("Access-Control-Allow-Headers", "Content-Type, Authorization");
+    }
+
     void ChainSimServer::printRequestDetails(const QUrlQuery &params)
     {
         QString separator(80, '=');
@@ -164,7 +425,15 @@ namespace qz
         m_logger.info(separator);
     }
 
-    QJsonObject ChainSimServer::runSimulation(const QUrlQuery &params)
+    std::unique_ptr<ChainSim> ChainSimServer::createSimulation(const QUrlQuery &params)
+    {
+        ChainSimBuilder builder;
+        configureBuilder(builder, params);
+        TraceSpan span("ChainSimBuilder::create", "engine");
+        return builder.create();
+    }
+
+    void ChainSimServer::configureBuilder(ChainSimBuilder &builder, const QUrlQuery &params)
     {
         validateParameters(params);
 
@@ -175,13 +444,12 @@ namespace qz
         auto starting_inventory = params.queryItemValue("starting_inventory").toULongLong();
         auto seed = params.queryItemValue("seed").toUInt();
         bool deterministic = params.hasQueryItem("deterministic");
-        QString output_file = params.queryItemValue("output_file");
+        bool summary_only = params.hasQueryItem("summary_only");
+        bool distributions = params.queryItemValue("distributions") != "0";
 
         // Get demand distribution and its parameters
         QString distribution = params.queryItemValue("demand_distribution");
 
-        // Create builder and maintain reference
-        ChainSimBuilder &builder = *(new ChainSimBuilder());
         builder.setSimulationName("ChainSim")
             .setSimulationLength(simulation_length)
             .setLeadTime(lead_time)
@@ -189,7 +457,10 @@ namespace qz
             .setDeterministic(deterministic)
             .setSeed(seed)
             .setStartingInventory(starting_inventory)
-            .setLoggingLevel(log_level);
+            .setLoggingLevel(log_level)
+            .setRecordHistory(!summary_only)
+            .setTrackDistributions(distributions)
+            .setTraceDecisions(!summary_only); // Retained results can explain their decisions
 
         // Configure distribution-specific parameters
         if (distribution == "normal")
@@ -222,50 +493,542 @@ namespace qz
             builder.setAverageDemand(demand)
                 .setDeterministic(true);
         }
+    }
+
+    ChainSimPool::Handle ChainSimServer::runSimulation(const QUrlQuery &params)
+    {
+        ChainSimPool::Handle chainSimulator;
+        std::unique_ptr<PurchasePolicy> policy;
+        QString output_file = params.queryItemValue("output_file");
+        {
+            ScopedPhase phase(ServerMetrics::Phase::Parse);
+            ChainSimBuilder builder;
+            configureBuilder(builder, params);
+            policy = createPolicy(params);
+            // A recycled engine: small runs would otherwise spend as long in setup as in simulate
+            TraceSpan span("ChainSimPool::acquire", "engine");
+            chainSimulator = ChainSimPool::shared().acquire(builder.config());
+        }
+
+        // Run simulation with policy
+        auto started = std::chrono::steady_clock::now();
+        {
+            ScopedPhase phase(ServerMetrics::Phase::Simulate);
+            {
+                TraceSpan span("initialize_simulation", "engine");
+                chainSimulator->initialize_simulation();
+            }
+            TraceSpan span("simulate", "engine");
+            chainSimulator->simulate(*policy);
+        }
+        ServerMetrics::instance().record_simulated_days(chainSimulator->get_simulation_length(),
+                                                        std::chrono::steady_clock::now() - started);
+
+        // Optionally save to file if specified
+        if (!output_file.isEmpty() && chainSimulator->is_recording_history())
+        {
+            ScopedPhase phase(ServerMetrics::Phase::Write);
+            writeRecordsCsv(chainSimulator->get_simulation_records(), output_file);
+        }
+
+        return chainSimulator;
+    }
+
+    struct ChainSimServer::SimulationResult
+    {
+        QByteArray body;
+        std::shared_ptr<const StoredResult> stored; // Null for summary-only runs
+    };
+
+    std::shared_ptr<const ChainSimServer::SimulationResult> ChainSimServer::computeSimulation(const QUrlQuery &params)
+    {
+        auto simulation = runSimulation(params);
+        auto result = std::make_shared<SimulationResult>();
+
+        // Summary-only runs never materialize the per-day records
+        if (!simulation->is_recording_history())
+        {
+            ScopedPhase phase(ServerMetrics::Phase::Serialize);
+            QJsonObject summary{{"kpis", kpisToJson(simulation->get_kpis())},
+                                {"distributions", distributionsToJson(simulation->get_distributions())}};
+            result->body = QJsonDocument(summary).toJson(QJsonDocument::Compact);
+            return result;
+        }
+
+        // Retain the result so charts can query ranges of it later
+        // Policies are a pure function of the request, so the one that explains the trace is rebuilt
+        result->stored = m_results->insert(simulation->get_simulation_records(),
+                                           simulation->get_decisions(), createPolicy(params));
+
+        ScopedPhase phase(ServerMetrics::Phase::Serialize);
+        result->body = simulationRecordsToJsonBytes(result->stored->records);
+        return result;
+    }
+
+    std::shared_ptr<const ChainSimServer::SimulationResult> ChainSimServer::coalescedSimulation(const QUrlQuery &params)
+    {
+        // Each request naming an output file has to write it
+        if (params.hasQueryItem("output_file"))
+        {
+            return computeSimulation(params);
+        }
+
+        // Shared by every worker of a ChainSimServerPool, so bursts spread over threads still coalesce;
+        // a single server handles requests one at a time on its event loop, so they never overlap there
+        static SingleFlight<std::string, std::shared_ptr<const SimulationResult>> inFlight;
+
+        auto call = inFlight.run(coalescingKey(params), [&]()
+                                 { return computeSimulation(params); });
+        if (call.shared)
+        {
+            ServerMetrics::instance().record_coalesced();
+            if (call.value->stored)
+            {
+                m_results->insert(call.value->stored); // Another server's store may hold it; make the id resolvable here
+            }
+        }
+        return call.value;
+    }
+
+    std::string ChainSimServer::coalescingKey(const QUrlQuery &params)
+    {
+        // Runs are deterministic in the engine configuration and the policy inputs, so the parsed
+        // values identify the result: 50 and 50.0 are the same request, and settings that do not
+        // change it (log_level, parameters the distribution ignores) are left out
+        ChainSimBuilder builder;
+        configureBuilder(builder, params);
+        const auto &config = builder.config();
+
+        auto number = [](double value)
+        { return QString::number(value, 'g', 17); };
+        QString policy = params.queryItemValue("policy");
+        QStringList fields{
+            QString::number(config.simulation_length),
+            QString::number(config.lead_time),
+            number(config.average_demand),
+            number(config.demand_stddev),
+            QString::number(config.deterministic),
+            QString::number(config.seed),
+            QString::number(config.starting_inventory),
+            QString::number(static_cast<int>(config.demand_distribution)),
+            number(config.gamma_shape),
+            number(config.gamma_scale),
+            number(config.uniform_min),
+            number(config.uniform_max),
+            QString::number(config.record_history),
+            QString::number(config.track_distributions),
+            QString::number(config.trace_decisions),
+            QString::number(config.resumable),
+            // What createPolicy reads besides the lead time
+            policy,
+            number(params.queryItemValue("average_demand").toDouble())};
+        if (policy == "EOQ")
+        {
+            fields << number(params.queryItemValue("ordering_cost").toDouble())
+                   << number(params.queryItemValue("holding_cost").toDouble());
+        }
+        else if (policy == "TPOP")
+        {
+            fields << QString::number(params.queryItemValue("purchase_period").toUInt());
+        }
+        return fields.join(',').toStdString();
+    }
 
-        // Create and run simulation
-        auto chainSimulator = builder.create();
-        delete &builder; // Clean up the builder
+    std::function<std::unique_ptr<ChainSim>(unsigned)> ChainSimServer::replicationFactory(const QUrlQuery &params,
+                                                                                           bool distributions)
+    {
+        // Replications only need KPIs; the seed is the only thing that differs between them
+        QUrlQuery base(params);
+        for (const char *name : {"seed", "log_level", "summary_only"})
+        {
+            base.removeAllQueryItems(name);
+        }
+        base.addQueryItem("summary_only", "1");
+        if (!distributions)
+        {
+            base.removeAllQueryItems("distributions");
+            base.addQueryItem("distributions", "0");
+        }
 
-        chainSimulator->initialize_simulation();
+        return [base](unsigned seed)
+        {
+            QUrlQuery query(base);
+            query.addQueryItem("seed", QString::number(seed));
+            return createSimulation(query);
+        };
+    }
 
-        // Create policy before simulation
+    OptimizerCosts ChainSimServer::parseCosts(const QUrlQuery &params)
+    {
+        auto number = [&params](const QString &name, double fallback)
+        {
+            return params.hasQueryItem(name) ? params.queryItemValue(name).toDouble() : fallback;
+        };
+
+        // holding_cost is the annual rate per unit, as for EOQ
+        OptimizerCosts costs;
+        costs.holding_per_unit_day = number("holding_cost", 0.2) / 365.0;
+        costs.ordering_per_order = number("ordering_cost", 100.0);
+        costs.stockout_per_unit = number("stockout_cost", 10.0);
+        return costs;
+    }
+
+    QJsonObject ChainSimServer::runOptimization(const QUrlQuery &params)
+    {
+        validateParameters(params);
+        auto heuristic = createPolicy(params);
+        auto lead_time = params.queryItemValue("average_lead_time").toUInt();
+        auto demand = params.queryItemValue("average_demand").toDouble();
+        auto horizon = params.queryItemValue("simulation_length").toULongLong();
+
+        auto number = [&params](const QString &name, double fallback)
+        {
+            return params.hasQueryItem(name) ? params.queryItemValue(name).toDouble() : fallback;
+        };
+
+        auto costs = parseCosts(params);
+
+        OptimizerOptions options;
+        options.target_service_level = number("target_service_level", options.target_service_level);
+        options.replications = qBound(2u, static_cast<unsigned>(number("replications", options.replications)), 1000u);
+        options.max_iterations = qBound(1u, static_cast<unsigned>(number("optimizer_iterations", options.max_iterations)), 1000u);
+        options.base_seed = params.queryItemValue("seed").toUInt();
+
+        PolicyOptimizer optimizer(replicationFactory(params, false),
+                                  PolicyOptimizer::policy_factory(params.queryItemValue("policy"), lead_time),
+                                  PolicyOptimizer::parameter_space(*heuristic, lead_time, demand, horizon),
+                                  costs, options);
+
+        auto started = std::chrono::steady_clock::now();
+        auto result = optimizer.optimize();
+        m_logger.info(QString("Optimized %1 in %2 evaluations (%3 ms)")
+                          .arg(heuristic->name())
+                          .arg(result.evaluations)
+                          .arg(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                   std::chrono::steady_clock::now() - started)
+                                   .count()));
+
+        auto json = optimizationResultToJson(result);
+        json["policy"] = params.queryItemValue("policy");
+        return json;
+    }
+
+    QJsonObject ChainSimServer::runEvaluation(const QUrlQuery &params)
+    {
+        validateParameters(params);
         auto policy = createPolicy(params);
 
-        // Run simulation with policy
-        chainSimulator->simulate(*policy);
+        MarkovEvaluator::Options options;
+        if (params.hasQueryItem("max_states"))
+        {
+            options.max_states = params.queryItemValue("max_states").toULongLong();
+        }
 
-        // Get results
-        auto simulation_records = chainSimulator->get_simulation_records();
+        QString distribution = params.hasQueryItem("deterministic") ? QStringLiteral("fixed")
+                                                                    : params.queryItemValue("demand_distribution");
+        MarkovEvaluator evaluator(distribution,
+                                  params.queryItemValue("average_demand").toDouble(),
+                                  params.queryItemValue("average_lead_time").toUInt(),
+                                  params.queryItemValue("starting_inventory").toULongLong(),
+                                  params.queryItemValue("simulation_length").toULongLong(),
+                                  options);
 
-        // Optionally save to file if specified
-        if (!output_file.isEmpty())
+        auto fallback = [&params]()
+        {
+            QUrlQuery query(params);
+            query.removeAllQueryItems("log_level");
+            query.addQueryItem("summary_only", "1");
+            query.addQueryItem("distributions", "0");
+            return createSimulation(query);
+        };
+
+        auto evaluation = evaluator.evaluate(*policy, fallback);
+        if (!evaluation.analytical)
+        {
+            m_logger.warn(QString("Analytical evaluation fell back to simulation: %1").arg(evaluation.fallback_reason));
+        }
+        return markovEvaluationToJson(evaluation);
+    }
+
+    QJsonObject ChainSimServer::runReplications(const QUrlQuery &params)
+    {
+        validateParameters(params);
+        auto targets = ReplicationRunner::parse_targets(params.queryItemValue("precision"));
+        createPolicy(params); // Reject an unknown policy before any replication runs
+
+        ReplicationOptions options;
+        if (params.hasQueryItem("confidence_level"))
         {
-            QFile file(output_file);
-            if (file.open(QIODevice::WriteOnly | QIODevice::Text))
+            options.confidence_level = params.queryItemValue("confidence_level").toDouble();
+            if (!(options.confidence_level > 0.0 && options.confidence_level < 1.0))
             {
-                QTextStream out(&file);
-                // Write CSV header
-                out << "Day,inventory_quantity,demand_quantity,procurement_quantity,"
-                    << "purchase_quantity,sale_quantity,lost_sale_quantity\n";
+                throw std::invalid_argument("confidence_level must be in (0, 1)");
+            }
+        }
+        if (params.hasQueryItem("min_replications"))
+        {
+            options.min_replications = params.queryItemValue("min_replications").toUInt();
+        }
+        if (params.hasQueryItem("max_replications"))
+        {
+            options.max_replications = qMin(params.queryItemValue("max_replications").toUInt(), 10000u);
+        }
+        options.base_seed = params.queryItemValue("seed").toUInt();
 
-                // Write data
-                for (int i = 0; i < simulation_records.begin().value().size(); ++i)
-                {
-                    out << i << ","
-                        << simulation_records["inventory_quantity"][i] << ","
-                        << simulation_records["demand_quantity"][i] << ","
-                        << simulation_records["procurement_quantity"][i] << ","
-                        << simulation_records["purchase_quantity"][i] << ","
-                        << simulation_records["sale_quantity"][i] << ","
-                        << simulation_records["lost_sale_quantity"][i] << "\n";
-                }
-                file.close();
+        auto policies = [params]()
+        {
+            return createPolicy(params);
+        };
+
+        ReplicationRunner runner(replicationFactory(params, true), policies, targets, options);
+        auto started = std::chrono::steady_clock::now();
+        auto result = runner.run();
+        m_logger.info(QString("Ran %1 replications in %2 batches (%3 ms), %4")
+                          .arg(result.replications)
+                          .arg(result.batches)
+                          .arg(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                   std::chrono::steady_clock::now() - started)
+                                   .count())
+                          .arg(result.converged ? "precision reached" : "budget exhausted"));
+        return replicationResultToJson(result);
+    }
+
+    QJsonObject ChainSimServer::runStockoutRisk(const QUrlQuery &params)
+    {
+        validateParameters(params);
+        createPolicy(params); // Reject an unknown policy before any replication runs
+
+        auto number = [&params](const QString &name, double fallback)
+        {
+            return params.hasQueryItem(name) ? params.queryItemValue(name).toDouble() : fallback;
+        };
+
+        // The window defaults to one lead time plus the day its delivery arrives
+        RareEventOptions options;
+        options.tilt = number("tilt", options.tilt);
+        options.window = static_cast<quint64>(number("window", params.queryItemValue("average_lead_time").toDouble() + 1.0));
+        options.replications = qBound(2u, static_cast<unsigned>(number("replications", options.replications)), 100000u);
+        options.pilot_replications = qBound(2u, static_cast<unsigned>(number("pilot_replications", options.pilot_replications)), 100000u);
+        options.confidence_level = number("confidence_level", options.confidence_level);
+        options.base_seed = params.queryItemValue("seed").toUInt();
+
+        auto policies = [params]()
+        {
+            return createPolicy(params);
+        };
+
+        RareEventEstimator estimator(replicationFactory(params, false), policies, options);
+        auto started = std::chrono::steady_clock::now();
+        auto estimate = estimator.estimate();
+        m_logger.info(QString("Estimated stockout probability %1 with tilt %2 (%3 ms)")
+                          .arg(estimate.stockout_probability.mean)
+                          .arg(estimate.tilt)
+                          .arg(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                   std::chrono::steady_clock::now() - started)
+                                   .count()));
+        return rareEventEstimateToJson(estimate);
+    }
+
+    QJsonObject ChainSimServer::runSensitivity(const QUrlQuery &params)
+    {
+        auto started = std::chrono::steady_clock::now();
+        auto result = analyzeSensitivity(params);
+        m_logger.info(QString("Sensitivity analysis of %1 parameters in %2 simulations (%3 ms)")
+                          .arg(result.outputs.empty() ? 0 : static_cast<qint64>(result.outputs.front().parameters.size()))
+                          .arg(result.evaluations)
+                          .arg(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                   std::chrono::steady_clock::now() - started)
+                                   .count()));
+        return sensitivityResultToJson(result);
+    }
+
+    SensitivityResult ChainSimServer::analyzeSensitivity(const QUrlQuery &params)
+    {
+        // Scenario parameters that can be ranged; counts are drawn as integers
+        static const QStringList kContinuous = {"average_demand", "std_demand", "ordering_cost", "holding_cost",
+                                                "stockout_cost", "gamma_shape", "gamma_scale", "uniform_min",
+                                                "uniform_max"};
+        static const QStringList kInteger = {"average_lead_time", "starting_inventory", "purchase_period"};
+
+        if (!params.hasQueryItem("ranges"))
+        {
+            throw std::invalid_argument("Missing required parameter: ranges");
+        }
+        auto parameters = SensitivityAnalysis::parse_parameters(params.queryItemValue("ranges"));
+
+        auto with_point = [parameters](const QUrlQuery &base, const std::vector<double> &point)
+        {
+            QUrlQuery query(base);
+            for (std::size_t i = 0; i < parameters.size(); ++i)
+            {
+                query.removeAllQueryItems(parameters[i].name);
+                query.addQueryItem(parameters[i].name, parameters[i].integer
+                                                           ? QString::number(static_cast<qint64>(point[i]))
+                                                           : QString::number(point[i], 'g', 17));
+            }
+            return query;
+        };
+
+        std::vector<double> lower;
+        for (auto &parameter : parameters)
+        {
+            if (!kContinuous.contains(parameter.name) && !kInteger.contains(parameter.name))
+            {
+                throw std::invalid_argument("Parameter cannot be ranged: " + parameter.name.toStdString());
+            }
+            parameter.integer = kInteger.contains(parameter.name);
+            lower.push_back(parameter.lower);
+        }
+
+        // Reject a bad scenario once, up front, rather than from every design point
+        auto probe = with_point(params, lower);
+        validateParameters(probe);
+        createPolicy(probe);
+
+        auto number = [&params](const QString &name, double fallback)
+        {
+            return params.hasQueryItem(name) ? params.queryItemValue(name).toDouble() : fallback;
+        };
+
+        SensitivityOptions options;
+        options.samples = qBound(2u, static_cast<unsigned>(number("samples", options.samples)), 65536u);
+        options.replications = qBound(1u, static_cast<unsigned>(number("replications", options.replications)), 1000u);
+        options.bootstrap = qMin(static_cast<unsigned>(number("bootstrap", options.bootstrap)), 10000u);
+        options.confidence_level = number("confidence_level", options.confidence_level);
+        options.base_seed = params.queryItemValue("seed").toUInt();
+
+        // Every design point is a KPI-only run; the row's seed keeps its demand stream common
+        QUrlQuery base(params);
+        for (const auto &name : {"seed", "log_level", "ranges", "samples", "replications", "bootstrap"})
+        {
+            base.removeAllQueryItems(name);
+        }
+        base.addQueryItem("summary_only", "1");
+        base.addQueryItem("distributions", "0");
+
+        auto evaluator = [base, with_point](const std::vector<double> &point, unsigned seed)
+        {
+            auto query = with_point(base, point);
+            query.addQueryItem("seed", QString::number(seed));
+
+            auto costs = parseCosts(query);
+            auto simulation = createSimulation(query);
+            auto policy = createPolicy(query);
+            simulation->initialize_simulation();
+            simulation->simulate(*policy);
+            auto kpis = simulation->get_kpis();
+            return std::vector<double>{kpis.service_level, kpis.average_inventory,
+                                       PolicyOptimizer::run_cost(kpis, costs)};
+        };
+
+        SensitivityAnalysis analysis(parameters, {"service_level", "average_inventory", "cost_per_day"}, evaluator,
+                                     options);
+        return analysis.analyze();
+    }
+
+    QJsonObject ChainSimServer::runComparison(const QUrlQuery &params)
+    {
+        QStringList names = params.hasQueryItem("policies")
+                                ? params.queryItemValue("policies").split(',', Qt::SkipEmptyParts)
+                                : QStringList{"ROP", "EOQ", "TPOP"};
+        if (names.isEmpty())
+        {
+            throw std::invalid_argument("No policies to compare");
+        }
+
+        // Each policy is created from the request with its own name, checked before anything runs
+        std::vector<PolicyComparison::PolicyFactory> policies;
+        for (auto &name : names)
+        {
+            name = name.trimmed();
+            QUrlQuery query(params);
+            query.removeAllQueryItems("policy");
+            query.addQueryItem("policy", name);
+            validateParameters(query);
+            createPolicy(query);
+            policies.push_back([query]()
+                               { return createPolicy(query); });
+        }
+
+        auto number = [&params](const QString &name, double fallback)
+        {
+            return params.hasQueryItem(name) ? params.queryItemValue(name).toDouble() : fallback;
+        };
+
+        ComparisonOptions options;
+        options.replications = qBound(2u, static_cast<unsigned>(number("replications", options.replications)), 10000u);
+        options.confidence_level = number("confidence_level", options.confidence_level);
+        options.base_seed = params.queryItemValue("seed").toUInt();
+        options.costs = parseCosts(params);
+        if (!(options.confidence_level > 0.0 && options.confidence_level < 1.0))
+        {
+            throw std::invalid_argument("confidence_level must be in (0, 1)");
+        }
+
+        // One engine per replication drives every policy
+        PolicyComparison comparison(replicationFactory(params, false), names, policies, options);
+        auto started = std::chrono::steady_clock::now();
+        auto result = comparison.compare();
+        m_logger.info(QString("Compared %1 over %2 replications (%3 ms)")
+                          .arg(names.join(", "))
+                          .arg(result.replications)
+                          .arg(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                   std::chrono::steady_clock::now() - started)
+                                   .count()));
+        return comparisonResultToJson(result);
+    }
+
+    void ChainSimServer::writeRecordsCsv(const ChainSim::simulation_records_t &records, const QString &path)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        {
+            m_logger.error(QString("Failed to open output file %1").arg(path));
+            return;
+        }
+        writeRecordsCsv(records, file);
+    }
+
+    void ChainSimServer::writeRecordsCsv(const ChainSim::simulation_records_t &records, QIODevice &device)
+    {
+        static const char *const kColumns[] = {
+            "inventory_quantity", "demand_quantity", "procurement_quantity",
+            "purchase_quantity", "sale_quantity", "lost_sale_quantity"};
+
+        // Resolve the columns once; const access keeps the records shared instead of detaching them
+        const qint64 *columns[std::size(kColumns)];
+        for (std::size_t c = 0; c < std::size(kColumns); ++c)
+        {
+            auto it = records.constFind(QLatin1String(kColumns[c]));
+            columns[c] = it == records.constEnd() ? nullptr : it.value().constData();
+        }
+        qsizetype rows = records.isEmpty() ? 0 : records.first().size();
+
+        // Format the whole file into the request arena and hand it to the OS in one write
+        auto arena = ArenaPool::acquire();
+        std::pmr::string out(arena->resource());
+        out.reserve(static_cast<std::size_t>(rows) * 48 + 128);
+        out.append("Day,inventory_quantity,demand_quantity,procurement_quantity,"
+                   "purchase_quantity,sale_quantity,lost_sale_quantity\n");
+
+        char buffer[24];
+        auto append_number = [&](qint64 number)
+        {
+            auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), number);
+            out.append(buffer, end - buffer);
+        };
+        for (qsizetype i = 0; i < rows; ++i)
+        {
+            append_number(i);
+            for (const qint64 *column : columns)
+            {
+                out.push_back(',');
+                append_number(column ? column[i] : 0);
             }
+            out.push_back('\n');
         }
 
-        // Convert results to JSON
-        return simulationRecordsToJson(simulation_records);
+        device.write(out.data(), static_cast<qint64>(out.size()));
     }
 
     QJsonObject ChainSimServer::simulationRecordsToJson(const ChainSim::simulation_records_t &records)
@@ -285,6 +1048,588 @@ namespace qz
         return result;
     }
 
+    QByteArray ChainSimServer::simulationRecordsToJsonBytes(const ChainSim::simulation_records_t &records)
+    {
+        auto arena = ArenaPool::acquire();
+        std::pmr::string body(arena->resource());
+        qsizetype rows = records.isEmpty() ? 0 : records.first().size();
+        body.reserve(static_cast<std::size_t>(rows * records.size()) * 8 + 256);
+
+        JsonWriter json(body);
+        json.begin_object();
+        for (auto it = records.begin(); it != records.end(); ++it)
+        {
+            QByteArray name = it.key().toUtf8();
+            json.key(std::string_view(name.constData(), static_cast<std::size_t>(name.size())));
+            json.integer_array(it.value().constData(), static_cast<std::size_t>(it.value().size()));
+        }
+        json.end_object();
+
+        // The only copy out of the arena is the response payload itself
+        return QByteArray(body.data(), static_cast<qsizetype>(body.size()));
+    }
+
+    QJsonObject ChainSimServer::kpisToJson(const SimulationKpis &kpis)
+    {
+        return QJsonObject{
+            {"days", static_cast<qint64>(kpis.days)},
+            {"service_level", kpis.service_level},
+            {"average_inventory", kpis.average_inventory},
+            {"inventory_stddev", kpis.inventory_stddev},
+            {"average_demand", kpis.average_demand},
+            {"demand_stddev", kpis.demand_stddev},
+            {"inventory_turns", kpis.inventory_turns},
+            {"peak_inventory", static_cast<qint64>(kpis.peak_inventory)},
+            {"min_inventory", static_cast<qint64>(kpis.min_inventory)},
+            {"total_demand", static_cast<qint64>(kpis.total_demand)},
+            {"total_sales", static_cast<qint64>(kpis.total_sales)},
+            {"total_lost_sales", static_cast<qint64>(kpis.total_lost_sales)},
+            {"total_purchases", static_cast<qint64>(kpis.total_purchases)},
+            {"order_count", static_cast<qint64>(kpis.order_count)},
+            {"stockout_days", static_cast<qint64>(kpis.stockout_days)}};
+    }
+
+    QJsonObject ChainSimServer::distributionsToJson(const KpiDistributions &distributions)
+    {
+        auto quantiles = [](const QuantileSketch &sketch)
+        {
+            return QJsonObject{
+                {"count", static_cast<qint64>(sketch.count())},
+                {"min", sketch.min()},
+                {"p5", sketch.quantile(0.05)},
+                {"p50", sketch.quantile(0.50)},
+                {"p95", sketch.quantile(0.95)},
+                {"p99", sketch.quantile(0.99)},
+                {"max", sketch.max()}};
+        };
+        // Non-empty bins only, as [lower, upper) with their day counts
+        auto histogram = [](const Histogram &histogram)
+        {
+            QJsonArray bins;
+            for (const auto &bin : histogram.bins())
+            {
+                bins.append(QJsonArray{static_cast<qint64>(bin.lower), static_cast<qint64>(bin.upper),
+                                       static_cast<qint64>(bin.count)});
+            }
+            return bins;
+        };
+
+        auto inventory = quantiles(distributions.inventory);
+        inventory["histogram"] = histogram(distributions.inventory_histogram);
+        auto lost_sales = quantiles(distributions.lost_sales);
+        lost_sales["histogram"] = histogram(distributions.lost_sales_histogram);
+
+        return QJsonObject{
+            {"inventory_quantity", inventory},
+            {"lost_sale_quantity", lost_sales},
+            {"cycle_service", quantiles(distributions.cycle_service)}};
+    }
+
+    QJsonObject ChainSimServer::optimizationResultToJson(const OptimizationResult &result)
+    {
+        auto interval = [](const ConfidenceInterval &ci)
+        {
+            return QJsonObject{{"mean", ci.mean}, {"lower", ci.lower()}, {"upper", ci.upper()}};
+        };
+        auto named = [&result](const std::vector<double> &values)
+        {
+            QJsonObject parameters;
+            for (qsizetype i = 0; i < result.names.size(); ++i)
+                parameters[result.names[i]] = values[static_cast<std::size_t>(i)];
+            return parameters;
+        };
+
+        return QJsonObject{
+            {"parameters", named(result.best)},
+            {"initial_parameters", named(result.initial)},
+            {"cost_per_day", interval(result.cost)},
+            {"initial_cost_per_day", interval(result.initial_cost)},
+            {"savings_per_day", interval(result.savings)},
+            {"service_level", interval(result.service_level)},
+            {"feasible", result.feasible},
+            {"iterations", static_cast<qint64>(result.iterations)},
+            {"evaluations", static_cast<qint64>(result.evaluations)},
+            {"replications", static_cast<qint64>(result.replications)}};
+    }
+
+    QJsonObject ChainSimServer::markovEvaluationToJson(const MarkovEvaluation &evaluation)
+    {
+        QJsonObject json{
+            {"method", evaluation.analytical ? "markov" : "simulation"},
+            {"states", static_cast<qint64>(evaluation.states)},
+            {"transitions", static_cast<qint64>(evaluation.transitions)},
+            {"kpis", kpisToJson(evaluation.kpis)}};
+        if (evaluation.analytical)
+        {
+            json["sweeps"] = static_cast<qint64>(evaluation.sweeps);
+            json["residual"] = evaluation.residual;
+        }
+        else
+        {
+            json["fallback_reason"] = evaluation.fallback_reason;
+        }
+        return json;
+    }
+
+    QJsonObject ChainSimServer::replicationResultToJson(const ReplicationResult &result)
+    {
+        QJsonObject kpis;
+        for (const auto &estimate : result.estimates)
+        {
+            QJsonObject json{
+                {"mean", estimate.interval.mean},
+                {"lower", estimate.interval.lower()},
+                {"upper", estimate.interval.upper()},
+                {"half_width", estimate.interval.half_width}};
+            // Infinite for a zero mean, which JSON cannot represent
+            if (std::isfinite(estimate.relative_half_width))
+            {
+                json["relative_half_width"] = estimate.relative_half_width;
+            }
+            if (estimate.targeted)
+            {
+                json["target_met"] = estimate.target_met;
+            }
+            kpis[estimate.kpi] = json;
+        }
+
+        return QJsonObject{
+            {"converged", result.converged},
+            {"replications", static_cast<qint64>(result.replications)},
+            {"batches", static_cast<qint64>(result.batches)},
+            {"kpis", kpis},
+            {"distributions", distributionsToJson(result.distributions)}};
+    }
+
+    QJsonObject ChainSimServer::rareEventEstimateToJson(const RareEventEstimate &estimate)
+    {
+        auto interval = [](const ConfidenceInterval &ci)
+        {
+            QJsonObject json{{"mean", ci.mean}, {"lower", ci.lower()}, {"upper", ci.upper()}};
+            if (ci.mean > 0.0)
+            {
+                json["relative_error"] = ci.half_width / ci.mean;
+            }
+            return json;
+        };
+
+        return QJsonObject{
+            {"tilt", estimate.tilt},
+            {"window", static_cast<qint64>(estimate.window)},
+            {"warmup_days", static_cast<qint64>(estimate.warmup_days)},
+            {"replications", static_cast<qint64>(estimate.replications)},
+            {"stockout_probability", interval(estimate.stockout_probability)},
+            {"stockout_day_probability", interval(estimate.stockout_day_probability)},
+            {"lost_sales_per_day", interval(estimate.lost_sales_per_day)},
+            {"effective_sample_size", estimate.effective_sample_size},
+            {"variance_reduction", estimate.variance_reduction}};
+    }
+
+    QJsonObject ChainSimServer::sensitivityResultToJson(const SensitivityResult &result)
+    {
+        auto index = [](const SensitivityIndex &index)
+        {
+            return QJsonObject{{"estimate", index.estimate}, {"lower", index.lower}, {"upper", index.upper}};
+        };
+
+        QJsonObject outputs;
+        for (const auto &output : result.outputs)
+        {
+            QJsonObject parameters;
+            for (const auto &parameter : output.parameters)
+            {
+                parameters[parameter.parameter] = QJsonObject{
+                    {"first_order", index(parameter.first_order)},
+                    {"total", index(parameter.total)}};
+            }
+            outputs[output.output] = QJsonObject{
+                {"mean", output.mean},
+                {"variance", output.variance},
+                {"parameters", parameters}};
+        }
+
+        return QJsonObject{
+            {"samples", static_cast<qint64>(result.samples)},
+            {"evaluations", static_cast<qint64>(result.evaluations)},
+            {"outputs", outputs}};
+    }
+
+    QJsonObject ChainSimServer::comparisonResultToJson(const ComparisonResult &result)
+    {
+        const auto &names = PolicyComparison::kpi_names();
+        auto interval = [](const ConfidenceInterval &ci)
+        {
+            return QJsonObject{{"mean", ci.mean}, {"lower", ci.lower()}, {"upper", ci.upper()}};
+        };
+
+        QJsonArray policies;
+        for (const auto &policy : result.policies)
+        {
+            QJsonObject kpis;
+            for (qsizetype k = 0; k < names.size(); ++k)
+            {
+                kpis[names[k]] = interval(policy.kpis[k]);
+            }
+            policies.append(QJsonObject{{"policy", policy.policy}, {"kpis", kpis}});
+        }
+
+        // A difference is significant when its interval excludes zero
+        QJsonArray differences;
+        for (const auto &difference : result.differences)
+        {
+            QJsonObject kpis;
+            for (qsizetype k = 0; k < names.size(); ++k)
+            {
+                auto json = interval(difference.kpis[k]);
+                json["correlation"] = difference.correlations[k];
+                json["significant"] = difference.kpis[k].lower() > 0.0 || difference.kpis[k].upper() < 0.0;
+                kpis[names[k]] = json;
+            }
+            differences.append(QJsonObject{
+                {"policy", difference.policy},
+                {"baseline", difference.baseline},
+                {"kpis", kpis}});
+        }
+
+        return QJsonObject{
+            {"replications", static_cast<qint64>(result.replications)},
+            {"policies", policies},
+            {"differences", differences}};
+    }
+
+    QJsonObject ChainSimServer::explainDecisions(const StoredResult &result, const QUrlQuery &params)
+    {
+        if (result.decisions.empty() || !result.policy)
+        {
+            throw std::invalid_argument("Result has no decision trace");
+        }
+        if (!params.hasQueryItem("days"))
+        {
+            throw std::invalid_argument("Missing required parameter: days");
+        }
+
+        QJsonArray decisions;
+        for (auto day : DecisionTrace::parse_days(params.queryItemValue("days")))
+        {
+            const auto *decision = result.decisions.find(day);
+            if (!decision)
+            {
+                continue; // Day 0 and days past the horizon have no decision
+            }
+            decisions.append(QJsonObject{
+                {"day", static_cast<qint64>(decision->day)},
+                {"on_hand", decision->on_hand},
+                {"pipeline", decision->pipeline},
+                {"position", decision->state().position()},
+                {"threshold", decision->threshold},
+                {"quantity", decision->quantity},
+                {"explanation", result.policy->explain(*decision)}});
+        }
+
+        return QJsonObject{
+            {"policy", result.policy->name()},
+            {"decisions", decisions}};
+    }
+
+    QJsonObject ChainSimServer::querySeries(const StoredResult &result, const QUrlQuery &params)
+    {
+        const auto &records = result.records;
+        qint64 length = records.isEmpty() ? 0 : records.first().size();
+
+        qint64 first_day = params.hasQueryItem("from") ? params.queryItemValue("from").toLongLong() : 0;
+        qint64 last_day = params.hasQueryItem("to") ? params.queryItemValue("to").toLongLong() : length - 1;
+        first_day = qMax<qint64>(0, first_day);
+        last_day = qMin(last_day, length - 1);
+        if (first_day > last_day)
+        {
+            throw std::invalid_argument("Empty day range");
+        }
+
+        QStringList columns = records.keys();
+        if (params.hasQueryItem("columns"))
+        {
+            columns = params.queryItemValue("columns").split(',', Qt::SkipEmptyParts);
+        }
+
+        auto count = static_cast<std::size_t>(last_day - first_day + 1);
+        std::size_t points = count;
+        if (params.hasQueryItem("points"))
+        {
+            // Fewer than 4 points leave no buckets for min/max downsampling to fill
+            bool ok = false;
+            auto requested = params.queryItemValue("points").toULongLong(&ok);
+            if (!ok || requested < 4)
+            {
+                throw std::invalid_argument("points must be an integer of at least 4");
+            }
+            points = std::min<std::size_t>(requested, count);
+        }
+
+        QJsonObject series;
+        for (const auto &column : columns)
+        {
+            auto it = records.constFind(column);
+            if (it == records.constEnd())
+            {
+                throw std::invalid_argument("Unknown column: " + column.toStdString());
+            }
+
+            const qint64 *values = it.value().constData() + first_day;
+
+            // Inventory keeps its extremes (stockouts, peaks); the rest keep their shape
+            auto indices = column == QStringLiteral("inventory_quantity")
+                               ? minmax_indices(values, count, points)
+                               : lttb_indices(values, count, points);
+
+            QJsonArray days, samples;
+            for (auto index : indices)
+            {
+                days.append(first_day + static_cast<qint64>(index));
+                samples.append(values[index]);
+            }
+            series[column] = QJsonObject{{"day", days}, {"value", samples}};
+        }
+
+        return QJsonObject{
+            {"id", result.id},
+            {"from", first_day},
+            {"to", last_day},
+            {"series", series}};
+    }
+
+    QJsonObject ChainSimServer::aggregateRecords(const ChainSim::simulation_records_t &records, const QUrlQuery &params)
+    {
+        qint64 length = records.isEmpty() ? 0 : records.first().size();
+        if (length == 0)
+        {
+            throw std::invalid_argument("The result has no per-day records");
+        }
+
+        qint64 first_day = params.hasQueryItem("from") ? params.queryItemValue("from").toLongLong() : 0;
+        qint64 last_day = params.hasQueryItem("to") ? params.queryItemValue("to").toLongLong() : length - 1;
+        first_day = qMax<qint64>(0, first_day);
+        last_day = qMin(last_day, length - 1);
+        if (first_day > last_day)
+        {
+            throw std::invalid_argument("Empty day range");
+        }
+        auto first = static_cast<std::size_t>(first_day);
+        auto last = static_cast<std::size_t>(last_day);
+
+        auto specs = parse_window_specs(params.hasQueryItem("aggregates")
+                                            ? params.queryItemValue("aggregates").toStdString()
+                                            : std::string(kDefaultWindowSpecs));
+
+        // Each column's prefix sums are built once and shared by every aggregate over it
+        // (std::map, so references stay valid while other columns are added)
+        std::map<QString, std::vector<std::int64_t>> prefixes;
+        auto prefix = [&](const QString &column) -> const std::vector<std::int64_t> &
+        {
+            auto cached = prefixes.find(column);
+            if (cached != prefixes.end())
+            {
+                return cached->second;
+            }
+            auto it = records.constFind(column);
+            if (it == records.constEnd())
+            {
+                throw std::invalid_argument("Unknown column: " + column.toStdString());
+            }
+            return prefixes.emplace(column, prefix_sums(it.value().constData(), static_cast<std::size_t>(length))).first->second;
+        };
+
+        auto daily = [first](const auto &values)
+        {
+            using Value = typename std::decay_t<decltype(values)>::value_type;
+            QJsonArray days, samples;
+            for (std::size_t i = 0; i < values.size(); ++i)
+            {
+                days.append(static_cast<qint64>(first + i));
+                if constexpr (std::is_integral_v<Value>)
+                    samples.append(static_cast<qint64>(values[i]));
+                else
+                    samples.append(values[i]);
+            }
+            return QJsonObject{{"day", days}, {"value", samples}};
+        };
+
+        QJsonObject aggregates;
+        for (const auto &spec : specs)
+        {
+            auto column = QString::fromStdString(spec.column);
+            QJsonObject series;
+            switch (spec.kind)
+            {
+            case WindowSpec::Kind::RollingSum:
+                series = daily(rolling_sums(prefix(column), spec.days, first, last));
+                break;
+            case WindowSpec::Kind::RollingMean:
+                series = daily(rolling_means(prefix(column), spec.days, first, last));
+                break;
+            case WindowSpec::Kind::FillRate:
+                series = daily(rolling_percent(prefix(QStringLiteral("sale_quantity")),
+                                               prefix(QStringLiteral("demand_quantity")), spec.days, first, last));
+                break;
+            case WindowSpec::Kind::Cumulative:
+                series = daily(cumulative_sums(prefix(column), first, last));
+                break;
+            case WindowSpec::Kind::PeriodSum:
+            {
+                // One point per period, on the period's first day
+                auto sums = period_sums(prefix(column), spec.days, first, last);
+                QJsonArray days, samples;
+                for (std::size_t k = 0; k < sums.size(); ++k)
+                {
+                    days.append(static_cast<qint64>(first + k * spec.days));
+                    samples.append(static_cast<qint64>(sums[k]));
+                }
+                series = QJsonObject{{"day", days}, {"value", samples}};
+                break;
+            }
+            }
+            aggregates[QString::fromStdString(spec.name)] = series;
+        }
+
+        return QJsonObject{
+            {"from", first_day},
+            {"to", last_day},
+            {"aggregates", aggregates}};
+    }
+
+    struct ChainSimServer::SimulationStream
+    {
+        explicit SimulationStream(QHttpServerResponder &&r) : responder(std::move(r)) {}
+
+        // Counted until the last event is written, with the status the stream ended on
+        ScopedRequest metrics{ServerMetrics::Route::Stream};
+        QHttpServerResponder responder;
+        std::unique_ptr<ChainSim> simulation;
+        std::shared_ptr<PurchasePolicy> policy; // Shared with the stored result, to explain its decisions
+        quint64 batch_days{1};
+        quint64 next_row{0};
+        bool finished{false};
+    };
+
+    void ChainSimServer::streamSimulation(const QUrlQuery &params, const QString &origin,
+                                          QHttpServerResponder &responder)
+    {
+        auto stream = std::make_shared<SimulationStream>(std::move(responder));
+        QHttpHeaders headers;
+        addCorsHeaders(headers, origin);
+
+        try
+        {
+            stream->simulation = createSimulation(params);
+            stream->policy = createPolicy(params);
+        }
+        catch (const std::exception &e)
+        {
+            m_logger.error(QString("Simulation stream failed: %1").arg(e.what()));
+            stream->metrics.set_status(400);
+            stream->responder.write(QJsonDocument(QJsonObject{{"error", e.what()}}), headers,
+                                    QHttpServerResponder::StatusCode::BadRequest);
+            return;
+        }
+
+        // Bound the number of events regardless of horizon: each event carries a batch of days
+        auto simulated_days = stream->simulation->get_simulation_length() - 1;
+        quint64 max_events = kDefaultStreamEvents;
+        if (params.hasQueryItem("max_events"))
+        {
+            max_events = qBound<quint64>(1, params.queryItemValue("max_events").toULongLong(), kMaxStreamEvents);
+        }
+        stream->batch_days = qMax<quint64>(1, (simulated_days + max_events - 1) / max_events);
+
+        auto *sim = stream->simulation.get();
+        auto *state = stream.get();
+        connect(sim, &ChainSim::simulationStarted, sim, [state]()
+                { state->responder.writeChunk("event: started\ndata: {}\n\n"); });
+        connect(sim, &ChainSim::simulationFinished, sim, [state]()
+                { state->finished = true; });
+
+        headers.append(QHttpHeaders::WellKnownHeader::ContentType, "text/event-stream");
+        headers.append(QHttpHeaders::WellKnownHeader::CacheControl, "no-cache");
+        headers.append("X-Accel-Buffering", "no");
+        stream->responder.writeBeginChunked(headers);
+
+        sim->initialize_simulation();
+        m_logger.info(QString("Streaming simulation of %1 days in batches of %2")
+                          .arg(simulated_days)
+                          .arg(stream->batch_days));
+
+        // Return to the event loop between batches so every event is flushed as soon as it is ready
+        QTimer::singleShot(0, this, [this, stream]()
+                           { pumpSimulationStream(stream); });
+    }
+
+    void ChainSimServer::pumpSimulationStream(const std::shared_ptr<SimulationStream> &stream)
+    {
+        // The client went away: stop here and free the engine instead of finishing (and retaining) the run
+        if (stream->responder.isResponseCanceled())
+        {
+            m_logger.info("Simulation stream closed by the client");
+            stream->simulation.reset();
+            return;
+        }
+
+        auto &sim = *stream->simulation;
+        auto simulation_length = sim.get_simulation_length();
+
+        try
+        {
+            if (sim.get_current_day() < simulation_length)
+            {
+                auto days = qMin(stream->batch_days, simulation_length - sim.get_current_day());
+                auto started = std::chrono::steady_clock::now();
+                sim.simulate_days(*stream->policy, days);
+                ServerMetrics::instance().record_simulated_days(days, std::chrono::steady_clock::now() - started);
+            }
+        }
+        catch (const std::exception &e)
+        {
+            m_logger.error(QString("Simulation stream failed: %1").arg(e.what()));
+            stream->metrics.set_status(500);
+            QJsonObject error{{"error", e.what()}};
+            stream->responder.writeEndChunked(
+                "event: error\ndata: " + QJsonDocument(error).toJson(QJsonDocument::Compact) + "\n\n");
+            return;
+        }
+
+        // Rows [next_row, current_day) are final; day 0 carries the starting inventory
+        auto last_row = sim.get_current_day() - 1;
+        auto simulated_days = simulation_length - 1;
+        double progress = simulated_days == 0 ? 100.0 : 100.0 * last_row / simulated_days;
+
+        QJsonObject batch{
+            {"from", static_cast<qint64>(stream->next_row)},
+            {"to", static_cast<qint64>(last_row)},
+            {"progress", progress}};
+        if (sim.is_recording_history())
+            batch["records"] = simulationRecordsToJson(sim.get_simulation_records(stream->next_row, last_row));
+        else
+            batch["kpis"] = kpisToJson(sim.get_kpis());
+        stream->next_row = last_row + 1;
+
+        QByteArray event = "event: progress\ndata: " + QJsonDocument(batch).toJson(QJsonDocument::Compact) + "\n\n";
+
+        if (stream->finished || sim.get_current_day() >= simulation_length)
+        {
+            m_logger.info("Simulation stream finished successfully");
+            QJsonObject done{{"days", static_cast<qint64>(simulation_length)},
+                             {"kpis", kpisToJson(sim.get_kpis())},
+                             {"distributions", distributionsToJson(sim.get_distributions())}};
+            if (sim.is_recording_history())
+                done["result_id"] = m_results->insert(sim.get_simulation_records(), sim.get_decisions(), stream->policy)->id;
+            stream->responder.writeEndChunked(
+                event + "event: done\ndata: " + QJsonDocument(done).toJson(QJsonDocument::Compact) + "\n\n");
+            return;
+        }
+
+        stream->responder.writeChunk(event);
+        QTimer::singleShot(0, this, [this, stream]()
+                           { pumpSimulationStream(stream); });
+    }
+
     std::unique_ptr<PurchasePolicy> ChainSimServer::createPolicy(const QUrlQuery &params)
     {
         QString policy_name = params.queryItemValue("policy");
@@ -382,34 +1727,94 @@ namespace qz
         }
     }
 
-    bool ChainSimServer::isAllowedOrigin(const QString &origin)
+    void ChainSimServer::profileProcess(const QUrlQuery &params, QHttpServerResponder &responder)
+    {
+        auto session = std::make_unique<ProfileSession>(std::move(responder));
+        auto fail = [&session](const QString &error, QHttpServerResponder::StatusCode status)
+        {
+            session->metrics.set_status(static_cast<int>(status));
+            session->responder.write(QJsonDocument(QJsonObject{{"error", error}}), status);
+        };
+        if (!profilingEnabled())
+        {
+            fail("Profiling is disabled; start the server with --profiler or ENABLE_PROFILER=1",
+                 QHttpServerResponder::StatusCode::Forbidden);
+            return;
+        }
+
+        bool seconds_ok = true, hz_ok = true;
+        double seconds = params.hasQueryItem("seconds") ? params.queryItemValue("seconds").toDouble(&seconds_ok) : 10.0;
+        unsigned hz = params.hasQueryItem("hz") ? params.queryItemValue("hz").toUInt(&hz_ok) : 99;
+        if (!seconds_ok || !hz_ok || !(seconds > 0.0 && seconds <= kMaxProfileSeconds))
+        {
+            fail(QString("seconds must be in (0, %1] and hz a positive integer").arg(kMaxProfileSeconds),
+                 QHttpServerResponder::StatusCode::BadRequest);
+            return;
+        }
+
+        // Enough slots for every core busy for the whole profile, within the profiler's cap
+        auto cores = static_cast<std::size_t>(qMax(1, QThread::idealThreadCount()));
+        auto expected = static_cast<std::size_t>(std::ceil(seconds * hz)) * cores;
+        try
+        {
+            SamplingProfiler::instance().start(hz, expected);
+        }
+        catch (const std::exception &e)
+        {
+            fail(e.what(), QHttpServerResponder::StatusCode::BadRequest);
+            return;
+        }
+        m_logger.info(QString("Profiling for %1 s at %2 Hz").arg(seconds).arg(hz));
+
+        // The worker keeps serving while samples are taken; the response goes out when the profile ends,
+        // or from the destructor if this server goes first
+        m_profile = std::move(session);
+        QTimer::singleShot(static_cast<int>(std::lround(seconds * 1000.0)), this, [this]()
+                           {
+                               auto finished = std::move(m_profile);
+                               auto profile = SamplingProfiler::instance().stop();
+                               m_logger.info(QString("Profile finished with %1 samples (%2 dropped)")
+                                                 .arg(profile.samples)
+                                                 .arg(profile.dropped));
+
+                               QHttpHeaders headers;
+                               headers.append(QHttpHeaders::WellKnownHeader::ContentType, "text/plain; charset=utf-8");
+                               headers.append("X-ChainSim-Profile-Samples", QByteArray::number(profile.samples));
+                               headers.append("X-ChainSim-Profile-Dropped", QByteArray::number(profile.dropped));
+                               finished->responder.write(QByteArray::fromStdString(profile.folded), headers,
+                                                         QHttpServerResponder::StatusCode::Ok); });
+    }
+
+    bool ChainSimServer::profilingEnabled() const
+    {
+        return m_profiling || qEnvironmentVariableIntValue("ENABLE_PROFILER") != 0;
+    }
+
+    QStringList ChainSimServer::allowedOrigins()
     {
         QByteArray allowedOriginsEnv = qgetenv("ALLOWED_ORIGINS");
         if (allowedOriginsEnv.isEmpty())
         {
             // Default allowed origins
-            static const QStringList defaultOrigins = {
+            return {
                 "*",
                 "http://localhost:3000",
                 "http://localhost:47761"};
-            bool allowed = defaultOrigins.contains(origin);
-            if (!allowed)
-            {
-                m_logger.error(QString("Origin '%1' not allowed. Allowed origins: %2")
-                                   .arg(origin)
-                                   .arg(defaultOrigins.join(", ")));
-            }
-            return allowed;
         }
 
         // Parse comma-separated origins from environment
-        QStringList allowedOrigins = QString::fromUtf8(allowedOriginsEnv).split(',');
-        bool allowed = allowedOrigins.contains(origin);
+        return QString::fromUtf8(allowedOriginsEnv).split(',');
+    }
+
+    bool ChainSimServer::isAllowedOrigin(const QString &origin)
+    {
+        QStringList origins = allowedOrigins();
+        bool allowed = origins.contains(origin);
         if (!allowed)
         {
             m_logger.error(QString("Origin '%1' not allowed. Allowed origins: %2")
                                .arg(origin)
-                               .arg(allowedOrigins.join(", ")));
+                               .arg(origins.join(", ")));
         }
         return allowed;
     }
@@ -7,9 +7,21 @@
 #include <QJsonObject>
 #include <QJsonDocument>
 #include <QJsonArray>
+#include <QIODevice>
+#include <functional>
 #include <memory>
 #include "ChainSim.h"
+#include "ChainSimBuilder.h"
+#include "ChainSimPool.h"
+#include "analysis/MarkovEvaluator.h"
+#include "analysis/PolicyComparison.h"
+#include "analysis/PolicyOptimizer.h"
+#include "analysis/RareEventEstimator.h"
+#include "analysis/ReplicationRunner.h"
+#include "analysis/SensitivityAnalysis.h"
 #include "utils/ChainLogger.hpp"
+#include "utils/Metrics.hpp"
+#include "utils/ResultStore.hpp"
 
 namespace qz
 {
@@ -20,20 +32,98 @@ namespace qz
 
     public:
         explicit ChainSimServer(QObject *parent = nullptr);
+        // Instances sharing a store can answer queries for each other's results
+        explicit ChainSimServer(std::shared_ptr<ResultStore> results, QObject *parent = nullptr);
+        // Stops a profile still recording; its request is answered with a 503
+        ~ChainSimServer() override;
         bool start(quint16 port = 47761);
+        bool startOnSocket(qintptr socketDescriptor);
+        [[nodiscard]] quint16 port() const { return m_port; }
+
+        // Request parsing shared with the other listeners (sessions, binary clients)
+        static std::unique_ptr<ChainSim> createSimulation(const QUrlQuery &params);
+        // The builder settings createSimulation uses, for callers that adjust them before create()
+        static void configureBuilder(ChainSimBuilder &builder, const QUrlQuery &params);
+        static std::unique_ptr<PurchasePolicy> createPolicy(const QUrlQuery &params);
+        static void validateParameters(const QUrlQuery &params);
+        // Summary-only engines of the request's scenario for replications, created from their seed;
+        // Without `distributions` they skip the KPI distributions; with it the request decides
+        static std::function<std::unique_ptr<ChainSim>(unsigned)> replicationFactory(const QUrlQuery &params,
+                                                                                   bool distributions);
+        // The rates behind the cost_per_day KPI: holding_cost, ordering_cost and stockout_cost
+        static OptimizerCosts parseCosts(const QUrlQuery &params);
+        static QStringList allowedOrigins();
+        // Lets /debug/profile run (--profiler); ENABLE_PROFILER=1 in the environment also enables it
+        void setProfilingEnabled(bool enabled) { m_profiling = enabled; }
+        [[nodiscard]] bool profilingEnabled() const;
+        static QJsonObject simulationRecordsToJson(const ChainSim::simulation_records_t &records);
+        // Same document as simulationRecordsToJson, encoded directly into an arena-backed buffer
+        static QByteArray simulationRecordsToJsonBytes(const ChainSim::simulation_records_t &records);
+        // The records as CSV, one row per day, in a single write to `device`
+        static void writeRecordsCsv(const ChainSim::simulation_records_t &records, QIODevice &device);
+        static QJsonObject kpisToJson(const SimulationKpis &kpis);
+        static QJsonObject distributionsToJson(const KpiDistributions &distributions);
+        static QJsonObject optimizationResultToJson(const OptimizationResult &result);
+        static QJsonObject markovEvaluationToJson(const MarkovEvaluation &evaluation);
+        static QJsonObject replicationResultToJson(const ReplicationResult &result);
+        static QJsonObject rareEventEstimateToJson(const RareEventEstimate &estimate);
+        static QJsonObject sensitivityResultToJson(const SensitivityResult &result);
+        static QJsonObject comparisonResultToJson(const ComparisonResult &result);
+        // Sobol indices of the scenario parameters in `ranges`, shared with the CLI
+        static SensitivityResult analyzeSensitivity(const QUrlQuery &params);
+        // Windowed aggregates (`aggregates`, over days `from`-`to`) of a run's records, shared with the CLI
+        static QJsonObject aggregateRecords(const ChainSim::simulation_records_t &records, const QUrlQuery &params);
 
     private:
+        struct SimulationStream;
+        // The /debug/profile request waiting for the recording to end
+        struct ProfileSession;
+        // A finished /simulate response, shared by identical requests that were in flight together
+        struct SimulationResult;
+
+        // Upper bound and default for the number of progress events per streamed simulation
+        static constexpr quint64 kMaxStreamEvents = 1000;
+        static constexpr quint64 kDefaultStreamEvents = 100;
+        // Longest /debug/profile recording
+        static constexpr double kMaxProfileSeconds = 60.0;
+
         QHttpServer m_server;
         std::unique_ptr<QTcpServer> m_tcpServer;
         ChainLogger m_logger;
+        std::shared_ptr<ResultStore> m_results;
+        quint16 m_port{0};
+        bool m_profiling{false};
+        std::unique_ptr<ProfileSession> m_profile;
 
         // Helper methods
-        QJsonObject runSimulation(const QUrlQuery &params);
-        QJsonObject simulationRecordsToJson(const ChainSim::simulation_records_t &records);
-        std::unique_ptr<PurchasePolicy> createPolicy(const QUrlQuery &params);
-        void validateParameters(const QUrlQuery &params);
+        void setupRoutes();
+        // Answers a JSON route: counts the request, turns exceptions into a 400 and adds CORS headers
+        QHttpServerResponse jsonRoute(ServerMetrics::Route route, const QHttpServerRequest &request,
+                                      const std::function<QHttpServerResponse(const QUrlQuery &)> &handle);
+        static QHttpServerResponse unknownResultResponse();
+        bool bindTcpServer();
+        ChainSimPool::Handle runSimulation(const QUrlQuery &params);
+        std::shared_ptr<const SimulationResult> computeSimulation(const QUrlQuery &params);
+        // Runs computeSimulation, unless an identical request is already running it
+        std::shared_ptr<const SimulationResult> coalescedSimulation(const QUrlQuery &params);
+        // Identifies a /simulate result by its parsed scenario and policy, whatever the request's spelling
+        static std::string coalescingKey(const QUrlQuery &params);
+        QJsonObject runOptimization(const QUrlQuery &params);
+        QJsonObject runEvaluation(const QUrlQuery &params);
+        QJsonObject runReplications(const QUrlQuery &params);
+        QJsonObject runStockoutRisk(const QUrlQuery &params);
+        QJsonObject runSensitivity(const QUrlQuery &params);
+        QJsonObject runComparison(const QUrlQuery &params);
+        void writeRecordsCsv(const ChainSim::simulation_records_t &records, const QString &path);
+        QJsonObject querySeries(const StoredResult &result, const QUrlQuery &params);
+        QJsonObject explainDecisions(const StoredResult &result, const QUrlQuery &params);
+        void profileProcess(const QUrlQuery &params, QHttpServerResponder &responder);
+        void streamSimulation(const QUrlQuery &params, const QString &origin, QHttpServerResponder &responder);
+        void pumpSimulationStream(const std::shared_ptr<SimulationStream> &stream);
         void printRequestDetails(const QUrlQuery &params);
         bool isAllowedOrigin(const QString &origin);
+        QString requestOrigin(const QHttpServerRequest &request) const;
+        void addCorsHeaders(QHttpHeaders &headers, const QString &origin);
     };
 
 } // namespace qz
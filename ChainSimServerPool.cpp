@@ -0,0 +1,145 @@
+#include "ChainSimServerPool.h"
+#include "utils/Trace.hpp"
+
+#ifdef Q_OS_UNIX
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace qz
+{
+
+    ChainSimServerPool::ChainSimServerPool(QObject *parent)
+        : QObject(parent), m_results(std::make_shared<ResultStore>()), m_logger(2)
+    {
+    }
+
+    ChainSimServerPool::~ChainSimServerPool()
+    {
+        stop();
+    }
+
+    bool ChainSimServerPool::start(quint16 port, int threads)
+    {
+        if (threads <= 0)
+        {
+            threads = qMax(1, QThread::idealThreadCount());
+        }
+
+#if !defined(Q_OS_UNIX) || !defined(SO_REUSEPORT)
+        if (threads > 1)
+        {
+            m_logger.warn("SO_REUSEPORT is not available on this platform, running a single server thread");
+            threads = 1;
+        }
+#endif
+
+        m_port = port;
+        for (int i = 0; i < threads; ++i)
+        {
+            qintptr descriptor = -1;
+            if (threads > 1)
+            {
+                // The first socket resolves an ephemeral port; the others join it
+                descriptor = openListeningSocket(m_port);
+                if (descriptor < 0)
+                {
+                    stop();
+                    return false;
+                }
+            }
+
+            Worker worker;
+            worker.thread = std::make_unique<QThread>();
+            worker.thread->setObjectName(QString("ChainSimServer-%1").arg(i));
+            worker.context = std::make_unique<QObject>();
+            worker.context->moveToThread(worker.thread.get());
+            worker.thread->start();
+
+            bool started = false;
+            QMetaObject::invokeMethod(
+                worker.context.get(), [&]()
+                {
+                    Tracer::instance().set_thread_name(worker.thread->objectName().toStdString());
+                    worker.server = new ChainSimServer(m_results);
+                    worker.server->setProfilingEnabled(m_profiling);
+                    started = descriptor < 0 ? worker.server->start(m_port)
+                                             : worker.server->startOnSocket(descriptor);
+                    m_port = worker.server->port(); },
+                Qt::BlockingQueuedConnection);
+
+            m_workers.push_back(std::move(worker));
+            if (!started)
+            {
+                stop();
+                return false;
+            }
+        }
+
+        m_logger.info(QString("Server pool running %1 worker thread(s) on port %2").arg(threads).arg(m_port));
+        return true;
+    }
+
+    void ChainSimServerPool::stop()
+    {
+        for (auto &worker : m_workers)
+        {
+            if (worker.server)
+            {
+                // Servers own QObjects living in the worker thread, so delete them there
+                QMetaObject::invokeMethod(
+                    worker.context.get(), [&worker]()
+                    {
+                        delete worker.server;
+                        worker.server = nullptr; },
+                    Qt::BlockingQueuedConnection);
+            }
+            worker.thread->quit();
+            worker.thread->wait();
+        }
+        m_workers.clear();
+    }
+
+    qintptr ChainSimServerPool::openListeningSocket(quint16 port)
+    {
+#if defined(Q_OS_UNIX) && defined(SO_REUSEPORT)
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0)
+        {
+            m_logger.error(QString("Failed to create socket: %1").arg(std::strerror(errno)));
+            return -1;
+        }
+
+        int enable = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+        if (::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) < 0)
+        {
+            m_logger.error(QString("Failed to set SO_REUSEPORT: %1").arg(std::strerror(errno)));
+            ::close(fd);
+            return -1;
+        }
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port = htons(port);
+        if (::bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 ||
+            ::listen(fd, SOMAXCONN) < 0)
+        {
+            m_logger.error(QString("Failed to listen on port %1: %2").arg(port).arg(std::strerror(errno)));
+            ::close(fd);
+            return -1;
+        }
+
+        return fd;
+#else
+        Q_UNUSED(port);
+        return -1;
+#endif
+    }
+
+} // namespace qz
@@ -0,0 +1,57 @@
+#ifndef CHAINSIM_SERVERPOOL_H
+#define CHAINSIM_SERVERPOOL_H
+
+#include <QObject>
+#include <QThread>
+#include <memory>
+#include <vector>
+#include "ChainSimServer.h"
+#include "utils/ChainLogger.hpp"
+#include "utils/ResultStore.hpp"
+
+namespace qz
+{
+
+    /* Runs one ChainSimServer per thread, each with its own event loop, all on the same port.
+     * Every worker gets its own listening socket bound with SO_REUSEPORT, so the kernel spreads
+     * incoming connections across workers and accept, HTTP parsing, simulation and JSON encoding
+     * scale with cores. Retained results are shared between workers.
+     * Without SO_REUSEPORT support the pool falls back to a single worker.
+     */
+    class ChainSimServerPool : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        explicit ChainSimServerPool(QObject *parent = nullptr);
+        ~ChainSimServerPool() override;
+
+        // threads == 0 uses one worker per core
+        bool start(quint16 port = 47761, int threads = 0);
+        void stop();
+        // Applies to the workers created by the next start()
+        void setProfilingEnabled(bool enabled) { m_profiling = enabled; }
+
+        [[nodiscard]] quint16 port() const { return m_port; }
+        [[nodiscard]] int workerCount() const { return static_cast<int>(m_workers.size()); }
+
+    private:
+        struct Worker
+        {
+            std::unique_ptr<QThread> thread;
+            std::unique_ptr<QObject> context; // Lives in `thread`, used to run code there
+            ChainSimServer *server{nullptr};
+        };
+
+        qintptr openListeningSocket(quint16 port);
+
+        std::vector<Worker> m_workers;
+        std::shared_ptr<ResultStore> m_results;
+        quint16 m_port{0};
+        bool m_profiling{false};
+        ChainLogger m_logger;
+    };
+
+} // namespace qz
+
+#endif // CHAINSIM_SERVERPOOL_H
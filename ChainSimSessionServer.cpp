@@ -0,0 +1,321 @@
+#include "ChainSimSessionServer.h"
+#include "ChainSimServer.h"
+#include <QJsonDocument>
+#include <QPointer>
+#include <QTimer>
+
+namespace qz
+{
+
+    ChainSimSessionServer::ChainSimSessionServer(QObject *parent)
+        : QObject(parent),
+          m_server(QStringLiteral("ChainSim Sessions"), QWebSocketServer::NonSecureMode),
+          m_logger(2)
+    {
+        connect(&m_server, &QWebSocketServer::newConnection, this, &ChainSimSessionServer::onNewConnection);
+    }
+
+    bool ChainSimSessionServer::start(quint16 port)
+    {
+        if (!m_server.listen(QHostAddress::AnyIPv4, port))
+        {
+            m_logger.error(QString("Failed to start session server on port %1: %2")
+                               .arg(port)
+                               .arg(m_server.errorString()));
+            return false;
+        }
+
+        m_logger.info(QString("Session server running on ws://127.0.0.1:%1/").arg(m_server.serverPort()));
+        return true;
+    }
+
+    void ChainSimSessionServer::onNewConnection()
+    {
+        while (QWebSocket *socket = m_server.nextPendingConnection())
+        {
+            // Browsers always send an Origin; reject pages that are not allowed to call the API
+            QString origin = socket->origin().isEmpty() ? QStringLiteral("*") : socket->origin();
+            if (!ChainSimServer::allowedOrigins().contains(origin))
+            {
+                m_logger.error(QString("Origin '%1' not allowed for sessions").arg(origin));
+                socket->close(QWebSocketProtocol::CloseCodePolicyViolated, QStringLiteral("Origin not allowed"));
+                socket->deleteLater();
+                continue;
+            }
+
+            m_sessions.insert(socket, std::make_shared<Session>());
+
+            connect(socket, &QWebSocket::textMessageReceived, this,
+                    [this, socket](const QString &message)
+                    { handleMessage(socket, message); });
+            connect(socket, &QWebSocket::disconnected, this,
+                    [this, socket]()
+                    {
+                        m_sessions.remove(socket);
+                        socket->deleteLater();
+                    });
+
+            m_logger.info(QString("Session opened from %1").arg(socket->peerAddress().toString()));
+        }
+    }
+
+    void ChainSimSessionServer::handleMessage(QWebSocket *socket, const QString &message)
+    {
+        auto session = m_sessions.value(socket);
+        if (!session)
+            return;
+
+        try
+        {
+            QJsonParseError parseError;
+            auto document = QJsonDocument::fromJson(message.toUtf8(), &parseError);
+            if (parseError.error != QJsonParseError::NoError || !document.isObject())
+            {
+                throw std::invalid_argument("Malformed command: expected a JSON object");
+            }
+
+            auto request = document.object();
+            QString command = request.value("command").toString();
+
+            if (command == "init")
+            {
+                initializeSession(*session, request.value("params").toObject(), socket);
+                return;
+            }
+
+            if (!session->simulation)
+            {
+                throw std::invalid_argument("Session not initialized, send an init command first");
+            }
+
+            if (command == "policy")
+            {
+                changePolicy(*session, request.value("params").toObject(), socket);
+            }
+            else if (command == "resimulate")
+            {
+                resimulate(*session, request, socket);
+            }
+            else if (command == "pause")
+            {
+                session->running = false;
+                session->remaining_days = 0;
+                send(socket, {{"type", "paused"},
+                              {"day", static_cast<qint64>(session->simulation->get_current_day())}});
+            }
+            else if (command == "step" || command == "run")
+            {
+                auto &sim = *session->simulation;
+                quint64 remaining = sim.get_simulation_length() - sim.get_current_day();
+                quint64 days = command == "step" ? 1 : remaining;
+                if (request.contains("days"))
+                {
+                    days = static_cast<quint64>(request.value("days").toInteger());
+                }
+                if (days == 0 || days > remaining)
+                {
+                    throw std::invalid_argument("Requested days exceed the remaining simulation length");
+                }
+
+                session->remaining_days = days;
+                if (!session->running)
+                {
+                    session->running = true;
+                    simulateBatch(socket);
+                }
+            }
+            else
+            {
+                throw std::invalid_argument("Unknown command: " + command.toStdString());
+            }
+        }
+        catch (const std::exception &e)
+        {
+            m_logger.error(QString("Session command failed: %1").arg(e.what()));
+            send(socket, {{"type", "error"}, {"error", e.what()}});
+        }
+    }
+
+    void ChainSimSessionServer::initializeSession(Session &session, const QJsonObject &params, QWebSocket *socket)
+    {
+        QUrlQuery query;
+        for (auto it = params.begin(); it != params.end(); ++it)
+        {
+            query.addQueryItem(it.key(), it.value().toVariant().toString());
+        }
+
+        // Build everything before replacing the current session state
+        auto simulation = createSessionSimulation(query);
+        auto policy = ChainSimServer::createPolicy(query);
+
+        session.running = false;
+        session.remaining_days = 0;
+        session.params = query;
+        session.simulation = std::move(simulation);
+        session.policy = std::move(policy);
+        session.simulation->initialize_simulation();
+
+        send(socket, {{"type", "initialized"},
+                      {"simulation_length", static_cast<qint64>(session.simulation->get_simulation_length())},
+                      {"policy", session.policy->name()}});
+        sendRows(socket, *session.simulation, 0, 0);
+    }
+
+    void ChainSimSessionServer::changePolicy(Session &session, const QJsonObject &params, QWebSocket *socket)
+    {
+        // Only the given keys change; lead time and demand default to the session's values
+        QUrlQuery query = session.params;
+        for (auto it = params.begin(); it != params.end(); ++it)
+        {
+            query.removeAllQueryItems(it.key());
+            query.addQueryItem(it.key(), it.value().toVariant().toString());
+        }
+
+        session.policy = ChainSimServer::createPolicy(query);
+        session.params = query;
+
+        send(socket, {{"type", "policy"},
+                      {"policy", session.policy->name()},
+                      {"day", static_cast<qint64>(session.simulation->get_current_day())}});
+    }
+
+    void ChainSimSessionServer::resimulate(Session &session, const QJsonObject &request, QWebSocket *socket)
+    {
+        // Parameters that only change the purchase decisions, not the demand path or the horizon
+        static const QStringList kPolicyParameters = {"policy", "ordering_cost", "holding_cost", "purchase_period"};
+
+        auto params = request.value("params").toObject();
+        QUrlQuery query = session.params;
+        bool policy_only = true;
+        for (auto it = params.begin(); it != params.end(); ++it)
+        {
+            auto value = it.value().toVariant().toString();
+            if (!kPolicyParameters.contains(it.key()) &&
+                (!query.hasQueryItem(it.key()) || query.queryItemValue(it.key()) != value))
+            {
+                policy_only = false;
+            }
+            query.removeAllQueryItems(it.key());
+            query.addQueryItem(it.key(), value);
+        }
+
+        ChainSimServer::validateParameters(query);
+
+        auto &current = *session.simulation;
+        auto end_day = current.get_current_day();
+        quint64 from_day = 1;
+        if (request.contains("from_day"))
+        {
+            if (!policy_only)
+            {
+                throw std::invalid_argument("Only policy parameters can change from a given day");
+            }
+            from_day = static_cast<quint64>(request.value("from_day").toInteger());
+            if (from_day == 0 || from_day > end_day)
+            {
+                throw std::invalid_argument("from_day must be between 1 and the current day");
+            }
+        }
+
+        auto policy = ChainSimServer::createPolicy(query);
+        quint64 first_day = 0;
+        if (policy_only)
+        {
+            // Days before the first differing decision are identical, so they are reused as they are
+            first_day = current.first_affected_day(*policy, from_day);
+            current.resimulate_from(*policy, first_day);
+        }
+        else
+        {
+            // A new demand path or horizon: rebuild and catch up to the same day
+            auto simulation = createSessionSimulation(query);
+            simulation->initialize_simulation();
+            simulation->simulate_days(*policy, qMin(end_day, simulation->get_simulation_length()) - 1);
+            session.running = false;
+            session.remaining_days = 0;
+            session.simulation = std::move(simulation);
+        }
+        session.policy = std::move(policy);
+        session.params = query;
+
+        const auto &sim = *session.simulation;
+        send(socket, {{"type", "resimulated"},
+                      {"policy", session.policy->name()},
+                      {"from", static_cast<qint64>(first_day)},
+                      {"day", static_cast<qint64>(sim.get_current_day())},
+                      {"rebuilt", !policy_only},
+                      {"kpis", ChainSimServer::kpisToJson(sim.get_kpis())}});
+        if (first_day < sim.get_current_day())
+        {
+            sendRows(socket, sim, first_day, sim.get_current_day() - 1);
+        }
+    }
+
+    std::unique_ptr<ChainSim> ChainSimSessionServer::createSessionSimulation(const QUrlQuery &query)
+    {
+        // Sessions never explain decisions, and keep checkpoints so they can be re-simulated
+        ChainSimBuilder builder;
+        ChainSimServer::configureBuilder(builder, query);
+        builder.setTraceDecisions(false).setResumable(true);
+        return builder.create();
+    }
+
+    void ChainSimSessionServer::simulateBatch(QWebSocket *socket)
+    {
+        auto session = m_sessions.value(socket);
+        if (!session || !session->running)
+            return;
+
+        auto &sim = *session->simulation;
+        auto first_day = sim.get_current_day();
+        auto days = qMin(session->remaining_days, kRunBatchDays);
+
+        try
+        {
+            sim.simulate_days(*session->policy, days);
+        }
+        catch (const std::exception &e)
+        {
+            session->running = false;
+            session->remaining_days = 0;
+            send(socket, {{"type", "error"}, {"error", e.what()}});
+            return;
+        }
+
+        session->remaining_days -= days;
+        sendRows(socket, sim, first_day, sim.get_current_day() - 1);
+
+        if (session->remaining_days == 0)
+        {
+            session->running = false;
+            bool finished = sim.get_current_day() >= sim.get_simulation_length();
+            send(socket, {{"type", finished ? "finished" : "paused"},
+                          {"day", static_cast<qint64>(sim.get_current_day())}});
+            return;
+        }
+
+        // Yield to the event loop so pause/policy commands are handled between batches
+        QPointer<QWebSocket> guard(socket);
+        QTimer::singleShot(0, this, [this, guard]()
+                           {
+                               if (guard)
+                                   simulateBatch(guard);
+                           });
+    }
+
+    void ChainSimSessionServer::sendRows(QWebSocket *socket, const ChainSim &simulation,
+                                         quint64 first_day, quint64 last_day)
+    {
+        send(socket, {{"type", "rows"},
+                      {"from", static_cast<qint64>(first_day)},
+                      {"to", static_cast<qint64>(last_day)},
+                      {"records", ChainSimServer::simulationRecordsToJson(
+                                      simulation.get_simulation_records(first_day, last_day))}});
+    }
+
+    void ChainSimSessionServer::send(QWebSocket *socket, const QJsonObject &message)
+    {
+        socket->sendTextMessage(QString::fromUtf8(QJsonDocument(message).toJson(QJsonDocument::Compact)));
+    }
+
+} // namespace qz
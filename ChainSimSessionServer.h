@@ -0,0 +1,69 @@
+#ifndef CHAINSIM_SESSIONSERVER_H
+#define CHAINSIM_SESSIONSERVER_H
+
+#include <QObject>
+#include <QHash>
+#include <QJsonObject>
+#include <QUrlQuery>
+#include <QWebSocketServer>
+#include <QWebSocket>
+#include <memory>
+#include "ChainSim.h"
+#include "utils/ChainLogger.hpp"
+
+namespace qz
+{
+
+    /* Interactive simulation sessions over WebSocket.
+     * Each connection keeps one ChainSim resident and steers it with JSON commands:
+     *   {"command": "init",   "params": {...same keys as /simulate...}}
+     *   {"command": "step"}                 simulate one day
+     *   {"command": "run", "days": N}       simulate N days (all remaining if omitted), in batches
+     *   {"command": "pause"}                stop a running "run"
+     *   {"command": "policy", "params": {...}}  swap the purchase policy from the next day on
+     *   {"command": "resimulate", "params": {...}, "from_day": k}
+     *                                       re-run the days simulated so far with changed parameters
+     * Only the rows produced by each command are sent back. A resimulate that only changes policy
+     * parameters (from day k, or for the whole run) rewinds to the first day the new policy orders
+     * differently and replays the recorded demand from there, so the unchanged prefix is neither
+     * re-sampled nor re-sent; other changes rebuild the run up to the same day.
+     */
+    class ChainSimSessionServer : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        explicit ChainSimSessionServer(QObject *parent = nullptr);
+        bool start(quint16 port = 47762);
+
+    private:
+        struct Session
+        {
+            std::unique_ptr<ChainSim> simulation;
+            std::unique_ptr<PurchasePolicy> policy;
+            QUrlQuery params;
+            quint64 remaining_days{0};
+            bool running{false};
+        };
+
+        // Days simulated per message while a "run" command is in progress
+        static constexpr quint64 kRunBatchDays = 32;
+
+        QWebSocketServer m_server;
+        QHash<QWebSocket *, std::shared_ptr<Session>> m_sessions;
+        ChainLogger m_logger;
+
+        void onNewConnection();
+        void handleMessage(QWebSocket *socket, const QString &message);
+        void initializeSession(Session &session, const QJsonObject &params, QWebSocket *socket);
+        void changePolicy(Session &session, const QJsonObject &params, QWebSocket *socket);
+        void resimulate(Session &session, const QJsonObject &request, QWebSocket *socket);
+        static std::unique_ptr<ChainSim> createSessionSimulation(const QUrlQuery &query);
+        void simulateBatch(QWebSocket *socket);
+        void sendRows(QWebSocket *socket, const ChainSim &simulation, quint64 first_day, quint64 last_day);
+        void send(QWebSocket *socket, const QJsonObject &message);
+    };
+
+} // namespace qz
+
+#endif // CHAINSIM_SESSIONSERVER_H
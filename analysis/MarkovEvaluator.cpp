@@ -0,0 +1,393 @@
+#include "MarkovEvaluator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include "purchase_policies/PurchaseTPOP.h"
+
+namespace qz
+{
+
+    // Demand pmf with the partial sums needed for closed-form lost sales, extended on demand
+    class MarkovEvaluator::DemandModel
+    {
+    public:
+        static DemandModel fixed(qint64 value)
+        {
+            DemandModel model;
+            model.m_mean = static_cast<double>(value);
+            model.m_variance = 0.0;
+            model.m_fixed = value;
+            return model;
+        }
+
+        static DemandModel poisson(double mean)
+        {
+            DemandModel model;
+            model.m_mean = mean;
+            model.m_variance = mean;
+            return model;
+        }
+
+        [[nodiscard]] double mean() const { return m_mean; }
+        [[nodiscard]] double variance() const { return m_variance; }
+
+        [[nodiscard]] double pmf(qint64 d) const
+        {
+            extend(d);
+            return m_pmf[static_cast<std::size_t>(d)];
+        }
+
+        // P(D >= a)
+        [[nodiscard]] double tail(qint64 a) const
+        {
+            if (a <= 0)
+                return 1.0;
+            extend(a - 1);
+            return std::max(0.0, 1.0 - m_cdf[static_cast<std::size_t>(a - 1)]);
+        }
+
+        // E[(D - a)+], the lost sales when `a` units are available
+        [[nodiscard]] double expected_excess(qint64 a) const
+        {
+            if (a <= 0)
+                return m_mean - static_cast<double>(a);
+            extend(a - 1);
+            double served = m_partial_mean[static_cast<std::size_t>(a - 1)] + static_cast<double>(a) * tail(a);
+            return std::max(0.0, m_mean - served);
+        }
+
+    private:
+        DemandModel() = default;
+
+        void extend(qint64 d) const
+        {
+            while (static_cast<qint64>(m_pmf.size()) <= d)
+            {
+                auto k = static_cast<qint64>(m_pmf.size());
+                double p;
+                if (m_fixed >= 0)
+                    p = k == m_fixed ? 1.0 : 0.0;
+                else
+                    p = m_mean > 0 ? std::exp(-m_mean + static_cast<double>(k) * std::log(m_mean) - std::lgamma(static_cast<double>(k) + 1.0))
+                                   : (k == 0 ? 1.0 : 0.0);
+
+                double cdf = m_cdf.empty() ? 0.0 : m_cdf.back();
+                double partial = m_partial_mean.empty() ? 0.0 : m_partial_mean.back();
+                m_pmf.push_back(p);
+                m_cdf.push_back(cdf + p);
+                m_partial_mean.push_back(partial + static_cast<double>(k) * p);
+            }
+        }
+
+        double m_mean{0.0};
+        double m_variance{0.0};
+        qint64 m_fixed{-1};
+        mutable std::vector<double> m_pmf;
+        mutable std::vector<double> m_cdf;
+        mutable std::vector<double> m_partial_mean; // sum of k * P(D = k) for k <= d
+    };
+
+    struct MarkovEvaluator::Chain
+    {
+        std::size_t width{0};               // Phase, on-hand, then orders due in 1..lead time days
+        std::vector<qint64> states;         // Flattened, `width` values per state
+        std::vector<std::size_t> row_start; // CSR rows of outgoing transitions
+        std::vector<std::uint32_t> column;
+        std::vector<double> probability;
+        std::vector<double> expected_lost; // Next day's expected lost sales from each state
+        std::vector<double> stockout;      // Next day's probability of losing sales from each state
+
+        [[nodiscard]] std::size_t size() const { return width == 0 ? 0 : states.size() / width; }
+        [[nodiscard]] const qint64 *state(std::size_t i) const { return states.data() + i * width; }
+    };
+
+    namespace
+    {
+        struct StateHash
+        {
+            std::size_t operator()(const std::vector<qint64> &state) const
+            {
+                std::size_t hash = 1469598103934665603ull;
+                for (auto value : state)
+                    hash = (hash ^ static_cast<std::size_t>(value)) * 1099511628211ull;
+                return hash;
+            }
+        };
+    } // namespace
+
+    MarkovEvaluator::MarkovEvaluator(const QString &distribution, double average_demand, quint32 lead_time,
+                                     quint64 starting_inventory, quint64 horizon, Options options)
+        : m_distribution(distribution), m_average_demand(average_demand), m_lead_time(lead_time),
+          m_starting_inventory(starting_inventory), m_horizon(horizon), m_options(options)
+    {
+        if (lead_time == 0)
+        {
+            throw std::invalid_argument("Lead time must be greater than zero");
+        }
+    }
+
+    MarkovEvaluation MarkovEvaluator::evaluate(const PurchasePolicy &policy, const SimulationFactory &fallback) const
+    {
+        MarkovEvaluation evaluation;
+        auto simulate_instead = [&](const QString &reason)
+        {
+            evaluation.analytical = false;
+            evaluation.fallback_reason = reason;
+            auto simulation = fallback();
+            simulation->initialize_simulation();
+            simulation->simulate(policy);
+            evaluation.kpis = simulation->get_kpis();
+            return evaluation;
+        };
+
+        std::unique_ptr<DemandModel> demand;
+        if (m_distribution == "poisson")
+            demand = std::make_unique<DemandModel>(DemandModel::poisson(m_average_demand));
+        else if (m_distribution == "fixed")
+            demand = std::make_unique<DemandModel>(DemandModel::fixed(static_cast<qint64>(m_average_demand)));
+        else
+            return simulate_instead(QString("Demand distribution '%1' is not discrete").arg(m_distribution));
+
+        Chain chain;
+        QString reason = build(policy, *demand, chain);
+        evaluation.states = chain.size();
+        evaluation.transitions = chain.column.size();
+        if (!reason.isEmpty())
+            return simulate_instead(reason);
+
+        std::vector<double> pi;
+        if (!solve(chain, pi, evaluation))
+            return simulate_instead(QString("Stationary distribution did not converge (residual %1)").arg(evaluation.residual));
+
+        evaluation.analytical = true;
+        evaluation.kpis = kpis(chain, *demand, pi);
+        return evaluation;
+    }
+
+    QString MarkovEvaluator::build(const PurchasePolicy &policy, const DemandModel &demand, Chain &chain) const
+    {
+        // Periodic review decisions depend on the day, so its phase becomes part of the state
+        qint64 period = 1;
+        if (auto *tpop = qobject_cast<const PurchaseTPOP *>(&policy))
+            period = tpop->parameters().review_period;
+
+        const std::size_t width = 2 + m_lead_time;
+        chain.width = width;
+
+        std::unordered_map<std::vector<qint64>, std::uint32_t, StateHash> index;
+        auto intern = [&](const std::vector<qint64> &state) -> qint64
+        {
+            auto [it, inserted] = index.try_emplace(state, static_cast<std::uint32_t>(chain.size()));
+            if (inserted)
+            {
+                if (index.size() > m_options.max_states)
+                    return -1;
+                chain.states.insert(chain.states.end(), state.begin(), state.end());
+            }
+            return it->second;
+        };
+
+        // Day 0 ends with the starting inventory and nothing on order
+        std::vector<qint64> start(width, 0);
+        start[1] = static_cast<qint64>(m_starting_inventory);
+        intern(start);
+        chain.row_start.push_back(0);
+
+        std::vector<qint64> current(width), next(width);
+        for (std::size_t i = 0; i < chain.size(); ++i)
+        {
+            std::copy(chain.state(i), chain.state(i) + width, current.begin());
+
+            // Tomorrow: the order due in one day arrives and the rest move one day closer
+            next[0] = (current[0] + 1) % period;
+            qint64 available = current[1] + current[2];
+            qint64 pipeline = 0;
+            for (std::size_t slot = 2; slot + 1 < width; ++slot)
+            {
+                next[slot] = current[slot + 1];
+                pipeline += next[slot];
+            }
+
+            auto transition = [&](qint64 on_hand, double probability)
+            {
+                next[1] = on_hand;
+                InventoryPosition position{static_cast<quint64>(next[0]), on_hand, pipeline};
+                next[width - 1] = qMax<qint64>(0, policy.get_purchase(position));
+                auto j = intern(next);
+                if (j < 0)
+                    return false;
+                chain.column.push_back(static_cast<std::uint32_t>(j));
+                chain.probability.push_back(probability);
+                return true;
+            };
+
+            for (qint64 d = 0; d < available; ++d)
+            {
+                double p = demand.pmf(d);
+                if (p > 0.0 && !transition(available - d, p))
+                    return QString("State space exceeds %1 states").arg(m_options.max_states);
+            }
+            double sold_out = demand.tail(available);
+            if (sold_out > 0.0 && !transition(0, sold_out))
+                return QString("State space exceeds %1 states").arg(m_options.max_states);
+
+            chain.expected_lost.push_back(demand.expected_excess(available));
+            chain.stockout.push_back(demand.tail(available + 1));
+            chain.row_start.push_back(chain.column.size());
+
+            if (chain.column.size() > m_options.max_transitions)
+                return QString("Transition matrix exceeds %1 entries").arg(m_options.max_transitions);
+        }
+
+        return {};
+    }
+
+    bool MarkovEvaluator::solve(const Chain &chain, std::vector<double> &pi, MarkovEvaluation &evaluation) const
+    {
+        const std::size_t n = chain.size();
+
+        // Transpose to incoming transitions, so each sweep updates pi in place column by column
+        std::vector<std::size_t> in_start(n + 1, 0);
+        for (auto j : chain.column)
+            ++in_start[j + 1];
+        for (std::size_t j = 0; j < n; ++j)
+            in_start[j + 1] += in_start[j];
+
+        std::vector<std::uint32_t> in_row(chain.column.size());
+        std::vector<double> in_probability(chain.column.size());
+        std::vector<double> self_loop(n, 0.0);
+        {
+            auto fill = in_start;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                for (auto k = chain.row_start[i]; k < chain.row_start[i + 1]; ++k)
+                {
+                    auto j = chain.column[k];
+                    if (j == i)
+                    {
+                        self_loop[j] += chain.probability[k];
+                        continue;
+                    }
+                    in_row[fill[j]] = static_cast<std::uint32_t>(i);
+                    in_probability[fill[j]++] = chain.probability[k];
+                }
+            }
+        }
+
+        auto residual = [&](const std::vector<double> &x)
+        {
+            std::vector<double> next(n, 0.0);
+            for (std::size_t i = 0; i < n; ++i)
+                for (auto k = chain.row_start[i]; k < chain.row_start[i + 1]; ++k)
+                    next[chain.column[k]] += x[i] * chain.probability[k];
+            double total = 0.0;
+            for (std::size_t i = 0; i < n; ++i)
+                total += std::abs(next[i] - x[i]);
+            return std::make_pair(total, std::move(next));
+        };
+
+        auto normalize = [](std::vector<double> &x)
+        {
+            double total = 0.0;
+            for (double value : x)
+                total += value;
+            if (total > 0.0)
+                for (double &value : x)
+                    value /= total;
+        };
+
+        pi.assign(n, 1.0 / static_cast<double>(n));
+        unsigned sweep = 0;
+        for (; sweep < m_options.max_sweeps; ++sweep)
+        {
+            double change = 0.0;
+            for (std::size_t j = 0; j < n; ++j)
+            {
+                double incoming = 0.0;
+                for (auto k = in_start[j]; k < in_start[j + 1]; ++k)
+                    incoming += pi[in_row[k]] * in_probability[k];
+                double value = self_loop[j] < 1.0 ? incoming / (1.0 - self_loop[j]) : pi[j];
+                change += std::abs(value - pi[j]);
+                pi[j] = value;
+            }
+            normalize(pi);
+            if (change < m_options.tolerance)
+                break;
+        }
+
+        evaluation.sweeps = sweep;
+        evaluation.residual = residual(pi).first;
+        constexpr double kAcceptedResidual = 1e-8;
+        if (evaluation.residual <= kAcceptedResidual)
+            return true;
+
+        // Gauss-Seidel can stall on some periodic chains; the lazy chain (I + P) / 2 is aperiodic
+        for (unsigned step = 0; step < m_options.max_sweeps; ++step)
+        {
+            auto [error, next] = residual(pi);
+            evaluation.residual = error;
+            if (error <= kAcceptedResidual)
+                return true;
+            for (std::size_t i = 0; i < n; ++i)
+                pi[i] = 0.5 * (pi[i] + next[i]);
+            normalize(pi);
+            evaluation.sweeps++;
+        }
+        return false;
+    }
+
+    SimulationKpis MarkovEvaluator::kpis(const Chain &chain, const DemandModel &demand, const std::vector<double> &pi) const
+    {
+        constexpr double kNegligible = 1e-12;
+        double inventory = 0.0, inventory_squared = 0.0, order_rate = 0.0, purchase_rate = 0.0;
+        double lost = 0.0, stockout = 0.0;
+        qint64 peak = 0, lowest = std::numeric_limits<qint64>::max();
+
+        for (std::size_t i = 0; i < chain.size(); ++i)
+        {
+            double p = pi[i];
+            const qint64 *state = chain.state(i);
+            auto on_hand = static_cast<double>(state[1]);
+            auto ordered = state[chain.width - 1];
+
+            inventory += p * on_hand;
+            inventory_squared += p * on_hand * on_hand;
+            if (ordered > 0)
+            {
+                order_rate += p;
+                purchase_rate += p * static_cast<double>(ordered);
+            }
+            lost += p * chain.expected_lost[i];
+            stockout += p * chain.stockout[i];
+            if (p > kNegligible)
+            {
+                peak = std::max(peak, state[1]);
+                lowest = std::min(lowest, state[1]);
+            }
+        }
+
+        double days = static_cast<double>(m_horizon);
+        double sales = std::max(0.0, demand.mean() - lost);
+
+        SimulationKpis kpis;
+        kpis.days = m_horizon;
+        kpis.total_demand = std::llround(demand.mean() * days);
+        kpis.total_sales = std::llround(sales * days);
+        kpis.total_lost_sales = std::llround(lost * days);
+        kpis.total_purchases = std::llround(purchase_rate * days);
+        kpis.order_count = static_cast<std::uint64_t>(std::llround(order_rate * days));
+        kpis.stockout_days = static_cast<std::uint64_t>(std::llround(stockout * days));
+        kpis.service_level = demand.mean() > 0 ? 100.0 * sales / demand.mean() : 100.0;
+        kpis.average_inventory = inventory;
+        kpis.inventory_stddev = std::sqrt(std::max(0.0, inventory_squared - inventory * inventory));
+        kpis.average_demand = demand.mean();
+        kpis.demand_stddev = std::sqrt(demand.variance());
+        kpis.inventory_turns = inventory > 0 ? sales * days / inventory : 0.0;
+        kpis.peak_inventory = peak;
+        kpis.min_inventory = lowest == std::numeric_limits<qint64>::max() ? 0 : lowest;
+        return kpis;
+    }
+
+} // namespace qz
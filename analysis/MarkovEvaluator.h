@@ -0,0 +1,76 @@
+#ifndef CHAINSIM_MARKOVEVALUATOR_H
+#define CHAINSIM_MARKOVEVALUATOR_H
+
+#include <QString>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "ChainSim.h"
+
+namespace qz
+{
+
+    struct MarkovEvaluation
+    {
+        bool analytical{false};
+        QString fallback_reason; // Why the simulation was used instead, empty when analytical
+        SimulationKpis kpis;     // Steady-state rates scaled to the horizon
+        std::size_t states{0};
+        std::size_t transitions{0};
+        unsigned sweeps{0};
+        double residual{0.0}; // ||pi P - pi||_1 of the returned distribution
+    };
+
+    /* Exact steady-state KPIs for discrete (Poisson or fixed) demand and a fixed lead time.
+     *
+     * The state at the end of a day is (review phase, on-hand, orders due in 1..lead time days),
+     * which makes the process ChainSim simulates a finite Markov chain. States reachable from
+     * the starting inventory are enumerated breadth-first, asking the policy itself for each
+     * decision, so any policy whose decisions depend only on that state is supported (ROP, EOQ,
+     * TPOP). The stationary distribution is solved with Gauss-Seidel sweeps over the sparse
+     * transposed transition matrix, with lazy power iteration as a backup.
+     *
+     * Continuous demand, a state space over the configured limits, or a solver that does not
+     * converge fall back to simulating the configured horizon, and the reason is reported.
+     */
+    class MarkovEvaluator
+    {
+    public:
+        struct Options
+        {
+            std::size_t max_states{250000};
+            std::size_t max_transitions{5000000};
+            double tolerance{1e-10};
+            unsigned max_sweeps{20000};
+        };
+
+        using SimulationFactory = std::function<std::unique_ptr<ChainSim>()>;
+
+        MarkovEvaluator(const QString &distribution, double average_demand, quint32 lead_time,
+                        quint64 starting_inventory, quint64 horizon, Options options);
+        MarkovEvaluator(const QString &distribution, double average_demand, quint32 lead_time,
+                        quint64 starting_inventory, quint64 horizon)
+            : MarkovEvaluator(distribution, average_demand, lead_time, starting_inventory, horizon, Options{}) {}
+
+        // `fallback` builds the simulation used when the chain cannot be solved
+        MarkovEvaluation evaluate(const PurchasePolicy &policy, const SimulationFactory &fallback) const;
+
+    private:
+        class DemandModel;
+        struct Chain;
+
+        QString build(const PurchasePolicy &policy, const DemandModel &demand, Chain &chain) const;
+        bool solve(const Chain &chain, std::vector<double> &pi, MarkovEvaluation &evaluation) const;
+        SimulationKpis kpis(const Chain &chain, const DemandModel &demand, const std::vector<double> &pi) const;
+
+        QString m_distribution;
+        double m_average_demand;
+        quint32 m_lead_time;
+        quint64 m_starting_inventory;
+        quint64 m_horizon;
+        Options m_options;
+    };
+
+} // namespace qz
+
+#endif // CHAINSIM_MARKOVEVALUATOR_H
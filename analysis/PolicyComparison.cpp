@@ -0,0 +1,109 @@
+#include "PolicyComparison.h"
+#include <cmath>
+#include <stdexcept>
+#include "ReplicationRunner.h"
+#include "utils/Parallel.hpp"
+
+namespace qz
+{
+
+    PolicyComparison::PolicyComparison(SimulationFactory simulations, QStringList names,
+                                       std::vector<PolicyFactory> policies, ComparisonOptions options)
+        : m_simulations(std::move(simulations)), m_names(std::move(names)), m_policies(std::move(policies)),
+          m_options(options)
+    {
+        if (m_policies.empty() || static_cast<std::size_t>(m_names.size()) != m_policies.size())
+        {
+            throw std::invalid_argument("Every compared policy needs a name");
+        }
+        if (m_options.replications < 2)
+        {
+            throw std::invalid_argument("Comparing policies needs at least two replications");
+        }
+    }
+
+    ComparisonResult PolicyComparison::compare() const
+    {
+        const auto &names = kpi_names();
+        const auto kpi_count = static_cast<std::size_t>(names.size());
+        const auto lanes = m_policies.size();
+
+        // values[replication][lane][kpi]
+        auto values = parallel_map(m_options.replications, m_options.threads, [&](std::size_t replication)
+                                   {
+                                       auto simulation = m_simulations(m_options.base_seed + static_cast<unsigned>(replication));
+                                       std::vector<std::unique_ptr<PurchasePolicy>> policies;
+                                       std::vector<const PurchasePolicy *> fused;
+                                       for (const auto &factory : m_policies)
+                                       {
+                                           policies.push_back(factory());
+                                           fused.push_back(policies.back().get());
+                                       }
+
+                                       std::vector<std::vector<double>> row;
+                                       for (const auto &kpis : simulation->simulate_policies(fused))
+                                       {
+                                           std::vector<double> lane(kpi_count);
+                                           for (std::size_t k = 0; k + 1 < kpi_count; ++k)
+                                               lane[k] = ReplicationRunner::kpi_value(kpis, names[static_cast<qsizetype>(k)]);
+                                           lane[kpi_count - 1] = PolicyOptimizer::run_cost(kpis, m_options.costs);
+                                           row.push_back(std::move(lane));
+                                       }
+                                       return row; });
+
+        std::vector<std::vector<RunningStats>> stats(lanes, std::vector<RunningStats>(kpi_count));
+        std::vector<std::vector<RunningStats>> differences(lanes, std::vector<RunningStats>(kpi_count));
+        for (const auto &row : values)
+        {
+            for (std::size_t lane = 0; lane < lanes; ++lane)
+            {
+                for (std::size_t k = 0; k < kpi_count; ++k)
+                {
+                    stats[lane][k].add(row[lane][k]);
+                    differences[lane][k].add(row[lane][k] - row[0][k]);
+                }
+            }
+        }
+
+        ComparisonResult result;
+        result.replications = m_options.replications;
+        for (std::size_t lane = 0; lane < lanes; ++lane)
+        {
+            PolicySummary summary;
+            summary.policy = m_names[static_cast<qsizetype>(lane)];
+            for (std::size_t k = 0; k < kpi_count; ++k)
+                summary.kpis.push_back(confidence_interval(stats[lane][k], m_options.confidence_level));
+            result.policies.push_back(summary);
+
+            if (lane == 0)
+                continue;
+
+            PairedDifference difference;
+            difference.policy = summary.policy;
+            difference.baseline = m_names.front();
+            for (std::size_t k = 0; k < kpi_count; ++k)
+            {
+                difference.kpis.push_back(confidence_interval(differences[lane][k], m_options.confidence_level));
+
+                // Var(x - y) = Var x + Var y - 2 Cov(x, y)
+                double x = stats[lane][k].variance(), y = stats[0][k].variance();
+                double covariance = (x + y - differences[lane][k].variance()) / 2.0;
+                difference.correlations.push_back(x > 0.0 && y > 0.0 ? covariance / std::sqrt(x * y) : 0.0);
+            }
+            result.differences.push_back(difference);
+        }
+        return result;
+    }
+
+    const QStringList &PolicyComparison::kpi_names()
+    {
+        static const QStringList names = []
+        {
+            auto kpis = ReplicationRunner::kpi_names();
+            kpis << QStringLiteral("cost_per_day");
+            return kpis;
+        }();
+        return names;
+    }
+
+} // namespace qz
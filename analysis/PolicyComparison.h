@@ -0,0 +1,79 @@
+#ifndef CHAINSIM_POLICYCOMPARISON_H
+#define CHAINSIM_POLICYCOMPARISON_H
+
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "ChainSim.h"
+#include "analysis/PolicyOptimizer.h"
+#include "utils/Confidence.hpp"
+
+namespace qz
+{
+
+    struct ComparisonOptions
+    {
+        unsigned replications{16};
+        double confidence_level{0.95};
+        unsigned threads{0}; // 0 = one per core
+        unsigned base_seed{1};
+        OptimizerCosts costs{0.2 / 365.0, 100.0, 10.0}; // For the cost_per_day KPI
+    };
+
+    struct PolicySummary
+    {
+        QString policy;
+        std::vector<ConfidenceInterval> kpis; // Same order as PolicyComparison::kpi_names()
+    };
+
+    // KPIs of `policy` minus those of the baseline, paired replication by replication
+    struct PairedDifference
+    {
+        QString policy;
+        QString baseline;
+        std::vector<ConfidenceInterval> kpis;
+        std::vector<double> correlations; // Between the two policies' KPIs across replications
+    };
+
+    struct ComparisonResult
+    {
+        std::vector<PolicySummary> policies;
+        std::vector<PairedDifference> differences; // Every policy after the first against the first
+        unsigned replications{0};
+    };
+
+    /* Compares policies on common demand paths.
+     *
+     * Each replication is one ChainSim::simulate_policies pass: demand is drawn once per day and
+     * every policy is advanced on it, so K policies cost about one run plus K cheap state updates
+     * instead of K full runs. Because the policies see identical demand, differences between them
+     * are paired: their variance loses twice the covariance of the two policies' KPIs, which is
+     * what makes small differences resolvable with few replications.
+     */
+    class PolicyComparison
+    {
+    public:
+        using SimulationFactory = std::function<std::unique_ptr<ChainSim>(unsigned seed)>;
+        using PolicyFactory = std::function<std::unique_ptr<PurchasePolicy>()>;
+
+        // The first policy is the baseline the others are differenced against
+        PolicyComparison(SimulationFactory simulations, QStringList names, std::vector<PolicyFactory> policies,
+                         ComparisonOptions options = {});
+
+        ComparisonResult compare() const;
+
+        // ReplicationRunner::kpi_names() plus cost_per_day
+        static const QStringList &kpi_names();
+
+    private:
+        SimulationFactory m_simulations;
+        QStringList m_names;
+        std::vector<PolicyFactory> m_policies;
+        ComparisonOptions m_options;
+    };
+
+} // namespace qz
+
+#endif // CHAINSIM_POLICYCOMPARISON_H
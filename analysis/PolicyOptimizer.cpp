@@ -0,0 +1,317 @@
+#include "PolicyOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include "purchase_policies/PurchaseROP.h"
+#include "purchase_policies/PurchaseEOQ.h"
+#include "purchase_policies/PurchaseTPOP.h"
+#include "utils/Parallel.hpp"
+
+namespace qz
+{
+
+    PolicyOptimizer::PolicyOptimizer(SimulationFactory simulations, PolicyFactory policies, ParameterSpace space,
+                                     OptimizerCosts costs, OptimizerOptions options)
+        : m_simulations(std::move(simulations)), m_policies(std::move(policies)), m_space(std::move(space)),
+          m_costs(costs), m_options(options)
+    {
+        auto dimensions = m_space.initial.size();
+        if (dimensions == 0 || m_space.lower.size() != dimensions || m_space.upper.size() != dimensions ||
+            m_space.step.size() != dimensions)
+        {
+            throw std::invalid_argument("Parameter space bounds do not match its dimensions");
+        }
+        if (m_options.replications < 2)
+        {
+            throw std::invalid_argument("Optimizer needs at least two replications");
+        }
+    }
+
+    double PolicyOptimizer::run_cost(const SimulationKpis &kpis, const OptimizerCosts &costs)
+    {
+        double days = static_cast<double>(std::max<std::uint64_t>(1, kpis.days));
+        return costs.holding_per_unit_day * kpis.average_inventory +
+               costs.ordering_per_order * static_cast<double>(kpis.order_count) / days +
+               costs.stockout_per_unit * static_cast<double>(kpis.total_lost_sales) / days;
+    }
+
+    OptimizationResult PolicyOptimizer::optimize()
+    {
+        m_cache.clear();
+        m_evaluations = 0;
+
+        const auto dimensions = m_space.initial.size();
+        const auto start = snap(m_space.initial);
+
+        // Missing one point of service level costs as much as the initial policy does per day
+        m_penalty_per_point = std::max(1.0, evaluate(start).cost.mean());
+
+        // Initial simplex: the heuristic's parameters plus one step along each axis
+        std::vector<std::vector<double>> points(dimensions + 1, start);
+        for (std::size_t i = 0; i < dimensions; ++i)
+        {
+            auto &vertex = points[i + 1];
+            vertex[i] += m_space.step[i];
+            if (vertex[i] > m_space.upper[i])
+                vertex[i] = start[i] - m_space.step[i];
+            vertex = clamp(vertex);
+        }
+
+        std::vector<double> values(points.size());
+        for (std::size_t i = 0; i < points.size(); ++i)
+            values[i] = objective(evaluate(points[i]));
+
+        auto value_at = [this](const std::vector<double> &point)
+        {
+            return objective(evaluate(point));
+        };
+
+        // Nelder-Mead with the standard coefficients
+        constexpr double kReflect = 1.0, kExpand = 2.0, kContract = 0.5, kShrink = 0.5;
+        unsigned iteration = 0;
+        for (; iteration < m_options.max_iterations; ++iteration)
+        {
+            std::vector<std::size_t> order(points.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::sort(order.begin(), order.end(), [&](auto a, auto b)
+                      { return values[a] < values[b]; });
+            std::vector<std::vector<double>> sorted_points;
+            std::vector<double> sorted_values;
+            for (auto index : order)
+            {
+                sorted_points.push_back(points[index]);
+                sorted_values.push_back(values[index]);
+            }
+            points.swap(sorted_points);
+            values.swap(sorted_values);
+
+            // Converged once every vertex rounds to (almost) the same integer parameters
+            double diameter = 0.0;
+            for (std::size_t v = 1; v < points.size(); ++v)
+                for (std::size_t i = 0; i < dimensions; ++i)
+                    diameter = std::max(diameter, std::abs(points[v][i] - points[0][i]));
+            if (diameter < 0.5)
+                break;
+
+            std::vector<double> centroid(dimensions, 0.0);
+            for (std::size_t v = 0; v < dimensions; ++v)
+                for (std::size_t i = 0; i < dimensions; ++i)
+                    centroid[i] += points[v][i] / static_cast<double>(dimensions);
+
+            auto along = [&](const std::vector<double> &from, double coefficient)
+            {
+                std::vector<double> point(dimensions);
+                for (std::size_t i = 0; i < dimensions; ++i)
+                    point[i] = centroid[i] + coefficient * (from[i] - centroid[i]);
+                return clamp(point);
+            };
+
+            auto &worst = points.back();
+            auto reflected = along(worst, -kReflect);
+            double reflected_value = value_at(reflected);
+
+            if (reflected_value < values.front())
+            {
+                auto expanded = along(worst, -kExpand);
+                double expanded_value = value_at(expanded);
+                if (expanded_value < reflected_value)
+                {
+                    worst = expanded;
+                    values.back() = expanded_value;
+                }
+                else
+                {
+                    worst = reflected;
+                    values.back() = reflected_value;
+                }
+                continue;
+            }
+
+            if (reflected_value < values[dimensions - 1])
+            {
+                worst = reflected;
+                values.back() = reflected_value;
+                continue;
+            }
+
+            bool outside = reflected_value < values.back();
+            auto contracted = outside ? along(worst, -kContract) : along(worst, kContract);
+            double contracted_value = value_at(contracted);
+            if (contracted_value < std::min(reflected_value, values.back()))
+            {
+                worst = contracted;
+                values.back() = contracted_value;
+                continue;
+            }
+
+            for (std::size_t v = 1; v < points.size(); ++v)
+            {
+                for (std::size_t i = 0; i < dimensions; ++i)
+                    points[v][i] = points[0][i] + kShrink * (points[v][i] - points[0][i]);
+                points[v] = clamp(points[v]);
+                values[v] = value_at(points[v]);
+            }
+        }
+
+        auto best_index = std::min_element(values.begin(), values.end()) - values.begin();
+        auto best = snap(points[best_index]);
+
+        // Confirm on seeds the search never saw, paired between the best and initial parameters
+        unsigned confirmation_seed = m_options.base_seed + m_options.replications;
+        auto confirmed = simulate(best, confirmation_seed);
+        auto baseline = simulate(start, confirmation_seed);
+
+        RunningStats savings;
+        for (std::size_t r = 0; r < confirmed.costs.size(); ++r)
+            savings.add(baseline.costs[r] - confirmed.costs[r]);
+
+        OptimizationResult result;
+        result.names = m_space.names;
+        result.best = best;
+        result.initial = start;
+        result.cost = confidence_interval(confirmed.cost, m_options.confidence_level);
+        result.service_level = confidence_interval(confirmed.service_level, m_options.confidence_level);
+        result.initial_cost = confidence_interval(baseline.cost, m_options.confidence_level);
+        result.savings = confidence_interval(savings, m_options.confidence_level);
+        result.feasible = confirmed.service_level.mean() >= m_options.target_service_level;
+        result.iterations = iteration;
+        result.evaluations = m_evaluations;
+        result.replications = m_options.replications;
+        return result;
+    }
+
+    const PolicyOptimizer::Evaluation &PolicyOptimizer::evaluate(const std::vector<double> &point)
+    {
+        auto key = snap(point);
+        auto it = m_cache.find(key);
+        if (it != m_cache.end())
+            return it->second;
+
+        ++m_evaluations;
+        return m_cache.emplace(key, simulate(key, m_options.base_seed)).first->second;
+    }
+
+    PolicyOptimizer::Evaluation PolicyOptimizer::simulate(const std::vector<double> &point, unsigned first_seed) const
+    {
+        Evaluation evaluation;
+        evaluation.costs.resize(m_options.replications);
+        std::vector<double> service_levels(m_options.replications);
+
+        parallel_for(m_options.replications, m_options.threads, [&](std::size_t replication)
+                     {
+                         auto simulation = m_simulations(first_seed + static_cast<unsigned>(replication));
+                         auto policy = m_policies(point);
+                         simulation->initialize_simulation();
+                         simulation->simulate(*policy);
+
+                         auto kpis = simulation->get_kpis();
+                         evaluation.costs[replication] = run_cost(kpis, m_costs);
+                         service_levels[replication] = kpis.service_level; });
+
+        for (std::size_t r = 0; r < evaluation.costs.size(); ++r)
+        {
+            evaluation.cost.add(evaluation.costs[r]);
+            evaluation.service_level.add(service_levels[r]);
+        }
+        return evaluation;
+    }
+
+    double PolicyOptimizer::objective(const Evaluation &evaluation) const
+    {
+        double shortfall = std::max(0.0, m_options.target_service_level - evaluation.service_level.mean());
+        return evaluation.cost.mean() + m_penalty_per_point * shortfall;
+    }
+
+    std::vector<double> PolicyOptimizer::clamp(std::vector<double> point) const
+    {
+        for (std::size_t i = 0; i < point.size(); ++i)
+            point[i] = std::clamp(point[i], m_space.lower[i], m_space.upper[i]);
+        return point;
+    }
+
+    std::vector<double> PolicyOptimizer::snap(const std::vector<double> &point) const
+    {
+        auto snapped = clamp(point);
+        for (auto &value : snapped)
+            value = std::round(value);
+        return clamp(snapped);
+    }
+
+    ParameterSpace PolicyOptimizer::parameter_space(const PurchasePolicy &heuristic, quint32 lead_time,
+                                                    double average_demand, quint64 horizon)
+    {
+        double demand = std::max(1.0, average_demand);
+        auto span = [](double initial, double floor)
+        {
+            return std::max(initial, floor) * 4.0;
+        };
+
+        ParameterSpace space;
+        if (auto *rop = qobject_cast<const PurchaseROP *>(&heuristic))
+        {
+            auto parameters = rop->parameters();
+            space.names = {"reorder_point", "order_quantity"};
+            space.initial = {double(parameters.reorder_point), double(parameters.order_quantity)};
+        }
+        else if (auto *eoq = qobject_cast<const PurchaseEOQ *>(&heuristic))
+        {
+            auto parameters = eoq->parameters();
+            space.names = {"reorder_point", "order_quantity"};
+            space.initial = {double(parameters.reorder_point), double(parameters.order_quantity)};
+        }
+        else if (auto *tpop = qobject_cast<const PurchaseTPOP *>(&heuristic))
+        {
+            auto parameters = tpop->parameters();
+            double review_period = parameters.review_period;
+            space.names = {"review_period", "target_level"};
+            space.initial = {review_period, std::round(parameters.target_level)};
+            space.lower = {1.0, 0.0};
+            space.upper = {std::max(1.0, double(horizon) - 1.0),
+                           span(parameters.target_level, demand * (review_period + lead_time))};
+            space.step = {std::max(1.0, review_period / 2.0), std::max(1.0, parameters.target_level / 4.0)};
+            return space;
+        }
+        else
+        {
+            throw std::invalid_argument("Policy " + heuristic.name().toStdString() + " cannot be optimized");
+        }
+
+        // Reorder point / order quantity policies
+        space.lower = {0.0, 1.0};
+        space.upper = {span(space.initial[0], demand * lead_time), span(space.initial[1], demand * lead_time)};
+        space.step = {std::max(1.0, std::max(space.initial[0], demand) / 4.0),
+                      std::max(1.0, space.initial[1] / 4.0)};
+        return space;
+    }
+
+    PolicyOptimizer::PolicyFactory PolicyOptimizer::policy_factory(const QString &policy_name, quint32 lead_time)
+    {
+        if (policy_name == "ROP")
+        {
+            return [lead_time](const std::vector<double> &x) -> std::unique_ptr<PurchasePolicy>
+            {
+                return std::make_unique<PurchaseROP>(
+                    lead_time, PurchaseROP::Parameters{qint64(x[0]), qint64(x[1])});
+            };
+        }
+        if (policy_name == "EOQ")
+        {
+            return [lead_time](const std::vector<double> &x) -> std::unique_ptr<PurchasePolicy>
+            {
+                return std::make_unique<PurchaseEOQ>(
+                    lead_time, PurchaseEOQ::Parameters{qint64(x[0]), qint64(x[1])});
+            };
+        }
+        if (policy_name == "TPOP")
+        {
+            return [lead_time](const std::vector<double> &x) -> std::unique_ptr<PurchasePolicy>
+            {
+                return std::make_unique<PurchaseTPOP>(
+                    lead_time, PurchaseTPOP::Parameters{quint32(x[0]), x[1]});
+            };
+        }
+
+        throw std::invalid_argument("Unsupported policy: " + policy_name.toStdString());
+    }
+
+} // namespace qz
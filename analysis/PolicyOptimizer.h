@@ -0,0 +1,114 @@
+#ifndef CHAINSIM_POLICYOPTIMIZER_H
+#define CHAINSIM_POLICYOPTIMIZER_H
+
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+#include "ChainSim.h"
+#include "utils/Confidence.hpp"
+
+namespace qz
+{
+
+    struct OptimizerCosts
+    {
+        double holding_per_unit_day{0.0};
+        double ordering_per_order{0.0};
+        double stockout_per_unit{0.0};
+    };
+
+    struct OptimizerOptions
+    {
+        double target_service_level{95.0}; // Percent of demand served, averaged over replications
+        unsigned replications{16};
+        unsigned max_iterations{100};
+        unsigned threads{0}; // 0 = one per core
+        unsigned base_seed{1};
+        double confidence_level{0.95};
+    };
+
+    // Box-constrained integer decision variables, searched with a continuous simplex and rounded
+    struct ParameterSpace
+    {
+        QStringList names;
+        std::vector<double> initial;
+        std::vector<double> lower;
+        std::vector<double> upper;
+        std::vector<double> step; // Size of the initial simplex along each axis
+    };
+
+    struct OptimizationResult
+    {
+        QStringList names;
+        std::vector<double> best;
+        std::vector<double> initial;
+        ConfidenceInterval cost; // Expected cost per day of the best parameters
+        ConfidenceInterval service_level;
+        ConfidenceInterval initial_cost;
+        ConfidenceInterval savings; // Paired cost reduction per day versus the initial parameters
+        bool feasible{false};       // Whether the best parameters meet the service-level target
+        unsigned iterations{0};
+        unsigned evaluations{0};
+        unsigned replications{0};
+    };
+
+    /* Simulation-based search for the policy parameters minimizing expected holding + ordering +
+     * stockout cost per day, subject to an average service-level target.
+     *
+     * Every candidate is simulated on the same set of seeds (common random numbers), which turns
+     * the noisy objective into a deterministic sample-average problem that Nelder-Mead can
+     * search, and makes differences between candidates far less noisy than their costs.
+     * Replications of a candidate run in parallel in summary-only mode. Shortfalls against the
+     * service-level target are penalized in proportion to the initial cost per percentage point.
+     * The reported bounds come from a confirmation run on fresh seeds, so they are not biased by
+     * the search having picked the luckiest candidate.
+     */
+    class PolicyOptimizer
+    {
+    public:
+        using SimulationFactory = std::function<std::unique_ptr<ChainSim>(unsigned seed)>;
+        using PolicyFactory = std::function<std::unique_ptr<PurchasePolicy>(const std::vector<double> &parameters)>;
+
+        PolicyOptimizer(SimulationFactory simulations, PolicyFactory policies, ParameterSpace space,
+                        OptimizerCosts costs, OptimizerOptions options = {});
+
+        OptimizationResult optimize();
+
+        // Cost per day of one run
+        static double run_cost(const SimulationKpis &kpis, const OptimizerCosts &costs);
+
+        // Search space of a policy, centred on the parameters its heuristic constructor derives
+        static ParameterSpace parameter_space(const PurchasePolicy &heuristic, quint32 lead_time,
+                                              double average_demand, quint64 horizon);
+        static PolicyFactory policy_factory(const QString &policy_name, quint32 lead_time);
+
+    private:
+        struct Evaluation
+        {
+            std::vector<double> costs; // Per replication, in seed order
+            RunningStats cost;
+            RunningStats service_level;
+        };
+
+        const Evaluation &evaluate(const std::vector<double> &point);
+        Evaluation simulate(const std::vector<double> &point, unsigned first_seed) const;
+        double objective(const Evaluation &evaluation) const;
+        std::vector<double> clamp(std::vector<double> point) const;
+        std::vector<double> snap(const std::vector<double> &point) const;
+
+        SimulationFactory m_simulations;
+        PolicyFactory m_policies;
+        ParameterSpace m_space;
+        OptimizerCosts m_costs;
+        OptimizerOptions m_options;
+        double m_penalty_per_point{1.0};
+        std::map<std::vector<double>, Evaluation> m_cache; // Keyed by snapped parameters
+        unsigned m_evaluations{0};
+    };
+
+} // namespace qz
+
+#endif // CHAINSIM_POLICYOPTIMIZER_H
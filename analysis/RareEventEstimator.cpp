@@ -0,0 +1,157 @@
+#include "RareEventEstimator.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include "utils/Parallel.hpp"
+
+namespace qz
+{
+
+    namespace
+    {
+        // Pilot seeds start far from the estimation seeds, so choosing the tilt does not bias the estimate
+        constexpr unsigned kPilotSeedOffset = 1000000;
+        constexpr double kEliteFraction = 0.1;
+        constexpr int kMaxPilotIterations = 10;
+    }
+
+    RareEventEstimator::RareEventEstimator(SimulationFactory simulations, PolicyFactory policies,
+                                           RareEventOptions options)
+        : m_simulations(std::move(simulations)), m_policies(std::move(policies)), m_options(options)
+    {
+        if (m_options.window == 0)
+        {
+            throw std::invalid_argument("Importance sampling needs a window of at least one day");
+        }
+        if (m_options.replications < 2 || (m_options.tilt == 0.0 && m_options.pilot_replications < 2))
+        {
+            throw std::invalid_argument("Importance sampling needs at least two replications");
+        }
+        if (m_options.tilt < 0.0)
+        {
+            throw std::invalid_argument("Tilt must be positive");
+        }
+    }
+
+    RareEventEstimate RareEventEstimator::estimate() const
+    {
+        RareEventEstimate result;
+        result.tilt = m_options.tilt > 0.0 ? m_options.tilt : choose_tilt();
+        result.window = m_options.window;
+        result.replications = m_options.replications;
+
+        auto samples = run(result.tilt, m_options.replications, m_options.base_seed);
+
+        RunningStats stockout, stockout_days, lost_sales;
+        double weight_sum = 0.0, weight_squares = 0.0;
+        for (const auto &sample : samples)
+        {
+            stockout.add(sample.weight * sample.stockout);
+            stockout_days.add(sample.weight * sample.stockout_days);
+            lost_sales.add(sample.weight * sample.lost_sales);
+            weight_sum += sample.weight;
+            weight_squares += sample.weight * sample.weight;
+        }
+
+        auto per_day = [this](ConfidenceInterval interval)
+        {
+            auto days = static_cast<double>(m_options.window);
+            return ConfidenceInterval{interval.mean / days, interval.half_width / days};
+        };
+        result.stockout_probability = confidence_interval(stockout, m_options.confidence_level);
+        result.stockout_day_probability = per_day(confidence_interval(stockout_days, m_options.confidence_level));
+        result.lost_sales_per_day = per_day(confidence_interval(lost_sales, m_options.confidence_level));
+        result.effective_sample_size = weight_squares > 0.0 ? weight_sum * weight_sum / weight_squares : 0.0;
+
+        double p = stockout.mean();
+        if (p > 0.0 && stockout.variance() > 0.0)
+        {
+            result.variance_reduction = p * (1.0 - p) / stockout.variance();
+        }
+
+        // Every replication shares the horizon, so any of them gives the warm-up length
+        auto simulation = m_simulations(m_options.base_seed);
+        result.warmup_days = simulation->get_simulation_length() - 1 - m_options.window;
+        return result;
+    }
+
+    std::vector<RareEventEstimator::Sample> RareEventEstimator::run(double tilt, unsigned replications,
+                                                                      unsigned first_seed) const
+    {
+        std::vector<Sample> samples(replications);
+        parallel_for(replications, m_options.threads, [&](std::size_t replication)
+                     {
+                         auto simulation = m_simulations(first_seed + static_cast<unsigned>(replication));
+                         auto policy = m_policies();
+
+                         // Days 1 .. length - 1 are simulated; the window is the last of them
+                         auto simulated_days = simulation->get_simulation_length() - 1;
+                         if (m_options.window > simulated_days)
+                         {
+                             throw std::invalid_argument("Importance sampling window is longer than the simulation");
+                         }
+
+                         simulation->initialize_simulation();
+                         simulation->simulate_days(*policy, simulated_days - m_options.window);
+                         auto before = simulation->get_kpis();
+
+                         simulation->set_demand_tilt(tilt);
+                         simulation->simulate_days(*policy, m_options.window);
+                         auto after = simulation->get_kpis();
+
+                         auto &sample = samples[replication];
+                         sample.weight = std::exp(simulation->get_log_likelihood_ratio());
+                         sample.stockout_days = static_cast<double>(after.stockout_days - before.stockout_days);
+                         sample.stockout = sample.stockout_days > 0.0 ? 1.0 : 0.0;
+                         sample.lost_sales = static_cast<double>(after.total_lost_sales - before.total_lost_sales);
+                         sample.demand = static_cast<double>(after.total_demand - before.total_demand) /
+                                         static_cast<double>(m_options.window); });
+        return samples;
+    }
+
+    double RareEventEstimator::choose_tilt() const
+    {
+        double tilt = 1.0;
+        double nominal_demand = 0.0;
+        auto elite_size = std::max<std::size_t>(1, static_cast<std::size_t>(kEliteFraction * m_options.pilot_replications));
+
+        for (int iteration = 0; iteration < kMaxPilotIterations; ++iteration)
+        {
+            auto samples = run(tilt, m_options.pilot_replications,
+                               m_options.base_seed + kPilotSeedOffset + iteration * m_options.pilot_replications);
+            if (iteration == 0)
+            {
+                for (const auto &sample : samples)
+                    nominal_demand += sample.demand / static_cast<double>(samples.size());
+                if (nominal_demand <= 0.0)
+                    return 1.0;
+            }
+
+            // Stockouts first, then the highest window demand: the elite are the runs closest to one
+            std::sort(samples.begin(), samples.end(), [](const Sample &a, const Sample &b)
+                      { return a.stockout != b.stockout ? a.stockout > b.stockout : a.demand > b.demand; });
+            std::size_t stockouts = 0;
+            while (stockouts < samples.size() && samples[stockouts].stockout > 0.0)
+                ++stockouts;
+            auto elite = std::max(stockouts, elite_size);
+
+            double weighted_demand = 0.0, weight = 0.0;
+            for (std::size_t i = 0; i < elite; ++i)
+            {
+                weighted_demand += samples[i].weight * samples[i].demand;
+                weight += samples[i].weight;
+            }
+            if (weight <= 0.0)
+                break;
+
+            double next = std::max(1.0, weighted_demand / weight / nominal_demand);
+            bool settled = stockouts >= elite_size && std::abs(next - tilt) < 0.01 * tilt;
+            tilt = next;
+            if (settled)
+                break;
+        }
+        return tilt;
+    }
+
+} // namespace qz
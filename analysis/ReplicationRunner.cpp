@@ -0,0 +1,224 @@
+#include "ReplicationRunner.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include "utils/Parallel.hpp"
+
+namespace qz
+{
+
+    namespace
+    {
+        // Same order as ReplicationRunner::kpi_names()
+        std::vector<double> kpi_values(const SimulationKpis &kpis)
+        {
+            return {kpis.service_level,
+                    kpis.average_inventory,
+                    kpis.inventory_stddev,
+                    kpis.average_demand,
+                    kpis.demand_stddev,
+                    kpis.inventory_turns,
+                    static_cast<double>(kpis.peak_inventory),
+                    static_cast<double>(kpis.min_inventory),
+                    static_cast<double>(kpis.total_demand),
+                    static_cast<double>(kpis.total_sales),
+                    static_cast<double>(kpis.total_lost_sales),
+                    static_cast<double>(kpis.total_purchases),
+                    static_cast<double>(kpis.order_count),
+                    static_cast<double>(kpis.stockout_days)};
+        }
+
+        // Half-width the target asks for at the current mean
+        double required_half_width(const PrecisionTarget &target, const ConfidenceInterval &interval)
+        {
+            return target.relative ? target.half_width * std::abs(interval.mean) : target.half_width;
+        }
+    }
+
+    bool PrecisionTarget::met(const ConfidenceInterval &interval) const
+    {
+        return interval.half_width <= required_half_width(*this, interval);
+    }
+
+    ReplicationRunner::ReplicationRunner(SimulationFactory simulations, PolicyFactory policies,
+                                         std::vector<PrecisionTarget> targets, ReplicationOptions options)
+        : m_simulations(std::move(simulations)), m_policies(std::move(policies)), m_targets(std::move(targets)),
+          m_options(options)
+    {
+        if (m_targets.empty())
+        {
+            throw std::invalid_argument("At least one precision target is required");
+        }
+        if (m_options.min_replications < 2)
+        {
+            throw std::invalid_argument("Sequential stopping needs at least two replications before the first check");
+        }
+        if (m_options.max_replications < m_options.min_replications)
+        {
+            throw std::invalid_argument("max_replications must be at least min_replications");
+        }
+
+        const auto &names = kpi_names();
+        for (const auto &target : m_targets)
+        {
+            auto index = names.indexOf(target.kpi);
+            if (index < 0)
+            {
+                throw std::invalid_argument("Unknown KPI: " + target.kpi.toStdString());
+            }
+            if (!(target.half_width > 0.0))
+            {
+                throw std::invalid_argument("Precision target for " + target.kpi.toStdString() + " must be positive");
+            }
+            m_target_kpis.push_back(static_cast<int>(index));
+        }
+    }
+
+    ReplicationResult ReplicationRunner::run() const
+    {
+        const auto &names = kpi_names();
+        std::vector<RunningStats> stats(static_cast<std::size_t>(names.size()));
+        auto all_met = [&]()
+        {
+            for (std::size_t t = 0; t < m_targets.size(); ++t)
+            {
+                auto interval = confidence_interval(stats[m_target_kpis[t]], m_options.confidence_level);
+                if (!m_targets[t].met(interval))
+                    return false;
+            }
+            return true;
+        };
+
+        ReplicationResult result;
+        unsigned done = 0;
+        unsigned batch = std::min(m_options.max_replications,
+                                  std::max(m_options.min_replications, resolve_thread_count(m_options.threads)));
+        while (batch > 0)
+        {
+            auto runs = parallel_map(batch, m_options.threads, [&](std::size_t replication)
+                                     {
+                                         auto simulation = m_simulations(m_options.base_seed + done + static_cast<unsigned>(replication));
+                                         auto policy = m_policies();
+                                         simulation->initialize_simulation();
+                                         simulation->simulate(*policy);
+                                         return std::make_pair(kpi_values(simulation->get_kpis()), simulation->get_distributions()); });
+
+            for (const auto &[values, distributions] : runs)
+            {
+                for (std::size_t k = 0; k < values.size(); ++k)
+                    stats[k].add(values[k]);
+                result.distributions.merge(distributions);
+            }
+            done += batch;
+            ++result.batches;
+
+            if (all_met())
+            {
+                result.converged = true;
+                break;
+            }
+            batch = next_batch(stats, done);
+        }
+
+        result.replications = done;
+        for (qsizetype k = 0; k < names.size(); ++k)
+        {
+            KpiEstimate estimate;
+            estimate.kpi = names[k];
+            estimate.interval = confidence_interval(stats[k], m_options.confidence_level);
+            estimate.relative_half_width = estimate.interval.mean != 0.0
+                                               ? estimate.interval.half_width / std::abs(estimate.interval.mean)
+                                               : std::numeric_limits<double>::infinity();
+            result.estimates.push_back(estimate);
+        }
+        for (std::size_t t = 0; t < m_targets.size(); ++t)
+        {
+            auto &estimate = result.estimates[m_target_kpis[t]];
+            estimate.targeted = true;
+            estimate.target_met = m_targets[t].met(estimate.interval);
+        }
+        return result;
+    }
+
+    unsigned ReplicationRunner::next_batch(const std::vector<RunningStats> &stats, unsigned done) const
+    {
+        if (done >= m_options.max_replications)
+            return 0;
+
+        // Half-widths shrink with sqrt(n): n * (current / required)^2 replications reach the target
+        double needed = done;
+        for (std::size_t t = 0; t < m_targets.size(); ++t)
+        {
+            auto interval = confidence_interval(stats[m_target_kpis[t]], m_options.confidence_level);
+            double required = required_half_width(m_targets[t], interval);
+            if (required <= 0.0)
+            {
+                needed = std::max(needed, 2.0 * done);
+                continue;
+            }
+            double ratio = interval.half_width / required;
+            needed = std::max(needed, std::ceil(done * ratio * ratio));
+        }
+
+        // Variance estimates are noisy, so grow by at most the replications so far (or one per thread)
+        double threads = resolve_thread_count(m_options.threads);
+        double extra = std::min(std::max(needed - done, threads), std::max<double>(done, threads));
+        return static_cast<unsigned>(std::min<double>(extra, m_options.max_replications - done));
+    }
+
+    std::vector<PrecisionTarget> ReplicationRunner::parse_targets(const QString &spec)
+    {
+        std::vector<PrecisionTarget> targets;
+        for (const auto &item : spec.split(',', Qt::SkipEmptyParts))
+        {
+            auto parts = item.trimmed().split(':');
+            if (parts.size() != 2)
+            {
+                throw std::invalid_argument("Precision targets look like kpi:half_width or kpi:percent%, got " +
+                                            item.toStdString());
+            }
+
+            PrecisionTarget target;
+            target.kpi = parts[0].trimmed();
+            QString value = parts[1].trimmed();
+            if (value.endsWith('%'))
+            {
+                target.relative = true;
+                value.chop(1);
+            }
+
+            bool ok = false;
+            target.half_width = value.toDouble(&ok);
+            if (!ok)
+            {
+                throw std::invalid_argument("Invalid precision target: " + item.toStdString());
+            }
+            if (target.relative)
+                target.half_width /= 100.0;
+            targets.push_back(target);
+        }
+        return targets;
+    }
+
+    const QStringList &ReplicationRunner::kpi_names()
+    {
+        static const QStringList names{
+            "service_level", "average_inventory", "inventory_stddev", "average_demand", "demand_stddev",
+            "inventory_turns", "peak_inventory", "min_inventory", "total_demand", "total_sales",
+            "total_lost_sales", "total_purchases", "order_count", "stockout_days"};
+        return names;
+    }
+
+    double ReplicationRunner::kpi_value(const SimulationKpis &kpis, const QString &name)
+    {
+        auto index = kpi_names().indexOf(name);
+        if (index < 0)
+        {
+            throw std::invalid_argument("Unknown KPI: " + name.toStdString());
+        }
+        return kpi_values(kpis)[static_cast<std::size_t>(index)];
+    }
+
+} // namespace qz
@@ -0,0 +1,87 @@
+#ifndef CHAINSIM_REPLICATIONRUNNER_H
+#define CHAINSIM_REPLICATIONRUNNER_H
+
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "ChainSim.h"
+#include "utils/Confidence.hpp"
+
+namespace qz
+{
+
+    // Stop once the confidence interval of `kpi` is at most this wide on either side of the mean
+    struct PrecisionTarget
+    {
+        QString kpi;
+        double half_width{0.0};
+        bool relative{false}; // half_width is a fraction of |mean| instead of KPI units
+
+        [[nodiscard]] bool met(const ConfidenceInterval &interval) const;
+    };
+
+    struct ReplicationOptions
+    {
+        double confidence_level{0.95};
+        unsigned min_replications{10}; // Before the first check, so early variance estimates are not trusted
+        unsigned max_replications{1000};
+        unsigned threads{0}; // 0 = one per core
+        unsigned base_seed{1};
+    };
+
+    struct KpiEstimate
+    {
+        QString kpi;
+        ConfidenceInterval interval;
+        double relative_half_width{0.0}; // half_width / |mean|, infinite when the mean is 0
+        bool targeted{false};
+        bool target_met{false};
+    };
+
+    struct ReplicationResult
+    {
+        std::vector<KpiEstimate> estimates; // Every KPI, targeted or not
+        KpiDistributions distributions;     // Daily distributions pooled over every replication
+        bool converged{false};              // Whether every target was met within the budget
+        unsigned replications{0};
+        unsigned batches{0};
+    };
+
+    /* Runs independent replications until every precision target is met or the budget runs out.
+     *
+     * Replications run in parallel batches on consecutive seeds and are pooled in seed order, so
+     * the estimates depend only on how many seeds were run, not on scheduling. After each batch the
+     * targets are checked; the next batch is sized from the current variance estimate to reach
+     * the widest target (at most doubling the replications so far, at least one per thread).
+     */
+    class ReplicationRunner
+    {
+    public:
+        using SimulationFactory = std::function<std::unique_ptr<ChainSim>(unsigned seed)>;
+        using PolicyFactory = std::function<std::unique_ptr<PurchasePolicy>()>;
+
+        ReplicationRunner(SimulationFactory simulations, PolicyFactory policies,
+                          std::vector<PrecisionTarget> targets, ReplicationOptions options = {});
+
+        ReplicationResult run() const;
+
+        // Parses "service_level:0.5,average_inventory:2%": absolute half-widths, or relative with %
+        static std::vector<PrecisionTarget> parse_targets(const QString &spec);
+        static const QStringList &kpi_names();
+        static double kpi_value(const SimulationKpis &kpis, const QString &name);
+
+    private:
+        unsigned next_batch(const std::vector<RunningStats> &stats, unsigned done) const;
+
+        SimulationFactory m_simulations;
+        PolicyFactory m_policies;
+        std::vector<PrecisionTarget> m_targets;
+        std::vector<int> m_target_kpis; // Index into kpi_names() of each target
+        ReplicationOptions m_options;
+    };
+
+} // namespace qz
+
+#endif // CHAINSIM_REPLICATIONRUNNER_H
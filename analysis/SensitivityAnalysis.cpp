@@ -0,0 +1,276 @@
+#include "SensitivityAnalysis.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include "utils/Parallel.hpp"
+#include "utils/SobolSequence.hpp"
+
+namespace qz
+{
+
+    namespace
+    {
+        // Model outputs of the design for one output: f(A), f(B) and f(AB_i), indexed by row
+        struct DesignOutputs
+        {
+            std::vector<double> a;
+            std::vector<double> b;
+            std::vector<std::vector<double>> ab;
+        };
+
+        struct Indices
+        {
+            std::vector<double> first_order;
+            std::vector<double> total;
+        };
+
+        // Saltelli (2010) first-order and Jansen total indices over the given rows
+        Indices sobol_indices(const DesignOutputs &f, const std::vector<std::size_t> &rows)
+        {
+            auto n = static_cast<double>(rows.size());
+            double mean = 0.0;
+            for (auto j : rows)
+                mean += f.a[j] + f.b[j];
+            mean /= 2.0 * n;
+
+            double variance = 0.0;
+            for (auto j : rows)
+                variance += (f.a[j] - mean) * (f.a[j] - mean) + (f.b[j] - mean) * (f.b[j] - mean);
+            variance /= 2.0 * n;
+
+            Indices indices{std::vector<double>(f.ab.size(), 0.0), std::vector<double>(f.ab.size(), 0.0)};
+            if (!(variance > 0.0))
+                return indices; // A constant output depends on nothing
+
+            for (std::size_t i = 0; i < f.ab.size(); ++i)
+            {
+                double first = 0.0, total = 0.0;
+                for (auto j : rows)
+                {
+                    double change = f.ab[i][j] - f.a[j];
+                    first += f.b[j] * change;
+                    total += change * change;
+                }
+                indices.first_order[i] = first / n / variance;
+                indices.total[i] = total / (2.0 * n) / variance;
+            }
+            return indices;
+        }
+
+        double percentile(std::vector<double> &values, double p)
+        {
+            std::sort(values.begin(), values.end());
+            auto index = static_cast<std::size_t>(std::floor(p * static_cast<double>(values.size() - 1) + 0.5));
+            return values[std::min(index, values.size() - 1)];
+        }
+    }
+
+    double SensitivityParameter::value(double unit) const
+    {
+        if (!integer)
+            return lower + unit * (upper - lower);
+
+        // Each integer in [lower, upper] gets an equal share of the unit interval
+        double low = std::ceil(lower), high = std::floor(upper);
+        return std::min(high, std::floor(low + unit * (high - low + 1.0)));
+    }
+
+    SensitivityAnalysis::SensitivityAnalysis(std::vector<SensitivityParameter> parameters, QStringList outputs,
+                                             Evaluator evaluator, SensitivityOptions options)
+        : m_parameters(std::move(parameters)), m_outputs(std::move(outputs)), m_evaluator(std::move(evaluator)),
+          m_options(options)
+    {
+        if (m_parameters.empty())
+        {
+            throw std::invalid_argument("Sensitivity analysis needs at least one parameter");
+        }
+        if (2 * m_parameters.size() > SobolSequence::kMaxDimensions)
+        {
+            throw std::invalid_argument("Sensitivity analysis supports at most " +
+                                        std::to_string(SobolSequence::kMaxDimensions / 2) + " parameters");
+        }
+        if (m_outputs.isEmpty())
+        {
+            throw std::invalid_argument("Sensitivity analysis needs at least one output");
+        }
+        if (m_options.samples < 2 || m_options.replications < 1)
+        {
+            throw std::invalid_argument("Sensitivity analysis needs at least two samples and one replication per point");
+        }
+        if (!(m_options.confidence_level > 0.0 && m_options.confidence_level < 1.0))
+        {
+            throw std::invalid_argument("confidence_level must be in (0, 1)");
+        }
+        for (const auto &parameter : m_parameters)
+        {
+            bool empty = parameter.integer ? std::floor(parameter.upper) < std::ceil(parameter.lower)
+                                           : !(parameter.upper >= parameter.lower);
+            if (empty)
+            {
+                throw std::invalid_argument("Empty range for " + parameter.name.toStdString());
+            }
+        }
+    }
+
+    SensitivityResult SensitivityAnalysis::analyze() const
+    {
+        // Sobol points are balanced in blocks of powers of two
+        std::size_t rows = 1;
+        while (rows < m_options.samples)
+            rows <<= 1;
+        const auto d = m_parameters.size();
+        const auto columns = d + 2; // A, B, AB_1 .. AB_d
+        const auto output_count = static_cast<std::size_t>(m_outputs.size());
+
+        // Row j of A is the first d coordinates of point j, row j of B the last d
+        std::vector<std::vector<double>> design(rows);
+        SobolSequence sobol(static_cast<unsigned>(2 * d));
+        for (auto &row : design)
+        {
+            const auto &point = sobol.next();
+            row.resize(2 * d);
+            for (std::size_t k = 0; k < 2 * d; ++k)
+                row[k] = m_parameters[k % d].value(point[k]);
+        }
+
+        std::vector<std::vector<double>> values(rows * columns);
+        parallel_for(values.size(), m_options.threads, [&](std::size_t evaluation)
+                     {
+                         auto row = evaluation / columns;
+                         auto column = evaluation % columns;
+                         const auto &sample = design[row];
+
+                         std::vector<double> point(sample.begin() + (column == 1 ? d : 0),
+                                                   sample.begin() + (column == 1 ? 2 * d : d));
+                         if (column >= 2)
+                             point[column - 2] = sample[d + column - 2];
+
+                         // Common random numbers: the row's seeds, whichever matrix the point is from
+                         std::vector<double> mean(output_count, 0.0);
+                         for (unsigned r = 0; r < m_options.replications; ++r)
+                         {
+                             auto outputs = m_evaluator(point, m_options.base_seed +
+                                                                   static_cast<unsigned>(row) * m_options.replications + r);
+                             if (outputs.size() != output_count)
+                             {
+                                 throw std::logic_error("Sensitivity evaluator returned the wrong number of outputs");
+                             }
+                             for (std::size_t k = 0; k < output_count; ++k)
+                                 mean[k] += outputs[k] / m_options.replications;
+                         }
+                         values[evaluation] = std::move(mean); });
+
+        std::vector<DesignOutputs> outputs(output_count);
+        for (std::size_t k = 0; k < output_count; ++k)
+        {
+            auto &f = outputs[k];
+            f.a.resize(rows);
+            f.b.resize(rows);
+            f.ab.assign(d, std::vector<double>(rows));
+            for (std::size_t j = 0; j < rows; ++j)
+            {
+                f.a[j] = values[j * columns][k];
+                f.b[j] = values[j * columns + 1][k];
+                for (std::size_t i = 0; i < d; ++i)
+                    f.ab[i][j] = values[j * columns + 2 + i][k];
+            }
+        }
+
+        std::vector<std::size_t> all_rows(rows);
+        for (std::size_t j = 0; j < rows; ++j)
+            all_rows[j] = j;
+
+        // Bootstrap resamples of the rows, shared by every output
+        std::vector<std::vector<Indices>> resampled(output_count);
+        std::mt19937_64 rng(m_options.base_seed);
+        std::uniform_int_distribution<std::size_t> pick(0, rows - 1);
+        std::vector<std::size_t> sample(rows);
+        for (unsigned b = 0; b < m_options.bootstrap; ++b)
+        {
+            for (auto &j : sample)
+                j = pick(rng);
+            for (std::size_t k = 0; k < output_count; ++k)
+                resampled[k].push_back(sobol_indices(outputs[k], sample));
+        }
+
+        double tail = (1.0 - m_options.confidence_level) / 2.0;
+        auto index = [&](double estimate, std::size_t k, auto member, std::size_t i)
+        {
+            SensitivityIndex result{estimate, estimate, estimate};
+            if (resampled[k].empty())
+                return result;
+            std::vector<double> draws;
+            for (const auto &indices : resampled[k])
+                draws.push_back((indices.*member)[i]);
+            result.lower = percentile(draws, tail);
+            result.upper = percentile(draws, 1.0 - tail);
+            return result;
+        };
+
+        SensitivityResult result;
+        result.samples = static_cast<unsigned>(rows);
+        result.evaluations = static_cast<unsigned>(values.size() * m_options.replications);
+        for (std::size_t k = 0; k < output_count; ++k)
+        {
+            const auto &f = outputs[k];
+            OutputSensitivity output;
+            output.output = m_outputs[static_cast<qsizetype>(k)];
+            for (std::size_t j = 0; j < rows; ++j)
+                output.mean += (f.a[j] + f.b[j]) / (2.0 * rows);
+            for (std::size_t j = 0; j < rows; ++j)
+                output.variance += ((f.a[j] - output.mean) * (f.a[j] - output.mean) +
+                                    (f.b[j] - output.mean) * (f.b[j] - output.mean)) /
+                                   (2.0 * rows);
+
+            auto estimates = sobol_indices(f, all_rows);
+            for (std::size_t i = 0; i < d; ++i)
+            {
+                ParameterSensitivity parameter;
+                parameter.parameter = m_parameters[i].name;
+                parameter.first_order = index(estimates.first_order[i], k, &Indices::first_order, i);
+                parameter.total = index(estimates.total[i], k, &Indices::total, i);
+                output.parameters.push_back(parameter);
+            }
+            result.outputs.push_back(output);
+        }
+        return result;
+    }
+
+    std::vector<SensitivityParameter> SensitivityAnalysis::parse_parameters(const QString &spec)
+    {
+        std::vector<SensitivityParameter> parameters;
+        for (const auto &item : spec.split(',', Qt::SkipEmptyParts))
+        {
+            auto parts = item.trimmed().split(':');
+            if (parts.size() != 3)
+            {
+                throw std::invalid_argument("Parameter ranges look like name:lower:upper, got " + item.toStdString());
+            }
+
+            SensitivityParameter parameter;
+            parameter.name = parts[0].trimmed();
+            bool lower_ok = false, upper_ok = false;
+            parameter.lower = parts[1].trimmed().toDouble(&lower_ok);
+            parameter.upper = parts[2].trimmed().toDouble(&upper_ok);
+            if (!lower_ok || !upper_ok)
+            {
+                throw std::invalid_argument("Invalid parameter range: " + item.toStdString());
+            }
+            for (const auto &existing : parameters)
+            {
+                if (existing.name == parameter.name)
+                {
+                    throw std::invalid_argument("Duplicate parameter range: " + parameter.name.toStdString());
+                }
+            }
+            parameters.push_back(parameter);
+        }
+        if (parameters.empty())
+        {
+            throw std::invalid_argument("No parameter ranges given");
+        }
+        return parameters;
+    }
+
+} // namespace qz
@@ -0,0 +1,96 @@
+#ifndef CHAINSIM_SENSITIVITYANALYSIS_H
+#define CHAINSIM_SENSITIVITYANALYSIS_H
+
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include <vector>
+
+namespace qz
+{
+
+    // A scenario input varied uniformly over [lower, upper]; integer inputs take every value in it equally often
+    struct SensitivityParameter
+    {
+        QString name;
+        double lower{0.0};
+        double upper{0.0};
+        bool integer{false};
+
+        [[nodiscard]] double value(double unit) const; // Maps a point of [0, 1) into the range
+    };
+
+    struct SensitivityOptions
+    {
+        unsigned samples{256};     // Base design rows N, rounded up to a power of two; N * (d + 2) evaluations
+        unsigned replications{1};  // Simulations averaged per design point
+        unsigned bootstrap{200};   // Resamples for the index intervals, 0 = none
+        double confidence_level{0.95};
+        unsigned threads{0}; // 0 = one per core
+        unsigned base_seed{1};
+    };
+
+    // Point estimate with a bootstrap percentile interval
+    struct SensitivityIndex
+    {
+        double estimate{0.0};
+        double lower{0.0};
+        double upper{0.0};
+    };
+
+    struct ParameterSensitivity
+    {
+        QString parameter;
+        SensitivityIndex first_order; // Share of the output variance the parameter explains alone
+        SensitivityIndex total;       // Share it explains including every interaction
+    };
+
+    struct OutputSensitivity
+    {
+        QString output;
+        double mean{0.0};
+        double variance{0.0};
+        std::vector<ParameterSensitivity> parameters; // Same order as the analysed parameters
+    };
+
+    struct SensitivityResult
+    {
+        std::vector<OutputSensitivity> outputs;
+        unsigned samples{0};
+        unsigned evaluations{0};
+    };
+
+    /* Variance-based global sensitivity analysis (Sobol indices) over scenario parameters.
+     *
+     * The design is Saltelli's: two independent N-row matrices A and B from one 2d-dimensional
+     * Sobol sequence, plus, for every parameter i, A with column i taken from B (AB_i). First-order
+     * indices use Saltelli's 2010 estimator, total indices Jansen's; both only need the N(d + 2)
+     * evaluations, which run in parallel. Every point of a row shares its seeds, so the demand
+     * stream is the same across A, B and each AB_i and the differences the estimators take are
+     * mostly due to the parameters rather than simulation noise. Bootstrap intervals resample
+     * rows with a fixed seed, so a result is reproducible from its options.
+     */
+    class SensitivityAnalysis
+    {
+    public:
+        // Outputs of one design point, one value per output name, from a simulation with `seed`
+        using Evaluator = std::function<std::vector<double>(const std::vector<double> &point, unsigned seed)>;
+
+        SensitivityAnalysis(std::vector<SensitivityParameter> parameters, QStringList outputs, Evaluator evaluator,
+                            SensitivityOptions options = {});
+
+        SensitivityResult analyze() const;
+
+        // Parses "average_lead_time:3:10,average_demand:40:60" (name:lower:upper)
+        static std::vector<SensitivityParameter> parse_parameters(const QString &spec);
+
+    private:
+        std::vector<SensitivityParameter> m_parameters;
+        QStringList m_outputs;
+        Evaluator m_evaluator;
+        SensitivityOptions m_options;
+    };
+
+} // namespace qz
+
+#endif // CHAINSIM_SENSITIVITYANALYSIS_H
@@ -0,0 +1,411 @@
+// HTTP load generator for ChainSimServer.
+//
+// Drives POST /simulate with a configurable number of concurrent connections and a mix of
+// policies, demand distributions and horizons, then prints throughput and latency percentiles
+// as JSON so runs can be compared across commits:
+//
+//   chainsim_loadgen --in_process --connections 32 --duration 20 --horizons 30,365,3650
+//   chainsim_loadgen --host 10.0.0.5 --port 47761 --requests 50000 --policies ROP:2,EOQ:1
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUrlQuery>
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "ChainSimServerPool.h"
+
+namespace
+{
+
+    struct LoadConfig
+    {
+        QString host{"127.0.0.1"};
+        quint16 port{47761};
+        int connections{8};
+        qint64 total_requests{0}; // 0: run for `duration_seconds`
+        double duration_seconds{10.0};
+        double warmup_seconds{1.0};
+        bool keep_alive{true};
+        QStringList targets;
+    };
+
+    // Builds the request targets of the mix once, so the hot loop only writes bytes
+    QStringList build_request_mix(const QCommandLineParser &parser)
+    {
+        QList<QPair<QString, int>> policies;
+        for (const auto &entry : parser.value("policies").split(',', Qt::SkipEmptyParts))
+        {
+            auto parts = entry.split(':');
+            policies.append({parts[0], parts.size() > 1 ? parts[1].toInt() : 1});
+        }
+        QStringList distributions = parser.value("distributions").split(',', Qt::SkipEmptyParts);
+        QStringList horizons = parser.value("horizons").split(',', Qt::SkipEmptyParts);
+
+        std::mt19937 generator(parser.value("seed").toUInt());
+        QStringList targets;
+        int variants = parser.value("variants").toInt();
+
+        for (const auto &[policy, weight] : policies)
+        {
+            for (int w = 0; w < weight; ++w)
+            {
+                for (const auto &distribution : distributions)
+                {
+                    for (const auto &horizon : horizons)
+                    {
+                        for (int v = 0; v < variants; ++v)
+                        {
+                            QUrlQuery query;
+                            query.addQueryItem("simulation_length", horizon);
+                            query.addQueryItem("average_lead_time", "5");
+                            query.addQueryItem("average_demand", "50");
+                            query.addQueryItem("std_demand", "10");
+                            query.addQueryItem("starting_inventory", "100");
+                            query.addQueryItem("log_level", "0");
+                            query.addQueryItem("seed", QString::number(generator()));
+                            query.addQueryItem("policy", policy);
+                            query.addQueryItem("demand_distribution", distribution);
+                            query.addQueryItem("ordering_cost", "100");
+                            query.addQueryItem("holding_cost", "0.2");
+                            query.addQueryItem("purchase_period", "7");
+                            query.addQueryItem("gamma_shape", "2");
+                            query.addQueryItem("gamma_scale", "25");
+                            query.addQueryItem("uniform_min", "20");
+                            query.addQueryItem("uniform_max", "80");
+                            targets.append("/simulate?" + query.toString(QUrl::FullyEncoded));
+                        }
+                    }
+                }
+            }
+        }
+
+        std::shuffle(targets.begin(), targets.end(), generator);
+        return targets;
+    }
+
+    /* One client connection: sends a request, waits for the complete response, records the
+     * latency and immediately sends the next one (closed loop).
+     */
+    class LoadClient : public QObject
+    {
+    public:
+        LoadClient(const LoadConfig &config, int index, QObject *parent = nullptr)
+            : QObject(parent), m_config{config}, m_next_target{index}
+        {
+            connect(&m_socket, &QTcpSocket::connected, this, [this]()
+                    { sendRequest(); });
+            connect(&m_socket, &QTcpSocket::readyRead, this, [this]()
+                    { onReadyRead(); });
+            connect(&m_socket, &QTcpSocket::errorOccurred, this, [this](QAbstractSocket::SocketError error)
+                    {
+                        // An idle connection closed by the server is simply reopened on the next request
+                        if (!m_in_flight && error == QAbstractSocket::RemoteHostClosedError)
+                            return;
+                        if (m_in_flight)
+                        {
+                            ++m_errors;
+                            m_in_flight = false;
+                        }
+                        QTimer::singleShot(10, this, [this]() { reconnect(); }); });
+        }
+
+        void start(QElapsedTimer *clock, qint64 warmup_end_ns, qint64 *remaining_requests)
+        {
+            m_clock = clock;
+            m_warmup_end_ns = warmup_end_ns;
+            m_remaining_requests = remaining_requests;
+            reconnect();
+        }
+
+        void stop()
+        {
+            m_stopped = true;
+            m_socket.abort();
+        }
+
+        [[nodiscard]] const std::vector<qint64> &latencies() const { return m_latencies_ns; }
+        [[nodiscard]] const QMap<int, qint64> &statuses() const { return m_statuses; }
+        [[nodiscard]] qint64 errors() const { return m_errors; }
+
+    private:
+        void reconnect()
+        {
+            if (m_stopped)
+                return;
+            m_socket.abort();
+            m_buffer.clear();
+            m_socket.connectToHost(m_config.host, m_config.port);
+        }
+
+        void sendRequest()
+        {
+            if (m_stopped)
+                return;
+            if (*m_remaining_requests == 0)
+            {
+                m_stopped = true;
+                return;
+            }
+            if (*m_remaining_requests > 0)
+                --*m_remaining_requests;
+
+            const QString &target = m_config.targets[m_next_target % m_config.targets.size()];
+            m_next_target += m_config.connections;
+
+            QByteArray request = "POST " + target.toLatin1() + " HTTP/1.1\r\n" +
+                                 "Host: " + m_config.host.toLatin1() + "\r\n" +
+                                 "Content-Length: 0\r\n" +
+                                 (m_config.keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n") +
+                                 "\r\n";
+            m_in_flight = true;
+            m_sent_ns = m_clock->nsecsElapsed();
+            m_socket.write(request);
+        }
+
+        void onReadyRead()
+        {
+            m_buffer += m_socket.readAll();
+
+            auto header_end = m_buffer.indexOf("\r\n\r\n");
+            if (header_end < 0)
+                return;
+
+            QByteArray headers = m_buffer.left(header_end).toLower();
+            qint64 content_length = 0;
+            auto pos = headers.indexOf("content-length:");
+            if (pos >= 0)
+            {
+                auto line_end = headers.indexOf("\r\n", pos);
+                content_length = headers.mid(pos + 15, line_end < 0 ? -1 : line_end - pos - 15).trimmed().toLongLong();
+            }
+
+            qint64 response_size = header_end + 4 + content_length;
+            if (m_buffer.size() < response_size)
+                return;
+
+            // Status line: HTTP/1.1 200 OK
+            int status = headers.mid(9, 3).toInt();
+            m_buffer.remove(0, response_size);
+            m_in_flight = false;
+
+            qint64 now = m_clock->nsecsElapsed();
+            if (m_sent_ns >= m_warmup_end_ns)
+            {
+                m_latencies_ns.push_back(now - m_sent_ns);
+                m_statuses[status]++;
+            }
+
+            if (m_config.keep_alive)
+                sendRequest();
+            else
+                reconnect();
+        }
+
+        const LoadConfig &m_config;
+        QTcpSocket m_socket;
+        QByteArray m_buffer;
+        int m_next_target;
+        QElapsedTimer *m_clock{nullptr};
+        qint64 m_warmup_end_ns{0};
+        qint64 *m_remaining_requests{nullptr};
+        qint64 m_sent_ns{0};
+        bool m_in_flight{false};
+        bool m_stopped{false};
+        qint64 m_errors{0};
+        std::vector<qint64> m_latencies_ns;
+        QMap<int, qint64> m_statuses;
+    };
+
+    double percentile_ms(const std::vector<qint64> &sorted, double q)
+    {
+        if (sorted.empty())
+            return 0.0;
+        auto rank = static_cast<std::size_t>(q * static_cast<double>(sorted.size() - 1));
+        return static_cast<double>(sorted[rank]) / 1e6;
+    }
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("chainsim_loadgen");
+    QCoreApplication::setApplicationVersion("0.2");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("ChainSim - HTTP load generator for /simulate");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"host", "Server host", "host", "127.0.0.1"},
+        {"port", "Server port", "port", "47761"},
+        {"in_process", "Start a ChainSimServer in this process on an ephemeral port"},
+        {"server_threads", "Worker threads of the in-process server (0 = one per core)", "threads", "1"},
+        {"connections", "Concurrent connections (requests in flight)", "count", "8"},
+        {"requests", "Total requests to send (overrides --duration)", "count", "0"},
+        {"duration", "Measured duration in seconds", "seconds", "10"},
+        {"warmup", "Warm-up seconds excluded from the results", "seconds", "1"},
+        {"no_keep_alive", "Open a new connection for every request"},
+        {"policies", "Weighted policy mix, e.g. ROP:2,EOQ:1,TPOP:1", "mix", "ROP:1,EOQ:1,TPOP:1"},
+        {"distributions", "Demand distributions to cycle through", "list", "normal,poisson"},
+        {"horizons", "Simulation lengths to cycle through", "list", "30,365"},
+        {"variants", "Distinct seeds per policy/distribution/horizon combination", "count", "4"},
+        {"seed", "Seed for building the request mix", "seed", "7"},
+        {"output", "Write the JSON report to this file instead of stdout", "file"},
+    });
+    parser.process(app);
+
+    LoadConfig config;
+    config.host = parser.value("host");
+    config.port = parser.value("port").toUShort();
+    config.connections = qMax(1, parser.value("connections").toInt());
+    config.total_requests = parser.value("requests").toLongLong();
+    config.duration_seconds = parser.value("duration").toDouble();
+    config.warmup_seconds = config.total_requests > 0 ? 0.0 : parser.value("warmup").toDouble();
+    config.keep_alive = !parser.isSet("no_keep_alive");
+    config.targets = build_request_mix(parser);
+
+    if (config.targets.isEmpty())
+    {
+        qCritical() << "Error: empty request mix";
+        return 1;
+    }
+
+    // The in-process server runs on its own worker threads and event loops, like a real deployment
+    qz::ChainSimServerPool serverPool;
+    if (parser.isSet("in_process"))
+    {
+        // Keep per-request server logging out of the measurement
+        qInstallMessageHandler([](QtMsgType type, const QMessageLogContext &, const QString &message)
+                               {
+                                   if (type != QtInfoMsg && type != QtDebugMsg)
+                                       fprintf(stderr, "%s\n", qPrintable(message)); });
+
+        if (!serverPool.start(0, parser.value("server_threads").toInt()))
+        {
+            return 1;
+        }
+        config.host = "127.0.0.1";
+        config.port = serverPool.port();
+    }
+
+    std::vector<std::unique_ptr<LoadClient>> clients;
+    for (int i = 0; i < config.connections; ++i)
+    {
+        clients.push_back(std::make_unique<LoadClient>(config, i));
+    }
+
+    QElapsedTimer clock;
+    clock.start();
+    auto warmup_end_ns = static_cast<qint64>(config.warmup_seconds * 1e9);
+    qint64 remaining_requests = config.total_requests > 0 ? config.total_requests : -1;
+
+    for (auto &client : clients)
+    {
+        client->start(&clock, warmup_end_ns, &remaining_requests);
+    }
+
+    QTimer poll;
+    QObject::connect(&poll, &QTimer::timeout, [&]()
+                     {
+                         bool done = false;
+                         if (config.total_requests > 0)
+                         {
+                             qint64 outstanding = 0;
+                             for (const auto &client : clients)
+                                 outstanding += client->latencies().size() + client->errors();
+                             done = outstanding >= config.total_requests;
+                         }
+                         else
+                         {
+                             done = clock.nsecsElapsed() >= warmup_end_ns + static_cast<qint64>(config.duration_seconds * 1e9);
+                         }
+                         if (done)
+                             app.quit(); });
+    poll.start(5);
+
+    app.exec();
+    double measured_seconds = static_cast<double>(clock.nsecsElapsed() - warmup_end_ns) / 1e9;
+
+    for (auto &client : clients)
+    {
+        client->stop();
+    }
+
+    // Merge per-connection samples
+    std::vector<qint64> latencies;
+    QMap<int, qint64> statuses;
+    qint64 errors = 0;
+    for (const auto &client : clients)
+    {
+        latencies.insert(latencies.end(), client->latencies().begin(), client->latencies().end());
+        for (auto it = client->statuses().begin(); it != client->statuses().end(); ++it)
+            statuses[it.key()] += it.value();
+        errors += client->errors();
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    double sum_ms = 0.0;
+    for (auto ns : latencies)
+        sum_ms += static_cast<double>(ns) / 1e6;
+
+    QJsonObject status_counts;
+    for (auto it = statuses.begin(); it != statuses.end(); ++it)
+        status_counts[QString::number(it.key())] = it.value();
+
+    QJsonObject report{
+        {"config", QJsonObject{
+                       {"host", config.host},
+                       {"port", config.port},
+                       {"in_process", parser.isSet("in_process")},
+                       {"server_threads", parser.isSet("in_process") ? serverPool.workerCount() : 0},
+                       {"connections", config.connections},
+                       {"keep_alive", config.keep_alive},
+                       {"policies", parser.value("policies")},
+                       {"distributions", parser.value("distributions")},
+                       {"horizons", parser.value("horizons")},
+                       {"distinct_requests", config.targets.size()}}},
+        {"requests", static_cast<qint64>(latencies.size())},
+        {"errors", errors},
+        {"status_counts", status_counts},
+        {"duration_seconds", measured_seconds},
+        {"throughput_rps", measured_seconds > 0 ? static_cast<double>(latencies.size()) / measured_seconds : 0.0},
+        {"latency_ms", QJsonObject{
+                           {"mean", latencies.empty() ? 0.0 : sum_ms / static_cast<double>(latencies.size())},
+                           {"p50", percentile_ms(latencies, 0.50)},
+                           {"p95", percentile_ms(latencies, 0.95)},
+                           {"p99", percentile_ms(latencies, 0.99)},
+                           {"p999", percentile_ms(latencies, 0.999)},
+                           {"max", latencies.empty() ? 0.0 : static_cast<double>(latencies.back()) / 1e6}}}};
+
+    QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    if (parser.isSet("output"))
+    {
+        QFile file(parser.value("output"));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        {
+            qCritical() << "Error: could not open output file" << parser.value("output");
+            return 1;
+        }
+        file.write(json);
+    }
+    else
+    {
+        fprintf(stdout, "%s", json.constData());
+    }
+
+    serverPool.stop();
+
+    return 0;
+}
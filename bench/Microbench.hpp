@@ -0,0 +1,338 @@
+#ifndef CHAINSIM_MICROBENCH_HPP
+#define CHAINSIM_MICROBENCH_HPP
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <regex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace qz::bench
+{
+
+    // Keeps the compiler from discarding a value only a benchmark reads
+    template <typename T>
+    inline void do_not_optimize(const T &value)
+    {
+#if defined(__GNUC__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const void *sink;
+        sink = &value;
+#endif
+    }
+
+    /* Hardware counters of the calling thread, read with perf_event_open as one group.
+     *
+     * Counting needs kernel.perf_event_paranoid <= 2 (or CAP_PERFMON) and a PMU the kernel
+     * exposes, which VMs and containers often do not; open() then returns false and benchmarks
+     * run without counters. Counters that open are reported, the rest are left out.
+     */
+    class PerfCounters
+    {
+    public:
+        static constexpr std::size_t kCount = 3;
+        static constexpr std::array<const char *, kCount> kNames{"cycles", "cache_misses", "branch_misses"};
+
+        PerfCounters() { m_fds.fill(-1); }
+        PerfCounters(const PerfCounters &) = delete;
+        PerfCounters &operator=(const PerfCounters &) = delete;
+        ~PerfCounters() { close(); }
+
+        bool open()
+        {
+#if defined(__linux__)
+            static constexpr std::array<std::uint64_t, kCount> kConfigs{
+                PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+            for (std::size_t i = 0; i < kCount; ++i)
+            {
+                perf_event_attr attr{};
+                attr.size = sizeof(attr);
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = kConfigs[i];
+                attr.disabled = m_leader < 0 ? 1 : 0; // Members follow the leader
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_GROUP;
+                auto fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, m_leader, 0));
+                if (fd < 0)
+                    continue;
+                m_fds[i] = fd;
+                if (m_leader < 0)
+                    m_leader = fd;
+                m_order.push_back(i);
+            }
+#endif
+            return available();
+        }
+
+        [[nodiscard]] bool available() const { return m_leader >= 0; }
+        [[nodiscard]] bool has(std::size_t counter) const { return m_fds[counter] >= 0; }
+
+#if defined(__linux__)
+        void reset() { control(PERF_EVENT_IOC_RESET); }
+        void enable() { control(PERF_EVENT_IOC_ENABLE); }
+        void disable() { control(PERF_EVENT_IOC_DISABLE); }
+#else
+        void reset() {}
+        void enable() {}
+        void disable() {}
+#endif
+
+        // Counts since the last reset, indexed like kNames; counters that did not open read 0
+        [[nodiscard]] std::array<std::uint64_t, kCount> read() const
+        {
+            std::array<std::uint64_t, kCount> values{};
+#if defined(__linux__)
+            if (!available())
+                return values;
+            std::array<std::uint64_t, kCount + 1> group{}; // nr, then one value per member
+            if (::read(m_leader, group.data(), sizeof(group)) <= 0)
+                return values;
+            for (std::size_t i = 0; i < m_order.size() && i < group[0]; ++i)
+                values[m_order[i]] = group[i + 1];
+#endif
+            return values;
+        }
+
+    private:
+#if defined(__linux__)
+        void control(unsigned long request)
+        {
+            if (available())
+                ioctl(m_leader, request, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+
+        void close()
+        {
+#if defined(__linux__)
+            for (auto fd : m_fds)
+            {
+                if (fd >= 0)
+                    ::close(fd);
+            }
+#endif
+            m_fds.fill(-1);
+            m_leader = -1;
+            m_order.clear();
+        }
+
+        std::array<int, kCount> m_fds{};
+        int m_leader{-1};
+        std::vector<std::size_t> m_order; // Counter of each group member, in the kernel's read order
+    };
+
+    /* Iteration state handed to a benchmark.
+     *
+     * Only the `while (state.keep_running())` loop is timed: the clocks and counters start on its
+     * first check and stop on its last, so setup before the loop is free. Work inside an
+     * iteration that should not count goes between pause_timing() and resume_timing().
+     */
+    class State
+    {
+    public:
+        State(std::uint64_t iterations, PerfCounters *counters)
+            : m_iterations(iterations), m_remaining(iterations), m_counters(counters)
+        {
+        }
+
+        bool keep_running()
+        {
+            if (!m_started)
+            {
+                m_started = true;
+                if (m_counters)
+                    m_counters->reset();
+                resume_timing();
+            }
+            if (m_remaining > 0)
+            {
+                --m_remaining;
+                return true;
+            }
+            pause_timing();
+            return false;
+        }
+
+        void pause_timing()
+        {
+            if (!m_running)
+                return;
+            if (m_counters)
+                m_counters->disable();
+            m_real += std::chrono::steady_clock::now() - m_real_start;
+            m_cpu_ns += thread_cpu_ns() - m_cpu_start;
+            m_running = false;
+        }
+
+        void resume_timing()
+        {
+            if (m_running)
+                return;
+            m_running = true;
+            m_cpu_start = thread_cpu_ns();
+            m_real_start = std::chrono::steady_clock::now();
+            if (m_counters)
+                m_counters->enable();
+        }
+
+        [[nodiscard]] std::uint64_t iterations() const { return m_iterations; }
+
+        // Per-iteration work, reported as rates
+        void set_items_processed(std::uint64_t items) { m_items = items; }
+        void set_bytes_processed(std::uint64_t bytes) { m_bytes = bytes; }
+
+        [[nodiscard]] double real_seconds() const { return std::chrono::duration<double>(m_real).count(); }
+        [[nodiscard]] double cpu_seconds() const { return static_cast<double>(m_cpu_ns) / 1e9; }
+        [[nodiscard]] std::uint64_t items_processed() const { return m_items; }
+        [[nodiscard]] std::uint64_t bytes_processed() const { return m_bytes; }
+
+    private:
+        static std::int64_t thread_cpu_ns()
+        {
+#if defined(CLOCK_THREAD_CPUTIME_ID)
+            timespec ts{};
+            clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+            return static_cast<std::int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#else
+            return static_cast<std::int64_t>(std::clock()) * (1000000000 / CLOCKS_PER_SEC);
+#endif
+        }
+
+        std::uint64_t m_iterations;
+        std::uint64_t m_remaining;
+        PerfCounters *m_counters;
+        bool m_started{false};
+        bool m_running{false};
+        std::chrono::steady_clock::time_point m_real_start{};
+        std::chrono::steady_clock::duration m_real{};
+        std::int64_t m_cpu_start{0};
+        std::int64_t m_cpu_ns{0};
+        std::uint64_t m_items{0};
+        std::uint64_t m_bytes{0};
+    };
+
+    struct BenchmarkOptions
+    {
+        std::string filter{".*"}; // ECMAScript regex matched against benchmark names
+        double min_time{0.5};     // Seconds a measured run must last
+    };
+
+    struct BenchmarkResult
+    {
+        std::string name;
+        std::uint64_t iterations{0};
+        double real_ns{0.0}; // Per iteration
+        double cpu_ns{0.0};
+        double items_per_second{0.0};
+        double bytes_per_second{0.0};
+        std::map<std::string, double> counters; // Hardware counters per iteration
+    };
+
+    /* A named set of benchmarks, run with iteration counts grown until one run lasts min_time.
+     *
+     * The growth step follows Google Benchmark: predict the count that reaches min_time from
+     * the last run, overshoot by 40% and never grow more than tenfold at once, so a benchmark
+     * whose first iterations are unrepresentative (cold caches) is not extrapolated too far.
+     */
+    class Benchmarks
+    {
+    public:
+        using Function = std::function<void(State &)>;
+
+        void add(std::string name, Function function)
+        {
+            m_benchmarks.push_back({std::move(name), std::move(function)});
+        }
+
+        [[nodiscard]] std::vector<std::string> names() const
+        {
+            std::vector<std::string> names;
+            for (const auto &benchmark : m_benchmarks)
+                names.push_back(benchmark.first);
+            return names;
+        }
+
+        // Runs the matching benchmarks in registration order, counting with `counters` if not null;
+        // `progress` sees each result as it lands
+        std::vector<BenchmarkResult> run(const BenchmarkOptions &options, PerfCounters *counters,
+                                         const std::function<void(const BenchmarkResult &)> &progress = {}) const
+        {
+            const std::regex filter(options.filter);
+            std::vector<BenchmarkResult> results;
+            for (const auto &[name, function] : m_benchmarks)
+            {
+                if (!std::regex_search(name, filter))
+                    continue;
+
+                std::uint64_t iterations = 1;
+                for (;;)
+                {
+                    State state(iterations, counters);
+                    function(state);
+                    double elapsed = state.real_seconds();
+                    if (elapsed >= options.min_time || iterations >= kMaxIterations)
+                    {
+                        results.push_back(summarize(name, state, counters));
+                        break;
+                    }
+
+                    double multiplier = elapsed > 0.0 ? options.min_time * 1.4 / elapsed : 10.0;
+                    multiplier = std::clamp(multiplier, 2.0, 10.0);
+                    iterations = std::min(kMaxIterations,
+                                          static_cast<std::uint64_t>(static_cast<double>(iterations) * multiplier));
+                }
+                if (progress)
+                    progress(results.back());
+            }
+            return results;
+        }
+
+    private:
+        static constexpr std::uint64_t kMaxIterations = 1'000'000'000;
+
+        static BenchmarkResult summarize(const std::string &name, const State &state, const PerfCounters *counters)
+        {
+            auto iterations = static_cast<double>(state.iterations());
+            BenchmarkResult result;
+            result.name = name;
+            result.iterations = state.iterations();
+            result.real_ns = state.real_seconds() * 1e9 / iterations;
+            result.cpu_ns = state.cpu_seconds() * 1e9 / iterations;
+            if (state.real_seconds() > 0.0)
+            {
+                result.items_per_second = static_cast<double>(state.items_processed()) * iterations / state.real_seconds();
+                result.bytes_per_second = static_cast<double>(state.bytes_processed()) * iterations / state.real_seconds();
+            }
+            if (counters && counters->available())
+            {
+                auto values = counters->read();
+                for (std::size_t i = 0; i < PerfCounters::kCount; ++i)
+                {
+                    if (counters->has(i))
+                        result.counters[PerfCounters::kNames[i]] = static_cast<double>(values[i]) / iterations;
+                }
+            }
+            return result;
+        }
+
+        std::vector<std::pair<std::string, Function>> m_benchmarks;
+    };
+
+} // namespace qz::bench
+
+#endif // CHAINSIM_MICROBENCH_HPP
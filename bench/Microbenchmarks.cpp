@@ -0,0 +1,439 @@
+// Microbenchmarks for the hot paths of ChainSim.
+//
+// Covers a full ChainSim::simulate across horizons and logging levels, engine setup with and
+// without ChainSimPool, one get_purchase of each policy, one draw of each DemandSampler, and the
+// JSON, CSV and binary-protocol exports and the windowed aggregates of a run's records. Each
+// benchmark is repeated until a run lasts --min_time seconds; results are printed as they land
+// and written as Google Benchmark style JSON so runs can be compared across commits:
+//
+//   chainsim_bench --filter 'simulate/.*/log:0' --output before.json
+//   chainsim_bench --perf_counters --min_time 1
+
+#include <QBuffer>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <QUrlQuery>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <regex>
+#include <thread>
+#include <vector>
+
+#include "ChainSimBuilder.h"
+#include "ChainSimPool.h"
+#include "ChainSimServer.h"
+#include "bench/Microbench.hpp"
+#include "purchase_policies/PurchaseEOQ.h"
+#include "purchase_policies/PurchaseROP.h"
+#include "purchase_policies/PurchaseTPOP.h"
+#include "utils/DemandSampler.hpp"
+#include "utils/WireProtocol.hpp"
+
+namespace
+{
+
+    using qz::bench::Benchmarks;
+    using qz::bench::State;
+
+    constexpr quint32 kLeadTime = 5;
+    constexpr double kAverageDemand = 50.0;
+    const quint64 kHorizons[] = {365, 3650, 36500};
+
+    std::unique_ptr<qz::ChainSim> make_simulation(quint64 days, quint32 log_level, bool record_history = true)
+    {
+        return qz::ChainSimBuilder()
+            .setSimulationName("bench")
+            .setSimulationLength(days)
+            .setLeadTime(kLeadTime)
+            .setAverageDemand(kAverageDemand)
+            .setDemandStdDev(10.0)
+            .setSeed(42)
+            .setStartingInventory(500)
+            .setLoggingLevel(log_level)
+            .setRecordHistory(record_history)
+            .create();
+    }
+
+    void add_simulation_benchmarks(Benchmarks &benchmarks)
+    {
+        for (auto days : kHorizons)
+        {
+            for (quint32 log_level : {0u, 1u})
+            {
+                benchmarks.add("simulate/ROP/days:" + std::to_string(days) + "/log:" + std::to_string(log_level),
+                               [days, log_level](State &state)
+                               {
+                                   auto simulation = make_simulation(days, log_level);
+                                   PurchaseROP policy(kLeadTime, kAverageDemand);
+                                   while (state.keep_running())
+                                   {
+                                       simulation->initialize_simulation();
+                                       simulation->simulate(policy);
+                                   }
+                                   state.set_items_processed(days);
+                               });
+            }
+
+            // Summary-only runs, as replications and optimizers make them
+            benchmarks.add("simulate_summary/ROP/days:" + std::to_string(days),
+                           [days](State &state)
+                           {
+                               auto simulation = make_simulation(days, 0, false);
+                               PurchaseROP policy(kLeadTime, kAverageDemand);
+                               while (state.keep_running())
+                               {
+                                   simulation->initialize_simulation();
+                                   simulation->simulate(policy);
+                                   qz::bench::do_not_optimize(simulation->get_kpis());
+                               }
+                               state.set_items_processed(days);
+                           });
+        }
+    }
+
+    // Setup plus run of the short scenarios /simulate serves most: a new engine per run versus a pooled one
+    void add_setup_benchmarks(Benchmarks &benchmarks)
+    {
+        for (quint64 days : {30, 365})
+        {
+            auto config = [days](unsigned seed)
+            {
+                qz::ChainSimBuilder builder;
+                builder.setSimulationName("bench")
+                    .setSimulationLength(days)
+                    .setLeadTime(kLeadTime)
+                    .setAverageDemand(kAverageDemand)
+                    .setDemandStdDev(10.0)
+                    .setSeed(seed)
+                    .setStartingInventory(500);
+                return builder.config();
+            };
+
+            benchmarks.add("setup/builder/days:" + std::to_string(days),
+                           [days, config](State &state)
+                           {
+                               PurchaseROP policy(kLeadTime, kAverageDemand);
+                               unsigned seed = 0;
+                               while (state.keep_running())
+                               {
+                                   auto simulation = qz::ChainSimBuilder().setConfig(config(++seed)).create();
+                                   simulation->initialize_simulation();
+                                   simulation->simulate(policy);
+                                   qz::bench::do_not_optimize(simulation->get_kpis());
+                               }
+                               state.set_items_processed(days);
+                           });
+
+            benchmarks.add("setup/pool/days:" + std::to_string(days),
+                           [days, config](State &state)
+                           {
+                               PurchaseROP policy(kLeadTime, kAverageDemand);
+                               qz::ChainSimPool pool;
+                               unsigned seed = 0;
+                               while (state.keep_running())
+                               {
+                                   auto simulation = pool.acquire(config(++seed));
+                                   simulation->initialize_simulation();
+                                   simulation->simulate(policy);
+                                   qz::bench::do_not_optimize(simulation->get_kpis());
+                               }
+                               state.set_items_processed(days);
+                           });
+        }
+    }
+
+    void add_policy_benchmarks(Benchmarks &benchmarks)
+    {
+        using PolicyFactory = std::function<std::unique_ptr<PurchasePolicy>()>;
+        const std::pair<const char *, PolicyFactory> policies[] = {
+            {"ROP", []
+             { return std::make_unique<PurchaseROP>(kLeadTime, kAverageDemand); }},
+            {"EOQ", []
+             { return std::make_unique<PurchaseEOQ>(kLeadTime, kAverageDemand, 100.0, 0.2); }},
+            {"TPOP", []
+             { return std::make_unique<PurchaseTPOP>(kLeadTime, kAverageDemand, 7); }},
+        };
+
+        for (const auto &[name, factory] : policies)
+        {
+            benchmarks.add(std::string("get_purchase/") + name, [factory = factory](State &state)
+                           {
+                               // Positions on both sides of the reorder point, so branches are not all predicted
+                               std::mt19937 generator(7);
+                               std::uniform_int_distribution<qint64> on_hand(0, 600), pipeline(0, 300);
+                               std::vector<InventoryPosition> positions(4096);
+                               for (std::size_t i = 0; i < positions.size(); ++i)
+                                   positions[i] = {i, on_hand(generator), pipeline(generator)};
+
+                               auto policy = factory();
+                               std::size_t i = 0;
+                               while (state.keep_running())
+                               {
+                                   qz::bench::do_not_optimize(policy->get_purchase(positions[i]));
+                                   i = (i + 1) & (positions.size() - 1);
+                               } });
+        }
+    }
+
+    void add_demand_benchmarks(Benchmarks &benchmarks)
+    {
+        using SamplerFactory = std::function<std::unique_ptr<qz::DemandSampler>()>;
+        const std::pair<const char *, SamplerFactory> samplers[] = {
+            {"fixed", []
+             { return std::make_unique<qz::FixedDemandSampler>(kAverageDemand); }},
+            {"normal", []
+             { return std::make_unique<qz::NormalDemandSampler>(kAverageDemand, 10.0, 42); }},
+            {"gamma", []
+             { return std::make_unique<qz::GammaDemandSampler>(25.0, 2.0, 42); }},
+            {"poisson", []
+             { return std::make_unique<qz::PoissonDemandSampler>(kAverageDemand, 42); }},
+            {"uniform", []
+             { return std::make_unique<qz::UniformDemandSampler>(30.0, 70.0, 42); }},
+        };
+
+        for (const auto &[name, factory] : samplers)
+        {
+            benchmarks.add(std::string("demand/") + name, [factory = factory](State &state)
+                           {
+                               auto sampler = factory();
+                               while (state.keep_running())
+                                   qz::bench::do_not_optimize(sampler->sample()); });
+        }
+    }
+
+    void add_export_benchmarks(Benchmarks &benchmarks)
+    {
+        for (auto days : kHorizons)
+        {
+            auto suffix = "/days:" + std::to_string(days);
+
+            benchmarks.add("records_json" + suffix, [days](State &state)
+                           {
+                               auto simulation = make_simulation(days, 0);
+                               PurchaseROP policy(kLeadTime, kAverageDemand);
+                               simulation->initialize_simulation();
+                               simulation->simulate(policy);
+                               auto records = simulation->get_simulation_records();
+                               qsizetype bytes = 0;
+                               while (state.keep_running())
+                               {
+                                   auto json = QJsonDocument(qz::ChainSimServer::simulationRecordsToJson(records))
+                                                   .toJson(QJsonDocument::Compact);
+                                   bytes = json.size();
+                                   qz::bench::do_not_optimize(json);
+                               }
+                               state.set_bytes_processed(static_cast<std::uint64_t>(bytes)); });
+
+            benchmarks.add("records_json_bytes" + suffix, [days](State &state)
+                           {
+                               auto simulation = make_simulation(days, 0);
+                               PurchaseROP policy(kLeadTime, kAverageDemand);
+                               simulation->initialize_simulation();
+                               simulation->simulate(policy);
+                               auto records = simulation->get_simulation_records();
+                               qsizetype bytes = 0;
+                               while (state.keep_running())
+                               {
+                                   auto json = qz::ChainSimServer::simulationRecordsToJsonBytes(records);
+                                   bytes = json.size();
+                                   qz::bench::do_not_optimize(json);
+                               }
+                               state.set_bytes_processed(static_cast<std::uint64_t>(bytes)); });
+
+            benchmarks.add("records_aggregate" + suffix, [days](State &state)
+                           {
+                               auto simulation = make_simulation(days, 0);
+                               PurchaseROP policy(kLeadTime, kAverageDemand);
+                               simulation->initialize_simulation();
+                               simulation->simulate(policy);
+                               auto records = simulation->get_simulation_records();
+                               QUrlQuery query; // The default aggregates
+                               while (state.keep_running())
+                                   qz::bench::do_not_optimize(qz::ChainSimServer::aggregateRecords(records, query));
+                               state.set_items_processed(days); });
+
+            // The Result frame the binary protocol sends for the same records
+            benchmarks.add("records_binary" + suffix, [days](State &state)
+                           {
+                               auto simulation = make_simulation(days, 0);
+                               PurchaseROP policy(kLeadTime, kAverageDemand);
+                               simulation->initialize_simulation();
+                               simulation->simulate(policy);
+                               auto records = simulation->get_simulation_records();
+                               auto kpis = simulation->get_kpis();
+                               std::string out;
+                               while (state.keep_running())
+                               {
+                                   out.clear();
+                                   qz::wire::Writer writer(out);
+                                   qz::wire::begin_result(writer, 1, kpis, static_cast<std::uint16_t>(records.size()));
+                                   for (auto column = records.cbegin(); column != records.cend(); ++column)
+                                   {
+                                       auto name = column.key().toUtf8();
+                                       qz::wire::write_column(writer, std::string_view(name.constData(), name.size()),
+                                                              column.value().constData(),
+                                                              static_cast<std::uint32_t>(column.value().size()));
+                                   }
+                                   writer.end_frame();
+                                   qz::bench::do_not_optimize(out);
+                               }
+                               state.set_bytes_processed(out.size()); });
+
+            benchmarks.add("records_csv" + suffix, [days](State &state)
+                           {
+                               auto simulation = make_simulation(days, 0);
+                               PurchaseROP policy(kLeadTime, kAverageDemand);
+                               simulation->initialize_simulation();
+                               simulation->simulate(policy);
+                               auto records = simulation->get_simulation_records();
+
+                               // An in-memory device, so the benchmark measures formatting rather than the disk
+                               QBuffer buffer;
+                               buffer.open(QIODevice::WriteOnly);
+                               while (state.keep_running())
+                               {
+                                   buffer.seek(0);
+                                   qz::ChainSimServer::writeRecordsCsv(records, buffer);
+                               }
+                               state.set_bytes_processed(static_cast<std::uint64_t>(buffer.size())); });
+        }
+    }
+
+    QJsonObject result_to_json(const qz::bench::BenchmarkResult &result)
+    {
+        QJsonObject json{
+            {"name", QString::fromStdString(result.name)},
+            {"run_type", "iteration"},
+            {"iterations", static_cast<qint64>(result.iterations)},
+            {"real_time", result.real_ns},
+            {"cpu_time", result.cpu_ns},
+            {"time_unit", "ns"}};
+        if (result.items_per_second > 0.0)
+            json["items_per_second"] = result.items_per_second;
+        if (result.bytes_per_second > 0.0)
+            json["bytes_per_second"] = result.bytes_per_second;
+        for (const auto &[counter, value] : result.counters)
+            json[QString::fromStdString(counter)] = value;
+        return json;
+    }
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("chainsim_bench");
+    QCoreApplication::setApplicationVersion("0.1");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("ChainSim - microbenchmarks of the simulation hot paths");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"filter", "Only run benchmarks whose name matches this regex", "regex", ".*"},
+        {"min_time", "Seconds each measured run must last", "seconds", "0.5"},
+        {"perf_counters", "Report cycles, cache and branch misses per iteration (Linux perf_event_open)"},
+        {"list", "List the benchmark names and exit"},
+        {"output", "Write the JSON report to this file instead of stdout", "file"},
+    });
+    parser.process(app);
+
+    // Level-1 runs format their log lines, but printing them would measure the terminal
+    qInstallMessageHandler([](QtMsgType type, const QMessageLogContext &, const QString &message)
+                           {
+                               if (type != QtInfoMsg && type != QtDebugMsg)
+                                   fprintf(stderr, "%s\n", qPrintable(message)); });
+
+    Benchmarks benchmarks;
+    add_simulation_benchmarks(benchmarks);
+    add_setup_benchmarks(benchmarks);
+    add_policy_benchmarks(benchmarks);
+    add_demand_benchmarks(benchmarks);
+    add_export_benchmarks(benchmarks);
+
+    if (parser.isSet("list"))
+    {
+        for (const auto &name : benchmarks.names())
+            fprintf(stdout, "%s\n", name.c_str());
+        return 0;
+    }
+
+    qz::bench::BenchmarkOptions options;
+    options.filter = parser.value("filter").toStdString();
+    options.min_time = parser.value("min_time").toDouble();
+    if (!(options.min_time > 0.0))
+    {
+        qCritical() << "Error: --min_time must be positive";
+        return 1;
+    }
+
+    qz::bench::PerfCounters counters;
+    bool perf_counters = parser.isSet("perf_counters") && counters.open();
+    if (parser.isSet("perf_counters") && !perf_counters)
+    {
+        fprintf(stderr, "perf_event_open is unavailable (see kernel.perf_event_paranoid); running without counters\n");
+    }
+
+    std::vector<qz::bench::BenchmarkResult> results;
+    try
+    {
+        fprintf(stderr, "%-40s %14s %14s %12s\n", "Benchmark", "Time (ns)", "CPU (ns)", "Iterations");
+        results = benchmarks.run(options, perf_counters ? &counters : nullptr,
+                                 [](const qz::bench::BenchmarkResult &result)
+                                 {
+                                     fprintf(stderr, "%-40s %14.1f %14.1f %12llu\n", result.name.c_str(),
+                                             result.real_ns, result.cpu_ns,
+                                             static_cast<unsigned long long>(result.iterations));
+                                 });
+    }
+    catch (const std::regex_error &)
+    {
+        qCritical() << "Error: invalid --filter regex" << parser.value("filter");
+        return 1;
+    }
+
+    QJsonArray runs;
+    for (const auto &result : results)
+        runs.append(result_to_json(result));
+
+    QJsonObject report{
+        {"context", QJsonObject{
+                        {"date", QDateTime::currentDateTime().toString(Qt::ISODate)},
+                        {"host_name", QSysInfo::machineHostName()},
+                        {"executable", QCoreApplication::applicationFilePath()},
+                        {"num_cpus", static_cast<int>(std::thread::hardware_concurrency())},
+                        {"cpu_architecture", QSysInfo::currentCpuArchitecture()},
+#ifdef NDEBUG
+                        {"library_build_type", "release"},
+#else
+                        {"library_build_type", "debug"},
+#endif
+                        {"min_time", options.min_time},
+                        {"perf_counters", perf_counters}}},
+        {"benchmarks", runs}};
+
+    QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    if (parser.isSet("output"))
+    {
+        QFile file(parser.value("output"));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        {
+            qCritical() << "Error: could not open output file" << parser.value("output");
+            return 1;
+        }
+        file.write(json);
+    }
+    else
+    {
+        fprintf(stdout, "%s", json.constData());
+    }
+
+    return 0;
+}
@@ -2,12 +2,19 @@
 #include <QTextStream>
 #include <QDebug>
 #include <QFile>
+#include <QJsonDocument>
+#include <QUrlQuery>
+#include "ChainSimBinaryServer.h"
 #include "ChainSimBuilder.h"
+#include "ChainSimManifestRunner.h"
 #include "purchase_policies/PurchaseROP.h"
 #include "purchase_policies/PurchaseEOQ.h"
 #include "purchase_policies/PurchaseTPOP.h"
 #include "utils/CLI.hpp"
 #include "ChainSimServer.h"
+#include "ChainSimServerPool.h"
+#include "ChainSimSessionServer.h"
+#include "utils/Trace.hpp"
 
 void print_simulation_config(const QCommandLineParser &parser, const PurchasePolicy &policy)
 {
@@ -132,6 +139,51 @@ std::unique_ptr<PurchasePolicy> create_policy(const QString &policy_name,
     }
 }
 
+// Same policies as create_policy, for replication threads: the parser is only read here
+std::function<std::unique_ptr<PurchasePolicy>()> policy_factory(const QCommandLineParser &parser,
+                                                                const QString &policy_name)
+{
+    auto lead_time = parser.value("average_lead_time").toUInt();
+    auto demand = parser.value("average_demand").toDouble();
+    auto ordering_cost = parser.value("ordering_cost").toDouble();
+    auto holding_cost = parser.value("holding_cost").toDouble();
+    auto review_period = parser.value("purchase_period").toUInt();
+    return [=]() -> std::unique_ptr<PurchasePolicy>
+    {
+        if (policy_name == "EOQ")
+            return std::make_unique<PurchaseEOQ>(lead_time, demand, ordering_cost, holding_cost);
+        if (policy_name == "TPOP")
+            return std::make_unique<PurchaseTPOP>(lead_time, demand, review_period);
+        return std::make_unique<PurchaseROP>(lead_time, demand);
+    };
+}
+
+// The CLI scenario as /simulate parameters, so every mode builds engines exactly as the server does
+QUrlQuery scenario_query(const QCommandLineParser &parser)
+{
+    QUrlQuery query;
+    for (const char *name : {"simulation_length", "average_lead_time", "average_demand", "std_demand",
+                             "starting_inventory", "purchase_period", "ordering_cost", "holding_cost",
+                             "stockout_cost", "seed", "policy", "demand_distribution", "gamma_shape",
+                             "gamma_scale", "uniform_min", "uniform_max", "log_level"})
+    {
+        query.addQueryItem(name, parser.value(name));
+    }
+    for (const char *flag : {"deterministic", "summary_only"})
+    {
+        if (parser.isSet(flag))
+            query.addQueryItem(flag, "1");
+    }
+    return query;
+}
+
+// Engines of the CLI scenario for replication threads, built as the server's analysis routes build them
+std::function<std::unique_ptr<qz::ChainSim>(unsigned)> simulation_factory(const QCommandLineParser &parser,
+                                                                         bool distributions)
+{
+    return qz::ChainSimServer::replicationFactory(scenario_query(parser), distributions);
+}
+
 void save_results(const qz::ChainSim::simulation_records_t &records,
                   const QString &filename)
 {
@@ -160,6 +212,269 @@ void save_results(const qz::ChainSim::simulation_records_t &records,
     }
 }
 
+void print_kpis(const qz::SimulationKpis &kpis)
+{
+    QTextStream out(stdout);
+    const int labelWidth = 30;
+
+    auto printRow = [&](const QString &label, const QString &value)
+    {
+        out.setFieldAlignment(QTextStream::AlignLeft);
+        out.setFieldWidth(labelWidth);
+        out << label;
+        out.setFieldWidth(0);
+        out << value << "\n";
+    };
+
+    printRow("Days", QString::number(kpis.days));
+    printRow("Service Level (%)", QString::number(kpis.service_level, 'f', 2));
+    printRow("Average Inventory", QString::number(kpis.average_inventory, 'f', 2));
+    printRow("Inventory Std Dev", QString::number(kpis.inventory_stddev, 'f', 2));
+    printRow("Total Lost Sales", QString::number(kpis.total_lost_sales));
+    printRow("Total Purchases", QString::number(kpis.total_purchases));
+    printRow("Average Daily Demand", QString::number(kpis.average_demand, 'f', 2));
+    printRow("Total Sales", QString::number(kpis.total_sales));
+    printRow("Inventory Turns", QString::number(kpis.inventory_turns, 'f', 4));
+    printRow("Peak Inventory", QString::number(kpis.peak_inventory));
+    printRow("Minimum Inventory", QString::number(kpis.min_inventory));
+    printRow("Stockout Days", QString::number(kpis.stockout_days));
+    out.flush();
+}
+
+void print_distributions(const qz::KpiDistributions &distributions)
+{
+    QTextStream out(stdout);
+    const int labelWidth = 30;
+    const int valueWidth = 12;
+
+    out << "\n";
+    out.setFieldAlignment(QTextStream::AlignLeft);
+    out.setFieldWidth(labelWidth);
+    out << "Distribution";
+    out.setFieldAlignment(QTextStream::AlignRight);
+    for (const char *header : {"P5", "P50", "P95", "P99"})
+    {
+        out.setFieldWidth(valueWidth);
+        out << header;
+    }
+    out.setFieldWidth(0);
+    out << "\n";
+
+    auto printRow = [&](const QString &label, const qz::QuantileSketch &sketch)
+    {
+        out.setFieldAlignment(QTextStream::AlignLeft);
+        out.setFieldWidth(labelWidth);
+        out << label;
+        out.setFieldAlignment(QTextStream::AlignRight);
+        for (double q : {0.05, 0.50, 0.95, 0.99})
+        {
+            out.setFieldWidth(valueWidth);
+            out << QString::number(sketch.quantile(q), 'f', 2);
+        }
+        out.setFieldWidth(0);
+        out << "\n";
+    };
+
+    printRow("Inventory", distributions.inventory);
+    printRow("Daily Lost Sales", distributions.lost_sales);
+    printRow("Cycle Service (%)", distributions.cycle_service);
+    out.flush();
+}
+
+void print_decisions(const qz::DecisionTrace &decisions, const PurchasePolicy &policy, const QString &days)
+{
+    QTextStream out(stdout);
+    for (auto day : qz::DecisionTrace::parse_days(days))
+    {
+        const auto *decision = decisions.find(day);
+        if (!decision)
+            continue; // Day 0 and days past the horizon have no decision
+
+        out << "\nDay #" << day << " (" << policy.name() << ")\n";
+        for (const QString &line : policy.explain(*decision).split('\n'))
+        {
+            out << "  " << line << "\n";
+        }
+    }
+    out.flush();
+}
+
+int run_optimizer(const QCommandLineParser &parser, const PurchasePolicy &heuristic)
+{
+    auto lead_time = parser.value("average_lead_time").toUInt();
+    auto demand = parser.value("average_demand").toDouble();
+    auto simulation_length = parser.value("simulation_length").toULongLong();
+
+    auto costs = qz::ChainSimServer::parseCosts(scenario_query(parser));
+
+    qz::OptimizerOptions options;
+    options.target_service_level = parser.value("target_service_level").toDouble();
+    options.replications = parser.value("replications").toUInt();
+    options.max_iterations = parser.value("optimizer_iterations").toUInt();
+    options.base_seed = parser.value("seed").toUInt();
+
+    auto simulations = simulation_factory(parser, false);
+
+    qz::PolicyOptimizer optimizer(simulations,
+                                  qz::PolicyOptimizer::policy_factory(parser.value("policy"), lead_time),
+                                  qz::PolicyOptimizer::parameter_space(heuristic, lead_time, demand, simulation_length),
+                                  costs, options);
+    auto result = optimizer.optimize();
+
+    QTextStream out(stdout);
+    out << QJsonDocument(qz::ChainSimServer::optimizationResultToJson(result)).toJson();
+    return result.feasible ? 0 : 2;
+}
+
+int run_replications(const QCommandLineParser &parser, const QString &policy_name)
+{
+    qz::ReplicationOptions options;
+    options.min_replications = parser.value("min_replications").toUInt();
+    options.max_replications = parser.value("max_replications").toUInt();
+    options.base_seed = parser.value("seed").toUInt();
+
+    auto simulations = simulation_factory(parser, true);
+
+    qz::ReplicationRunner runner(simulations, policy_factory(parser, policy_name),
+                                 qz::ReplicationRunner::parse_targets(parser.value("precision")), options);
+    auto result = runner.run();
+
+    QTextStream out(stdout);
+    out << QJsonDocument(qz::ChainSimServer::replicationResultToJson(result)).toJson();
+    return result.converged ? 0 : 2;
+}
+
+int run_stockout_risk(const QCommandLineParser &parser, const QString &policy_name)
+{
+    auto lead_time = parser.value("average_lead_time").toUInt();
+    auto window = parser.value("window").toULongLong();
+
+    qz::RareEventOptions options;
+    options.tilt = parser.value("tilt").toDouble();
+    options.window = window > 0 ? window : lead_time + 1;
+    options.replications = parser.isSet("replications") ? parser.value("replications").toUInt() : 1000;
+    options.base_seed = parser.value("seed").toUInt();
+
+    auto simulations = simulation_factory(parser, false);
+    qz::RareEventEstimator estimator(simulations, policy_factory(parser, policy_name), options);
+    QTextStream out(stdout);
+    out << QJsonDocument(qz::ChainSimServer::rareEventEstimateToJson(estimator.estimate())).toJson();
+    return 0;
+}
+
+int run_sensitivity(const QCommandLineParser &parser, const QString &policy_name)
+{
+    // The server's parameters, so each design point is built exactly as a /sensitivity request would be
+    auto query = scenario_query(parser);
+    query.removeAllQueryItems("policy");
+    query.addQueryItem("policy", policy_name);
+    query.addQueryItem("samples", parser.value("samples"));
+    query.addQueryItem("ranges", parser.value("sensitivity"));
+    query.addQueryItem("replications", parser.isSet("replications") ? parser.value("replications") : "1");
+
+    auto result = qz::ChainSimServer::analyzeSensitivity(query);
+    QTextStream out(stdout);
+    out << QJsonDocument(qz::ChainSimServer::sensitivityResultToJson(result)).toJson();
+    return 0;
+}
+
+int run_comparison(const QCommandLineParser &parser)
+{
+    auto names = parser.value("compare").split(',', Qt::SkipEmptyParts);
+    std::vector<qz::PolicyComparison::PolicyFactory> policies;
+    for (auto &name : names)
+    {
+        name = name.trimmed();
+        if (name != "ROP" && name != "EOQ" && name != "TPOP")
+        {
+            throw std::invalid_argument("Unsupported policy: " + name.toStdString());
+        }
+        policies.push_back(policy_factory(parser, name));
+    }
+
+    qz::ComparisonOptions options;
+    options.replications = parser.value("replications").toUInt();
+    options.base_seed = parser.value("seed").toUInt();
+    options.costs = qz::ChainSimServer::parseCosts(scenario_query(parser));
+
+    auto simulations = simulation_factory(parser, false);
+
+    qz::PolicyComparison comparison(simulations, names, policies, options);
+    QTextStream out(stdout);
+    out << QJsonDocument(qz::ChainSimServer::comparisonResultToJson(comparison.compare())).toJson();
+    return 0;
+}
+
+int run_analytical(const QCommandLineParser &parser, const PurchasePolicy &policy,
+                   const std::function<std::unique_ptr<qz::ChainSim>()> &fallback)
+{
+    QString distribution = parser.isSet("deterministic") ? QStringLiteral("fixed") : parser.value("demand_distribution");
+    qz::MarkovEvaluator evaluator(distribution,
+                                  parser.value("average_demand").toDouble(),
+                                  parser.value("average_lead_time").toUInt(),
+                                  parser.value("starting_inventory").toULongLong(),
+                                  parser.value("simulation_length").toULongLong());
+
+    auto evaluation = evaluator.evaluate(policy, fallback);
+    QTextStream out(stdout);
+    out << QJsonDocument(qz::ChainSimServer::markovEvaluationToJson(evaluation)).toJson();
+    return 0;
+}
+
+int run_manifest(const QCommandLineParser &parser)
+{
+    // The command line is the default for whatever a scenario leaves out; scenarios log only if asked
+    auto defaults = scenario_query(parser);
+    defaults.removeAllQueryItems("log_level");
+
+    qz::ManifestOptions options;
+    options.output_dir = parser.value("output_dir");
+    options.threads = parser.value("threads").toUInt();
+    options.shards = parser.value("shards").toUInt();
+    options.resume = !parser.isSet("no_resume");
+
+    auto scenarios = qz::ChainSimManifestRunner::readManifest(parser.value("manifest"));
+    qz::ChainSimManifestRunner runner(defaults, options);
+    auto report = runner.run(scenarios);
+
+    QTextStream out(stdout);
+    out << report.scenarios << " scenarios: " << report.succeeded << " ok, " << report.failed << " failed, "
+        << report.skipped << " already done (see " << options.output_dir << "/summary.csv)\n";
+    return report.failed > 0 ? 2 : 0;
+}
+
+// Writes the recorded trace spans to a file when main returns, whichever mode ran
+class TraceFileWriter
+{
+public:
+    explicit TraceFileWriter(QString path) : m_path(std::move(path))
+    {
+        if (m_path.isEmpty())
+            return;
+        qz::Tracer::instance().set_thread_name("main");
+        qz::Tracer::instance().set_enabled(true);
+    }
+
+    ~TraceFileWriter()
+    {
+        if (m_path.isEmpty())
+            return;
+        QFile file(m_path);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        {
+            qCritical() << "Error: could not open trace file" << m_path;
+            return;
+        }
+        file.write(QByteArray::fromStdString(qz::Tracer::instance().to_json()));
+    }
+
+    TraceFileWriter(const TraceFileWriter &) = delete;
+    TraceFileWriter &operator=(const TraceFileWriter &) = delete;
+
+private:
+    QString m_path;
+};
+
 int main(int argc, char *argv[])
 {
     QCoreApplication app(argc, argv);
@@ -170,26 +485,65 @@ int main(int argc, char *argv[])
     {
         QCommandLineParser parser;
         qz::parse_command_line_args(parser, app);
+        TraceFileWriter trace_writer(parser.value("trace_file"));
 
         // Check if server mode is requested
         if (parser.isSet("server"))
         {
-            qz::ChainSimServer server;
-            if (!server.start(47761))
+            // One server on the main thread, or a pool of per-core event loops sharing the port
+            auto server_threads = parser.value("server_threads").toInt();
+            std::unique_ptr<qz::ChainSimServer> server;
+            std::unique_ptr<qz::ChainSimServerPool> serverPool;
+            if (server_threads == 1)
+            {
+                server = std::make_unique<qz::ChainSimServer>();
+                server->setProfilingEnabled(parser.isSet("profiler"));
+                if (!server->start(47761))
+                {
+                    return 1;
+                }
+            }
+            else
+            {
+                serverPool = std::make_unique<qz::ChainSimServerPool>();
+                serverPool->setProfilingEnabled(parser.isSet("profiler"));
+                if (!serverPool->start(47761, server_threads))
+                {
+                    return 1;
+                }
+            }
+
+            qz::ChainSimSessionServer sessionServer;
+            if (!sessionServer.start(parser.value("session_port").toUShort()))
+            {
+                return 1;
+            }
+
+            qz::ChainSimBinaryServer binaryServer;
+            auto binary_port = parser.value("binary_port").toUShort();
+            if (binary_port != 0 && !binaryServer.listen(binary_port))
+            {
+                return 1;
+            }
+            if (parser.isSet("binary_socket") && !binaryServer.listenLocal(parser.value("binary_socket")))
             {
                 return 1;
             }
             return app.exec();
         }
 
+        if (parser.isSet("manifest"))
+        {
+            qz::TraceSpan span("manifest", "cli");
+            return run_manifest(parser);
+        }
+
         // Get simulation parameters
-        auto log_level = parser.value("log_level").toUInt();
-        auto simulation_length = parser.value("simulation_length").toULongLong();
         auto lead_time = parser.value("average_lead_time").toULongLong();
         auto demand = parser.value("average_demand").toDouble();
-        auto starting_inventory = parser.value("starting_inventory").toULongLong();
         auto policy_name = parser.value("policy");
         auto output_file = parser.value("output_file");
+        bool summary_only = parser.isSet("summary_only");
 
         // Create appropriate policy
         auto policy = create_policy(policy_name, lead_time, demand, parser);
@@ -197,22 +551,112 @@ int main(int argc, char *argv[])
         // Print configuration if log level > 0
         print_simulation_config(parser, *policy);
 
+        if (parser.isSet("optimize"))
+        {
+            qz::TraceSpan span("optimize", "cli");
+            return run_optimizer(parser, *policy);
+        }
+
+        if (parser.isSet("compare"))
+        {
+            qz::TraceSpan span("compare", "cli");
+            return run_comparison(parser);
+        }
+
+        if (parser.isSet("sensitivity"))
+        {
+            qz::TraceSpan span("sensitivity", "cli");
+            return run_sensitivity(parser, policy_name);
+        }
+
+        if (parser.isSet("stockout_risk"))
+        {
+            qz::TraceSpan span("stockout_risk", "cli");
+            return run_stockout_risk(parser, policy_name);
+        }
+
+        if (parser.isSet("precision"))
+        {
+            qz::TraceSpan span("replicate", "cli");
+            return run_replications(parser, policy_name);
+        }
+
+        if (parser.isSet("analytical"))
+        {
+            auto fallback = [&]()
+            {
+                return simulation_factory(parser, false)(parser.value("seed").toUInt());
+            };
+            qz::TraceSpan span("analytical", "cli");
+            return run_analytical(parser, *policy, fallback);
+        }
+
         // Create and configure simulation
-        auto chainSimulator = qz::ChainSimBuilder()
-                                  .setSimulationName("ChainSim")
-                                  .setSimulationLength(simulation_length)
-                                  .setLeadTime(lead_time)
-                                  .setAverageDemand(demand)
-                                  .setStartingInventory(starting_inventory)
-                                  .setLoggingLevel(log_level)
-                                  .create();
+        std::unique_ptr<qz::ChainSim> chainSimulator;
+        {
+            qz::ChainSimBuilder builder;
+            qz::ChainSimServer::configureBuilder(builder, scenario_query(parser));
+            builder.setTraceDecisions(parser.isSet("explain_days"));
+            if (parser.isSet("aggregate"))
+            {
+                builder.setRecordHistory(true); // Aggregates are computed from the per-day records
+            }
+            qz::TraceSpan span("ChainSimBuilder::create", "engine");
+            chainSimulator = builder.create();
+        }
 
-        chainSimulator->initialize_simulation();
+        {
+            qz::TraceSpan span("initialize_simulation", "engine");
+            chainSimulator->initialize_simulation();
+        }
 
         // Run simulation
-        chainSimulator->simulate(*policy);
+        {
+            qz::TraceSpan span("simulate", "engine");
+            chainSimulator->simulate(*policy);
+        }
+
+        if (parser.isSet("explain_days"))
+        {
+            print_decisions(chainSimulator->get_decisions(), *policy, parser.value("explain_days"));
+        }
+
+        if (parser.isSet("aggregate"))
+        {
+            qz::TraceSpan span("aggregate", "cli");
+            auto records = chainSimulator->get_simulation_records();
+            QUrlQuery query;
+            query.addQueryItem("aggregates", parser.value("aggregate"));
+            if (parser.isSet("aggregate_from"))
+            {
+                query.addQueryItem("from", parser.value("aggregate_from"));
+            }
+            if (parser.isSet("aggregate_to"))
+            {
+                query.addQueryItem("to", parser.value("aggregate_to"));
+            }
+            auto aggregates = qz::ChainSimServer::aggregateRecords(records, query);
+
+            // The per-day CSV is still written when asked for explicitly
+            if (parser.isSet("output_file"))
+            {
+                save_results(records, output_file);
+            }
+            QTextStream out(stdout);
+            out << QJsonDocument(aggregates).toJson();
+            return 0;
+        }
+
+        if (summary_only)
+        {
+            qz::TraceSpan span("print_kpis", "cli");
+            print_kpis(chainSimulator->get_kpis());
+            print_distributions(chainSimulator->get_distributions());
+            return 0;
+        }
 
         // Get and save results
+        qz::TraceSpan span("save_results", "cli");
         auto simulation_records = chainSimulator->get_simulation_records();
         save_results(simulation_records, output_file);
 
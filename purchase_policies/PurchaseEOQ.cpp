@@ -19,6 +19,24 @@ PurchaseEOQ::PurchaseEOQ(quint32 leadTime,
     m_reorder_point = static_cast<qint64>(m_average_daily_demand * m_lead_time + safety_stock);
 }
 
+PurchaseEOQ::PurchaseEOQ(quint32 leadTime, const Parameters &parameters, QObject *parent)
+    : PurchasePolicy(parent), m_lead_time{leadTime}, m_average_daily_demand{0}, m_ordering_cost{0}, m_holding_cost_rate{0},
+      m_eoq{static_cast<double>(parameters.order_quantity)}, m_reorder_point{parameters.reorder_point}, m_tuned{true}
+{
+    if (leadTime == 0)
+    {
+        throw std::invalid_argument("Lead time must be greater than zero");
+    }
+    if (parameters.reorder_point < 0)
+    {
+        throw std::invalid_argument("Reorder point cannot be negative");
+    }
+    if (parameters.order_quantity <= 0)
+    {
+        throw std::invalid_argument("Order quantity must be positive");
+    }
+}
+
 void PurchaseEOQ::validate_parameters() const
 {
     if (m_lead_time == 0)
@@ -46,19 +64,12 @@ void PurchaseEOQ::calculate_eoq()
     m_eoq = std::sqrt((2.0 * annual_demand * m_ordering_cost) / m_holding_cost_rate);
 }
 
-qint64 PurchaseEOQ::get_purchase(const simulation_records_t &pastRecords,
-                                 quint32 current_day) const
+qint64 PurchaseEOQ::get_purchase(const InventoryPosition &state) const
 {
-    auto current_inventory = pastRecords[QStringLiteral("inventory_quantity")][current_day];
+    auto current_inventory = state.on_hand;
 
     // Include incoming orders in the inventory position
-    qint64 pipeline_inventory = 0;
-    for (quint32 i = current_day + 1;
-         i < qMin(current_day + m_lead_time + 1, quint32(pastRecords[QStringLiteral("procurement_quantity")].size()));
-         ++i)
-    {
-        pipeline_inventory += pastRecords[QStringLiteral("procurement_quantity")][i];
-    }
+    qint64 pipeline_inventory = state.pipeline;
 
     qint64 inventory_position = current_inventory + pipeline_inventory;
 
@@ -76,19 +87,10 @@ QString PurchaseEOQ::name() const
     return QStringLiteral("EOQ");
 }
 
-QString PurchaseEOQ::get_calculation_details(
-    const simulation_records_t &pastRecords,
-    quint32 current_day) const
+QString PurchaseEOQ::explain(const DecisionRecord &decision) const
 {
-    auto current_inventory = pastRecords[QStringLiteral("inventory_quantity")][current_day];
-    qint64 pipeline_inventory = 0;
-
-    for (quint32 i = current_day + 1;
-         i < qMin(current_day + m_lead_time + 1, quint32(pastRecords[QStringLiteral("procurement_quantity")].size()));
-         ++i)
-    {
-        pipeline_inventory += pastRecords[QStringLiteral("procurement_quantity")][i];
-    }
+    auto current_inventory = decision.on_hand;
+    qint64 pipeline_inventory = decision.pipeline;
 
     qint64 inventory_position = current_inventory + pipeline_inventory;
     double annual_demand = m_average_daily_demand * 365.0;
@@ -96,6 +98,15 @@ QString PurchaseEOQ::get_calculation_details(
     QString details;
     QTextStream ss(&details);
 
+    if (m_tuned)
+    {
+        ss << "ROP = " << m_reorder_point << ", Q = " << m_eoq << " (tuned)\n"
+           << "INV = I + P = " << current_inventory << " + " << pipeline_inventory
+           << " = " << inventory_position << " ≤ " << m_reorder_point
+           << " → Order = " << (decision.quantity > 0 ? QString::number(decision.quantity) : QStringLiteral("0 (No order, IP > ROP)"));
+        return details;
+    }
+
     ss << "EOQ = sqrt((2×D×S)/H) = sqrt((2×" << annual_demand << "×"
        << m_ordering_cost << ")/" << m_holding_cost_rate << ") = " << m_eoq << "\n"
        << "ROP = LT×D + SS = " << m_lead_time << "×" << m_average_daily_demand
@@ -103,7 +114,7 @@ QString PurchaseEOQ::get_calculation_details(
        << " = " << m_reorder_point << "\n"
        << "INV = I + P = " << current_inventory << " + " << pipeline_inventory
        << " = " << inventory_position << " ≤ " << m_reorder_point
-       << " → Order = " << (inventory_position <= m_reorder_point ? QString::number(static_cast<qint64>(std::ceil(m_eoq))) : QStringLiteral("0 (No order, IP > ROP)"));
+       << " → Order = " << (decision.quantity > 0 ? QString::number(decision.quantity) : QStringLiteral("0 (No order, IP > ROP)"));
 
     return details;
 }
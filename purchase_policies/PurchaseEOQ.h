@@ -10,17 +10,33 @@ class PurchaseEOQ : public PurchasePolicy
     Q_OBJECT
 
 public:
+    // Explicit decision variables, e.g. found by the policy optimizer
+    struct Parameters
+    {
+        qint64 reorder_point;
+        qint64 order_quantity;
+    };
+
     PurchaseEOQ(quint32 leadTime,
                 double avgDemand,
                 double orderingCost,
                 double holdingCostRate,
                 QObject *parent = nullptr);
+    PurchaseEOQ(quint32 leadTime, const Parameters &parameters, QObject *parent = nullptr);
+
+    [[nodiscard]] Parameters parameters() const
+    {
+        return {m_reorder_point, static_cast<qint64>(std::ceil(m_eoq))};
+    }
 
-    [[nodiscard]] qint64 get_purchase(const simulation_records_t &pastRecords,
-                                      quint32 current_day) const override;
+    [[nodiscard]] qint64 get_purchase(const InventoryPosition &state) const override;
 
     [[nodiscard]] QString name() const override;
 
+    [[nodiscard]] double decision_threshold() const override { return static_cast<double>(m_reorder_point); }
+
+    [[nodiscard]] QString explain(const DecisionRecord &decision) const override;
+
 private:
     quint32 m_lead_time;
     double m_average_daily_demand;
@@ -28,12 +44,10 @@ private:
     double m_holding_cost_rate;
     double m_eoq;
     qint64 m_reorder_point;
+    bool m_tuned{false};
 
     void calculate_eoq();
     void validate_parameters() const;
-    [[nodiscard]] QString get_calculation_details(
-        const simulation_records_t &pastRecords,
-        quint32 current_day) const override;
 };
 
 #endif // CHAINSIM_PURCHASEEOQ_H
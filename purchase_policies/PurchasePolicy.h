@@ -8,6 +8,33 @@
 #include <QTextStream>
 #include <QObject>
 
+/* State a purchase decision is based on, maintained incrementally by the engine.
+ * Policies never look at the day-by-day history, so it does not have to be kept.
+ */
+struct InventoryPosition
+{
+    quint64 day{0};
+    qint64 on_hand{0};  // Inventory after today's receipts and sales
+    qint64 pipeline{0}; // Ordered but not yet received
+
+    [[nodiscard]] qint64 position() const { return on_hand + pipeline; }
+};
+
+/* One purchase decision as kept in a DecisionTrace: the state the policy saw, the level it
+ * compared the position with and the outcome. Fixed-size, so a run's trace is one flat array;
+ * the text explaining it is only rendered (PurchasePolicy::explain) for days someone inspects.
+ */
+struct DecisionRecord
+{
+    quint64 day{0};
+    qint64 on_hand{0};
+    qint64 pipeline{0};
+    qint64 quantity{0};    // Units ordered
+    double threshold{0.0}; // Reorder point or order-up-to level
+
+    [[nodiscard]] InventoryPosition state() const { return {day, on_hand, pipeline}; }
+};
+
 class PurchasePolicy : public QObject
 {
     Q_OBJECT
@@ -18,13 +45,26 @@ public:
     PurchasePolicy(QObject *parent = nullptr) {}
 
     [[nodiscard]] virtual qint64
-    get_purchase(const simulation_records_t &pastRecords, quint32 current_day) const = 0;
+    get_purchase(const InventoryPosition &state) const = 0;
 
     [[nodiscard]] virtual QString name() const = 0;
 
-    [[nodiscard]] virtual QString get_calculation_details(
-        const simulation_records_t &pastRecords,
-        quint32 current_day) const = 0;
+    // Level the inventory is compared with (reorder point or order-up-to level), for decision traces
+    [[nodiscard]] virtual double decision_threshold() const = 0;
+
+    // How a recorded decision was reached, e.g. "EOQ = sqrt((2×D×S)/H) = ..."
+    [[nodiscard]] virtual QString explain(const DecisionRecord &decision) const = 0;
+
+    [[nodiscard]] DecisionRecord record_decision(const InventoryPosition &state, qint64 quantity) const
+    {
+        return {state.day, state.on_hand, state.pipeline, quantity, decision_threshold()};
+    }
+
+    // Same text for a decision that was not traced
+    [[nodiscard]] QString get_calculation_details(const InventoryPosition &state) const
+    {
+        return explain(record_decision(state, get_purchase(state)));
+    }
 };
 
 #endif // CHAINSIM_PURCHASEPOLICY_H
@@ -17,15 +17,33 @@ PurchaseROP::PurchaseROP(quint32 leadTime, double avgDemand, QObject *parent)
     }
     m_safety_stock = std::ceil(m_average_daily_demand) * leadTime;
     m_reorder_point = static_cast<qint64>(m_average_daily_demand * leadTime + m_safety_stock);
+    m_order_quantity = static_cast<qint64>(std::ceil(m_average_daily_demand * leadTime));
 }
 
-qint64 PurchaseROP::get_purchase(const simulation_records_t &pastRecords,
-                                 quint32 current_day) const
+PurchaseROP::PurchaseROP(quint32 leadTime, const Parameters &parameters, QObject *parent)
+    : PurchasePolicy(parent), m_lead_time{leadTime}, m_average_daily_demand{0}, m_safety_stock{0},
+      m_reorder_point{parameters.reorder_point}, m_order_quantity{parameters.order_quantity}, m_tuned{true}
 {
-    auto current_inventory = pastRecords[QStringLiteral("inventory_quantity")][current_day];
+    if (leadTime == 0)
+    {
+        throw std::invalid_argument("Lead time must be greater than zero");
+    }
+    if (parameters.reorder_point < 0)
+    {
+        throw std::invalid_argument("Reorder point cannot be negative");
+    }
+    if (parameters.order_quantity <= 0)
+    {
+        throw std::invalid_argument("Order quantity must be positive");
+    }
+}
+
+qint64 PurchaseROP::get_purchase(const InventoryPosition &state) const
+{
+    auto current_inventory = state.on_hand;
     qint64 reorder_quantity{0};
     if (current_inventory <= m_reorder_point)
-        reorder_quantity = std::ceil(m_average_daily_demand * m_lead_time);
+        reorder_quantity = m_order_quantity;
 
     return reorder_quantity;
 }
@@ -35,21 +53,26 @@ QString PurchaseROP::name() const
     return QStringLiteral("ROP/CR");
 }
 
-QString PurchaseROP::get_calculation_details(
-    const simulation_records_t &pastRecords,
-    quint32 current_day) const
+QString PurchaseROP::explain(const DecisionRecord &decision) const
 {
-
-    auto current_inventory = pastRecords[QStringLiteral("inventory_quantity")][current_day];
+    auto current_inventory = decision.on_hand;
     QString details;
     QTextStream ss(&details);
 
-    auto order_qty = (current_inventory <= m_reorder_point) ? std::ceil(m_average_daily_demand * m_lead_time) : 0;
+    if (m_tuned)
+    {
+        ss << "ROP = " << m_reorder_point << ", Q = " << m_order_quantity << " (tuned)\n"
+           << "INV = " << current_inventory << " ≤ " << m_reorder_point
+           << " → Order = " << decision.quantity;
+        return details;
+    }
+
+    auto order_qty = decision.quantity;
 
     ss << "ROP = LT×D + SS = " << m_lead_time << "×" << m_average_daily_demand
        << " + " << m_safety_stock << " = " << m_reorder_point << "\n"
        << "INV = " << current_inventory << " ≤ " << m_reorder_point
-       << " → Order = " << (current_inventory <= m_reorder_point ? "LT×D = " : "0 (No order, IP > ROP)")
+       << " → Order = " << (order_qty > 0 ? "LT×D = " : "0 (No order, IP > ROP)")
        << (order_qty > 0 ? QString("%1×%2 = %3")
                                .arg(m_lead_time)
                                .arg(m_average_daily_demand)
@@ -11,24 +11,36 @@ class PurchaseROP : public PurchasePolicy
 {
     Q_OBJECT
 
+public:
+    // Explicit decision variables, e.g. found by the policy optimizer
+    struct Parameters
+    {
+        qint64 reorder_point;
+        qint64 order_quantity;
+    };
+
 private:
     quint32 m_lead_time;
     double m_average_daily_demand;
     double m_safety_stock;
     qint64 m_reorder_point;
+    qint64 m_order_quantity;
+    bool m_tuned{false};
 
 public:
     PurchaseROP(quint32 leadTime, double avgDemand, QObject *parent = nullptr);
+    PurchaseROP(quint32 leadTime, const Parameters &parameters, QObject *parent = nullptr);
+
+    [[nodiscard]] Parameters parameters() const { return {m_reorder_point, m_order_quantity}; }
 
     [[nodiscard]] qint64
-    get_purchase(const simulation_records_t &pastRecords,
-                 quint32 current_day) const final;
+    get_purchase(const InventoryPosition &state) const final;
 
     [[nodiscard]] QString name() const final;
 
-    [[nodiscard]] QString get_calculation_details(
-        const simulation_records_t &pastRecords,
-        quint32 current_day) const override;
+    [[nodiscard]] double decision_threshold() const override { return static_cast<double>(m_reorder_point); }
+
+    [[nodiscard]] QString explain(const DecisionRecord &decision) const override;
 };
 
 #endif // CHAINSIM_PURCHASEROP_H
@@ -7,6 +7,24 @@ PurchaseTPOP::PurchaseTPOP(quint32 leadTime, double avgDemand, quint32 reviewPer
     calculate_target_level();
 }
 
+PurchaseTPOP::PurchaseTPOP(quint32 leadTime, const Parameters &parameters, QObject *parent)
+    : PurchasePolicy(parent), m_lead_time{leadTime}, m_average_daily_demand{0},
+      m_review_period{parameters.review_period}, m_target_level{parameters.target_level}, m_tuned{true}
+{
+    if (m_lead_time == 0)
+    {
+        throw std::invalid_argument("Lead time must be greater than zero");
+    }
+    if (m_review_period == 0)
+    {
+        throw std::invalid_argument("Review period must be greater than zero");
+    }
+    if (m_target_level < 0)
+    {
+        throw std::invalid_argument("Target level cannot be negative");
+    }
+}
+
 void PurchaseTPOP::validate_parameters() const
 {
     if (m_lead_time == 0)
@@ -39,24 +57,17 @@ bool PurchaseTPOP::is_review_day(quint32 day) const
     return day % m_review_period == 0;
 }
 
-qint64 PurchaseTPOP::get_purchase(const simulation_records_t &pastRecords,
-                                  quint32 current_day) const
+qint64 PurchaseTPOP::get_purchase(const InventoryPosition &state) const
 {
-    if (!is_review_day(current_day))
+    if (!is_review_day(state.day))
     {
         return 0;
     }
 
-    auto current_inventory = pastRecords[QStringLiteral("inventory_quantity")][current_day];
+    auto current_inventory = state.on_hand;
 
-    // Calculate pipeline inventory (orders already placed but not yet received)
-    qint64 pipeline_inventory = 0;
-    for (quint32 i = current_day + 1;
-         i < qMin(current_day + m_lead_time + 1, quint32(pastRecords[QStringLiteral("procurement_quantity")].size()));
-         ++i)
-    {
-        pipeline_inventory += pastRecords[QStringLiteral("procurement_quantity")][i];
-    }
+    // Pipeline inventory (orders already placed but not yet received)
+    qint64 pipeline_inventory = state.pipeline;
 
     qint64 inventory_position = current_inventory + pipeline_inventory;
     qint64 order_quantity = static_cast<qint64>(std::ceil(m_target_level - inventory_position));
@@ -69,26 +80,17 @@ QString PurchaseTPOP::name() const
     return QStringLiteral("TPOP");
 }
 
-QString PurchaseTPOP::get_calculation_details(
-    const simulation_records_t &pastRecords,
-    quint32 current_day) const
+QString PurchaseTPOP::explain(const DecisionRecord &decision) const
 {
-    if (!is_review_day(current_day))
+    if (!is_review_day(decision.day))
     {
         return QStringLiteral("Not a review day (Day %1 % %2 ≠ 0)")
-            .arg(current_day)
+            .arg(decision.day)
             .arg(m_review_period);
     }
 
-    auto current_inventory = pastRecords[QStringLiteral("inventory_quantity")][current_day];
-    qint64 pipeline_inventory = 0;
-
-    for (quint32 i = current_day + 1;
-         i < qMin(current_day + m_lead_time + 1, quint32(pastRecords[QStringLiteral("procurement_quantity")].size()));
-         ++i)
-    {
-        pipeline_inventory += pastRecords[QStringLiteral("procurement_quantity")][i];
-    }
+    auto current_inventory = decision.on_hand;
+    qint64 pipeline_inventory = decision.pipeline;
 
     qint64 inventory_position = current_inventory + pipeline_inventory;
     double protection_interval = m_review_period + m_lead_time;
@@ -98,6 +100,16 @@ QString PurchaseTPOP::get_calculation_details(
     QString details;
     QTextStream ss(&details);
 
+    if (m_tuned)
+    {
+        ss << "Target = " << m_target_level << ", R = " << m_review_period << " (tuned)\n"
+           << "INV = I + P = " << current_inventory << " + " << pipeline_inventory
+           << " = " << inventory_position << "\n\t"
+           << "Order = max(0, Target - IP) = "
+           << decision.quantity;
+        return details;
+    }
+
     ss << "Protection Interval = R + LT = " << m_review_period << " + "
        << m_lead_time << " = " << protection_interval << "\n"
        << "Target = D×(R+LT) + SS = " << m_average_daily_demand << "×"
@@ -106,7 +118,7 @@ QString PurchaseTPOP::get_calculation_details(
        << " = " << inventory_position << "\n\t"
        << "Order = max(0, Target - IP) = max(0, " << m_target_level << " - "
        << inventory_position << ") = "
-       << qMax(qint64{0}, static_cast<qint64>(std::ceil(m_target_level - inventory_position)));
+       << decision.quantity;
 
     return details;
 }
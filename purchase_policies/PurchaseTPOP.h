@@ -10,25 +10,36 @@ class PurchaseTPOP : public PurchasePolicy
     Q_OBJECT
 
 public:
+    // Explicit decision variables, e.g. found by the policy optimizer
+    struct Parameters
+    {
+        quint32 review_period;
+        double target_level;
+    };
+
     PurchaseTPOP(quint32 leadTime, double avgDemand, quint32 reviewPeriod, QObject *parent = nullptr);
+    PurchaseTPOP(quint32 leadTime, const Parameters &parameters, QObject *parent = nullptr);
+
+    [[nodiscard]] Parameters parameters() const { return {m_review_period, m_target_level}; }
 
-    [[nodiscard]] qint64 get_purchase(const simulation_records_t &pastRecords,
-                                      quint32 current_day) const override;
+    [[nodiscard]] qint64 get_purchase(const InventoryPosition &state) const override;
 
     [[nodiscard]] QString name() const override;
 
+    [[nodiscard]] double decision_threshold() const override { return m_target_level; }
+
+    [[nodiscard]] QString explain(const DecisionRecord &decision) const override;
+
 private:
     quint32 m_lead_time;
     double m_average_daily_demand;
     quint32 m_review_period;
     double m_target_level;
+    bool m_tuned{false};
 
     void calculate_target_level();
     void validate_parameters() const;
     [[nodiscard]] bool is_review_day(quint32 day) const;
-    [[nodiscard]] QString get_calculation_details(
-        const simulation_records_t &pastRecords,
-        quint32 current_day) const override;
 };
 
 #endif // CHAINSIM_PURCHASETPOP_H
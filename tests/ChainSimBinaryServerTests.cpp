@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include <QUrlQuery>
+#include "../ChainSimBinaryServer.h"
+#include "../ChainSimServer.h"
+
+namespace
+{
+    qz::wire::Response call(const qz::wire::SimulateRequest &request)
+    {
+        std::string frame, out;
+        qz::wire::encode_request(frame, request);
+        qz::ChainSimBinaryServer::handleRequest(frame.data() + 4, frame.size() - 4, out);
+        EXPECT_EQ(qz::wire::frame_size(out.data(), out.size(), SIZE_MAX), out.size());
+        return qz::wire::decode_response(out.data() + 4, out.size() - 4);
+    }
+
+    qz::wire::SimulateRequest eoq_request()
+    {
+        qz::wire::SimulateRequest request;
+        request.id = 99;
+        request.policy = qz::wire::Policy::EOQ;
+        request.distribution = qz::wire::Distribution::Normal;
+        request.simulation_length = 120;
+        request.lead_time = 5;
+        request.seed = 3;
+        request.starting_inventory = 200;
+        request.average_demand = 50.0;
+        request.std_demand = 10.0;
+        request.ordering_cost = 100.0;
+        request.holding_cost = 0.2;
+        return request;
+    }
+}
+
+TEST(ChainSimBinaryServerTest, MatchesTheHttpSimulation)
+{
+    auto response = call(eoq_request());
+    ASSERT_EQ(response.type, qz::wire::MessageType::Result);
+    EXPECT_EQ(response.id, 99u);
+
+    QUrlQuery query("simulation_length=120&average_lead_time=5&average_demand=50&std_demand=10&seed=3"
+                    "&starting_inventory=200&policy=EOQ&ordering_cost=100&holding_cost=0.2&demand_distribution=normal");
+    auto simulation = qz::ChainSimServer::createSimulation(query);
+    auto policy = qz::ChainSimServer::createPolicy(query);
+    simulation->initialize_simulation();
+    simulation->simulate(*policy);
+
+    auto records = simulation->get_simulation_records();
+    ASSERT_EQ(response.columns.size(), static_cast<std::size_t>(records.size()));
+    for (const auto &[name, values] : response.columns)
+    {
+        auto expected = records.value(QString::fromStdString(name));
+        EXPECT_EQ(values, std::vector<std::int64_t>(expected.begin(), expected.end())) << name;
+    }
+    EXPECT_EQ(response.kpis.total_sales, simulation->get_kpis().total_sales);
+    EXPECT_DOUBLE_EQ(response.kpis.service_level, simulation->get_kpis().service_level);
+}
+
+TEST(ChainSimBinaryServerTest, SummaryOnlyCarriesNoColumns)
+{
+    auto request = eoq_request();
+    request.flags = qz::wire::kSummaryOnly;
+    auto response = call(request);
+    ASSERT_EQ(response.type, qz::wire::MessageType::Result);
+    EXPECT_TRUE(response.columns.empty());
+    EXPECT_EQ(response.kpis.days, 120u);
+}
+
+TEST(ChainSimBinaryServerTest, InvalidScenariosAnswerWithAnError)
+{
+    auto request = eoq_request();
+    request.lead_time = 120; // Not less than the simulation length
+    auto response = call(request);
+    EXPECT_EQ(response.type, qz::wire::MessageType::Error);
+    EXPECT_EQ(response.id, 99u);
+    EXPECT_EQ(response.error, "Lead time must be less than simulation length");
+}
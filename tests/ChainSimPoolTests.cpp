@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include "../ChainSimBuilder.h"
+#include "../ChainSimPool.h"
+#include "../purchase_policies/PurchaseROP.h"
+#include "TestSimulation.hpp"
+
+namespace
+{
+    qz::ChainSimConfig config(unsigned seed, const QString &distribution = "normal", quint64 days = 365)
+    {
+        qz::test::TestSimulation setup;
+        setup.days = days;
+        setup.lead_time = 5;
+        setup.distribution = distribution;
+        setup.demand = 50.0;
+        setup.stddev = 10.0;
+        setup.seed = seed;
+        setup.starting_inventory = 200;
+        return setup.config();
+    }
+
+    qz::ChainSim::simulation_records_t run(qz::ChainSim &simulation)
+    {
+        PurchaseROP policy(5, 50.0);
+        simulation.initialize_simulation();
+        simulation.simulate(policy);
+        return simulation.get_simulation_records();
+    }
+}
+
+TEST(ChainSimPoolTest, ReusedEnginesMatchFreshOnes)
+{
+    qz::ChainSimPool pool;
+    qz::ChainSim *first = nullptr;
+    {
+        auto simulation = pool.acquire(config(1));
+        first = simulation.get();
+        run(*simulation);
+    }
+    EXPECT_EQ(pool.idle(), 1u);
+
+    // Same demand model, new seed: the engine and its sampler are reused
+    auto simulation = pool.acquire(config(2));
+    EXPECT_EQ(simulation.get(), first);
+    EXPECT_EQ(pool.idle(), 0u);
+    EXPECT_EQ(run(*simulation), run(*qz::ChainSimBuilder().setConfig(config(2)).create()));
+
+    // Another distribution and horizon on the same engine
+    simulation->reset(config(3, "poisson", 90));
+    auto records = run(*simulation);
+    EXPECT_EQ(records["inventory_quantity"].size(), 90);
+    EXPECT_EQ(records, run(*qz::ChainSimBuilder().setConfig(config(3, "poisson", 90)).create()));
+}
+
+TEST(ChainSimPoolTest, KeepsOnlyBoundedEngines)
+{
+    qz::ChainSimPool pool(2);
+    {
+        auto a = pool.acquire(config(1));
+        auto b = pool.acquire(config(2));
+        auto c = pool.acquire(config(3));
+    }
+    EXPECT_EQ(pool.idle(), 2u);
+
+    {
+        auto large = pool.acquire(config(4, "normal", qz::ChainSimPool::kMaxPooledDays + 1));
+    }
+    EXPECT_EQ(pool.idle(), 1u); // Taken from the pool and freed rather than returned
+
+    auto invalid = config(5);
+    invalid.lead_time = 0;
+    EXPECT_THROW(pool.acquire(invalid), std::invalid_argument);
+}
@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+#include "../utils/Confidence.hpp"
+#include "../utils/Parallel.hpp"
+#include <atomic>
+#include <stdexcept>
+
+TEST(ConfidenceTest, QuantilesMatchTables)
+{
+    EXPECT_NEAR(qz::normal_quantile(0.975), 1.959964, 1e-6);
+    EXPECT_NEAR(qz::normal_quantile(0.005), -2.575829, 1e-6);
+
+    // Two-sided 95% critical values
+    EXPECT_NEAR(qz::t_quantile(0.975, 1), 12.706, 1e-3);
+    EXPECT_NEAR(qz::t_quantile(0.975, 2), 4.303, 1e-3);
+    EXPECT_NEAR(qz::t_quantile(0.975, 5), 2.571, 0.01 * 2.571);
+    EXPECT_NEAR(qz::t_quantile(0.975, 15), 2.131, 1e-3);
+    EXPECT_NEAR(qz::t_quantile(0.975, 120), 1.980, 1e-3);
+}
+
+TEST(ConfidenceTest, IntervalAroundMean)
+{
+    qz::RunningStats stats;
+    for (double x : {9.0, 10.0, 11.0, 10.0, 10.0})
+        stats.add(x);
+
+    auto ci = qz::confidence_interval(stats, 0.95);
+    EXPECT_DOUBLE_EQ(ci.mean, 10.0);
+    // t(0.975, 4) * sqrt(0.5) / sqrt(5) = 2.776 * 0.3162
+    EXPECT_NEAR(ci.half_width, 0.878, 0.01);
+    EXPECT_LT(ci.lower(), 10.0);
+    EXPECT_GT(ci.upper(), 10.0);
+}
+
+TEST(ParallelTest, VisitsEveryIndexOnce)
+{
+    std::vector<std::atomic<int>> visits(1000);
+    qz::parallel_for(visits.size(), 4, [&](std::size_t i)
+                     { visits[i].fetch_add(1); });
+    for (const auto &count : visits)
+        EXPECT_EQ(count.load(), 1);
+}
+
+TEST(ParallelTest, RethrowsWorkerException)
+{
+    EXPECT_THROW(qz::parallel_for(100, 4, [](std::size_t i)
+                                  { if (i == 42) throw std::runtime_error("boom"); }),
+                 std::runtime_error);
+}
+
+TEST(ParallelTest, MapKeepsResultsInIndexOrder)
+{
+    auto squares = qz::parallel_map(1000, 4, [](std::size_t i)
+                                    { return i * i; });
+    ASSERT_EQ(squares.size(), 1000u);
+    for (std::size_t i = 0; i < squares.size(); ++i)
+        EXPECT_EQ(squares[i], i * i);
+}
@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+#include "../ChainSimBuilder.h"
+#include "../purchase_policies/PurchaseEOQ.h"
+#include "../purchase_policies/PurchaseTPOP.h"
+#include "../utils/DecisionTrace.hpp"
+
+TEST(DecisionTraceTest, ParsesDayLists)
+{
+    auto days = qz::DecisionTrace::parse_days("20-22, 10,21");
+    EXPECT_EQ(days, (std::vector<quint64>{10, 20, 21, 22}));
+
+    EXPECT_THROW(qz::DecisionTrace::parse_days("5-3"), std::invalid_argument);
+    EXPECT_THROW(qz::DecisionTrace::parse_days("ten"), std::invalid_argument);
+    EXPECT_THROW(qz::DecisionTrace::parse_days("1-100000"), std::invalid_argument);
+}
+
+TEST(DecisionTraceTest, RecordsEveryDayAndExplainsLazily)
+{
+    auto simulation = qz::ChainSimBuilder()
+                          .setSimulationName("TraceTest")
+                          .setSimulationLength(120)
+                          .setLeadTime(3)
+                          .setAverageDemand(20.0)
+                          .setDemandStdDev(6.0)
+                          .setStartingInventory(100)
+                          .setRecordHistory(false)
+                          .setTraceDecisions(true)
+                          .create();
+    PurchaseEOQ policy(3, 20.0, 100.0, 0.2);
+    simulation->initialize_simulation();
+    simulation->simulate(policy);
+
+    const auto &decisions = simulation->get_decisions();
+    ASSERT_EQ(decisions.size(), 119u); // Days 1 .. 119
+    EXPECT_EQ(decisions.find(0), nullptr);
+    EXPECT_EQ(decisions.find(120), nullptr);
+
+    qint64 ordered = 0;
+    for (quint64 day = 1; day < 120; ++day)
+    {
+        const auto *decision = decisions.find(day);
+        ASSERT_NE(decision, nullptr);
+        EXPECT_EQ(decision->day, day);
+        EXPECT_EQ(decision->quantity, policy.get_purchase(decision->state()));
+        EXPECT_EQ(policy.explain(*decision), policy.get_calculation_details(decision->state()));
+        ordered += decision->quantity;
+    }
+    EXPECT_EQ(ordered, simulation->get_kpis().total_purchases);
+}
+
+TEST(DecisionTraceTest, ExplanationsUseTheRecordedState)
+{
+    PurchaseTPOP policy(2, 10.0, 7);
+    auto review = policy.record_decision({14, 5, 0}, policy.get_purchase({14, 5, 0}));
+    EXPECT_GT(review.quantity, 0);
+    EXPECT_DOUBLE_EQ(review.threshold, policy.parameters().target_level);
+    EXPECT_TRUE(policy.explain(review).contains(QString::number(review.quantity)));
+
+    auto idle = policy.record_decision({15, 5, 0}, 0);
+    EXPECT_TRUE(policy.explain(idle).startsWith("Not a review day"));
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include "../utils/DemandSampler.hpp"
+
+namespace
+{
+    // P(X > threshold) by plain sampling and by tilted sampling reweighted with likelihood ratios
+    template <typename Sampler>
+    void expectUnbiasedTilt(Sampler nominal, Sampler tilted, double mean_factor, double threshold)
+    {
+        tilted.setTilt(mean_factor);
+
+        constexpr int kSamples = 400000;
+        double plain = 0.0, weighted = 0.0, weights = 0.0;
+        for (int i = 0; i < kSamples; ++i)
+        {
+            plain += nominal.sample() > threshold ? 1.0 : 0.0;
+            double x = tilted.sample();
+            double weight = std::exp(tilted.logLikelihoodRatio(x));
+            weighted += x > threshold ? weight : 0.0;
+            weights += weight;
+        }
+
+        EXPECT_NEAR(weights / kSamples, 1.0, 0.02);
+        EXPECT_NEAR(weighted / plain, 1.0, 0.1);
+    }
+}
+
+TEST(DemandSamplerTest, TiltedNormalIsReweightedIncludingTruncation)
+{
+    expectUnbiasedTilt(qz::NormalDemandSampler(10.0, 8.0, 1), qz::NormalDemandSampler(10.0, 8.0, 2), 1.8, 25.0);
+}
+
+TEST(DemandSamplerTest, TiltedGammaIsReweighted)
+{
+    expectUnbiasedTilt(qz::GammaDemandSampler(2.0, 5.0, 1), qz::GammaDemandSampler(2.0, 5.0, 2), 1.8, 30.0);
+}
+
+TEST(DemandSamplerTest, TiltedPoissonIsReweighted)
+{
+    expectUnbiasedTilt(qz::PoissonDemandSampler(10.0, 1), qz::PoissonDemandSampler(10.0, 2), 1.8, 18.0);
+}
+
+TEST(DemandSamplerTest, UntiltableDistributionsRejectTilt)
+{
+    qz::FixedDemandSampler fixed(10.0);
+    EXPECT_NO_THROW(fixed.setTilt(1.0));
+    EXPECT_THROW(fixed.setTilt(1.5), std::invalid_argument);
+
+    qz::PoissonDemandSampler poisson(10.0, 1);
+    poisson.setTilt(1.5);
+    poisson.setTilt(1.0);
+    EXPECT_DOUBLE_EQ(poisson.logLikelihoodRatio(12.0), 0.0);
+}
+
+TEST(DemandSamplerTest, ReseedRepeatsAFreshSampler)
+{
+    auto expectSameDraws = [](qz::DemandSampler &reused, qz::DemandSampler &fresh)
+    {
+        for (int i = 0; i < 1000; ++i)
+        {
+            ASSERT_EQ(reused.sample(), fresh.sample()) << "draw " << i;
+        }
+    };
+
+    // Odd draw counts leave the normal distribution holding a cached second value
+    qz::NormalDemandSampler normal(50.0, 10.0, 1), fresh_normal(50.0, 10.0, 9);
+    for (int i = 0; i < 7; ++i)
+        normal.sample();
+    normal.reseed(9);
+    expectSameDraws(normal, fresh_normal);
+
+    qz::GammaDemandSampler gamma(2.0, 5.0, 1), fresh_gamma(2.0, 5.0, 9);
+    gamma.sample();
+    gamma.reseed(9);
+    expectSameDraws(gamma, fresh_gamma);
+
+    qz::PoissonDemandSampler poisson(10.0, 1), fresh_poisson(10.0, 9);
+    poisson.setTilt(1.5);
+    poisson.sample();
+    poisson.setTilt(1.0);
+    poisson.reseed(9);
+    expectSameDraws(poisson, fresh_poisson);
+
+    qz::UniformDemandSampler uniform(30.0, 70.0, 1), fresh_uniform(30.0, 70.0, 9);
+    uniform.sample();
+    uniform.reseed(9);
+    expectSameDraws(uniform, fresh_uniform);
+}
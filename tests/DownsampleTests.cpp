@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include "../utils/Downsample.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+TEST(DownsampleTest, LTTBKeepsEndpointsAndThreshold)
+{
+    std::vector<std::int64_t> values(1000);
+    for (std::size_t i = 0; i < values.size(); ++i)
+        values[i] = static_cast<std::int64_t>(i % 37);
+
+    auto indices = qz::lttb_indices(values.data(), values.size(), 100);
+
+    EXPECT_EQ(indices.size(), 100u);
+    EXPECT_EQ(indices.front(), 0u);
+    EXPECT_EQ(indices.back(), values.size() - 1);
+    EXPECT_TRUE(std::is_sorted(indices.begin(), indices.end()));
+}
+
+TEST(DownsampleTest, LTTBReturnsAllPointsBelowThreshold)
+{
+    std::vector<std::int64_t> values = {5, 3, 8, 1};
+
+    auto indices = qz::lttb_indices(values.data(), values.size(), 10);
+
+    EXPECT_EQ(indices, (std::vector<std::size_t>{0, 1, 2, 3}));
+}
+
+TEST(DownsampleTest, LTTBPicksSpike)
+{
+    std::vector<std::int64_t> values(300, 10);
+    values[150] = 1000;
+
+    auto indices = qz::lttb_indices(values.data(), values.size(), 20);
+
+    EXPECT_NE(std::find(indices.begin(), indices.end(), 150u), indices.end());
+}
+
+TEST(DownsampleTest, MinMaxPreservesExtremes)
+{
+    std::vector<std::int64_t> values(500);
+    for (std::size_t i = 0; i < values.size(); ++i)
+        values[i] = 100 + static_cast<std::int64_t>(i % 50);
+    values[123] = 0;    // stockout
+    values[321] = 9999; // peak
+
+    auto indices = qz::minmax_indices(values.data(), values.size(), 40);
+
+    EXPECT_LE(indices.size(), 40u);
+    EXPECT_TRUE(std::is_sorted(indices.begin(), indices.end()));
+    EXPECT_NE(std::find(indices.begin(), indices.end(), 123u), indices.end());
+    EXPECT_NE(std::find(indices.begin(), indices.end(), 321u), indices.end());
+}
@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+#include "../utils/JsonWriter.hpp"
+#include "../utils/RequestArena.hpp"
+#include <vector>
+
+TEST(JsonWriterTest, WritesNestedDocument)
+{
+    std::pmr::string out;
+    qz::JsonWriter json(out);
+
+    std::vector<long long> values = {0, -5, 42};
+    json.begin_object();
+    json.key("name");
+    json.value("a\"b\n");
+    json.key("ok");
+    json.value(true);
+    json.key("ratio");
+    json.value(0.5);
+    json.key("values");
+    json.integer_array(values.data(), values.size());
+    json.key("nested");
+    json.begin_array();
+    json.value(1);
+    json.begin_object();
+    json.end_object();
+    json.end_array();
+    json.end_object();
+
+    EXPECT_EQ(out, R"({"name":"a\"b\n","ok":true,"ratio":0.5,"values":[0,-5,42],"nested":[1,{}]})");
+}
+
+TEST(RequestArenaTest, GrowsToHighWaterMark)
+{
+    qz::RequestArena arena(1024);
+    {
+        std::pmr::string big(arena.resource());
+        big.assign(10000, 'x');
+    }
+    arena.reset();
+
+    std::size_t grown = arena.capacity();
+    EXPECT_GE(grown, 10000u);
+
+    // A request of the same size now fits in the retained buffer
+    {
+        std::pmr::string again(arena.resource());
+        again.assign(10000, 'y');
+    }
+    arena.reset();
+    EXPECT_EQ(arena.capacity(), grown);
+}
+
+TEST(RequestArenaTest, PoolReusesArenas)
+{
+    qz::RequestArena *first = nullptr;
+    {
+        auto lease = qz::ArenaPool::acquire();
+        first = &*lease;
+    }
+    auto lease = qz::ArenaPool::acquire();
+    EXPECT_EQ(&*lease, first);
+}
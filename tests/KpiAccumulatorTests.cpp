@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include "../utils/KpiAccumulator.hpp"
+#include <numeric>
+#include <vector>
+
+TEST(RunningStatsTest, MatchesTwoPassStatistics)
+{
+    // Large offset: naive sum-of-squares loses precision here, Welford does not
+    std::vector<double> values;
+    for (int i = 0; i < 1000; ++i)
+        values.push_back(1e9 + (i % 7));
+
+    qz::RunningStats stats;
+    for (double v : values)
+        stats.add(v);
+
+    double mean = std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+    double ss = 0.0;
+    for (double v : values)
+        ss += (v - mean) * (v - mean);
+
+    EXPECT_DOUBLE_EQ(stats.mean(), mean);
+    EXPECT_NEAR(stats.variance(), ss / (values.size() - 1), 1e-6);
+    EXPECT_EQ(stats.min(), 1e9);
+    EXPECT_EQ(stats.max(), 1e9 + 6);
+}
+
+TEST(RunningStatsTest, MergeEqualsSequential)
+{
+    qz::RunningStats all, left, right;
+    for (int i = 0; i < 100; ++i)
+    {
+        all.add(i * 0.5);
+        (i < 37 ? left : right).add(i * 0.5);
+    }
+    left.merge(right);
+
+    EXPECT_EQ(left.count(), all.count());
+    EXPECT_NEAR(left.mean(), all.mean(), 1e-12);
+    EXPECT_NEAR(left.variance(), all.variance(), 1e-9);
+}
+
+TEST(KpiAccumulatorTest, SummarizesDays)
+{
+    qz::KpiAccumulator kpis;
+    kpis.add_day(100, 50, 0, 0, 0);
+    kpis.add_day(50, 50, 50, 0, 0);
+    kpis.add_day(0, 80, 50, 30, 120);
+
+    auto summary = kpis.summary();
+    EXPECT_EQ(summary.days, 3u);
+    EXPECT_EQ(summary.total_demand, 180);
+    EXPECT_EQ(summary.total_sales, 100);
+    EXPECT_EQ(summary.total_lost_sales, 30);
+    EXPECT_EQ(summary.total_purchases, 120);
+    EXPECT_EQ(summary.order_count, 1u);
+    EXPECT_EQ(summary.stockout_days, 1u);
+    EXPECT_DOUBLE_EQ(summary.service_level, 100.0 * 100 / 180);
+    EXPECT_DOUBLE_EQ(summary.average_inventory, 50.0);
+    EXPECT_DOUBLE_EQ(summary.inventory_turns, 2.0);
+    EXPECT_EQ(summary.peak_inventory, 100);
+    EXPECT_EQ(summary.min_inventory, 0);
+}
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include "../analysis/MarkovEvaluator.h"
+#include "../purchase_policies/PurchaseROP.h"
+#include "../purchase_policies/PurchaseTPOP.h"
+#include "TestSimulation.hpp"
+
+namespace
+{
+    std::unique_ptr<qz::ChainSim> poissonSimulation(quint64 days, quint64 lead_time, double demand, quint64 start)
+    {
+        qz::test::TestSimulation setup;
+        setup.days = days;
+        setup.lead_time = lead_time;
+        setup.distribution = "poisson";
+        setup.demand = demand;
+        setup.starting_inventory = start;
+        setup.record_history = false;
+        return setup.create();
+    }
+}
+
+TEST(MarkovEvaluatorTest, MatchesLongSimulationForROP)
+{
+    PurchaseROP policy(2, PurchaseROP::Parameters{20, 30});
+    qz::MarkovEvaluator evaluator("poisson", 8.0, 2, 40, 500000);
+
+    auto evaluation = evaluator.evaluate(policy, []
+                                         { return poissonSimulation(500000, 2, 8.0, 40); });
+    ASSERT_TRUE(evaluation.analytical);
+    EXPECT_LT(evaluation.residual, 1e-8);
+
+    auto simulation = poissonSimulation(500000, 2, 8.0, 40);
+    simulation->initialize_simulation();
+    simulation->simulate(policy);
+    auto simulated = simulation->get_kpis();
+
+    EXPECT_NEAR(evaluation.kpis.service_level, simulated.service_level, 0.05);
+    EXPECT_NEAR(evaluation.kpis.average_inventory, simulated.average_inventory, 0.2);
+    EXPECT_NEAR(evaluation.kpis.inventory_stddev, simulated.inventory_stddev, 0.2);
+}
+
+TEST(MarkovEvaluatorTest, PeriodicReviewWithFixedDemandIsExact)
+{
+    // Orders of 7 x 3 every third day, due two days later: inventory cycles 16, 9, 2
+    PurchaseTPOP policy(2, PurchaseTPOP::Parameters{3, 30.0});
+    qz::MarkovEvaluator evaluator("fixed", 7.0, 2, 30, 300);
+
+    auto evaluation = evaluator.evaluate(policy, []
+                                         { return poissonSimulation(300, 2, 7.0, 30); });
+    ASSERT_TRUE(evaluation.analytical);
+    EXPECT_DOUBLE_EQ(evaluation.kpis.service_level, 100.0);
+    EXPECT_NEAR(evaluation.kpis.average_inventory, 9.0, 1e-9);
+    EXPECT_EQ(evaluation.kpis.order_count, 100u);
+}
+
+TEST(MarkovEvaluatorTest, ContinuousDemandFallsBackToSimulation)
+{
+    PurchaseROP policy(2, 8.0);
+    qz::MarkovEvaluator evaluator("normal", 8.0, 2, 40, 1000);
+
+    auto evaluation = evaluator.evaluate(policy, []
+                                         { return poissonSimulation(1000, 2, 8.0, 40); });
+    EXPECT_FALSE(evaluation.analytical);
+    EXPECT_FALSE(evaluation.fallback_reason.isEmpty());
+    EXPECT_EQ(evaluation.kpis.days, 1000u);
+}
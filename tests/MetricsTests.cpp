@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include "../utils/Metrics.hpp"
+#include <thread>
+
+TEST(MetricsTest, LatencyBucketsAreMonotonic)
+{
+    int previous = -1;
+    for (std::uint64_t micros : {0ull, 1ull, 15ull, 16ull, 17ull, 31ull, 32ull, 1000ull, 1000000ull, 1ull << 39})
+    {
+        int index = qz::LatencyBuckets::index(micros);
+        EXPECT_GT(index, previous);
+        EXPECT_LT(index, qz::LatencyBuckets::kCount);
+        EXPECT_LT(micros, qz::LatencyBuckets::upper_bound(index));
+        previous = index;
+    }
+}
+
+TEST(MetricsTest, PowerOfTwoBoundariesAlignWithBuckets)
+{
+    for (int exponent = 4; exponent <= 25; ++exponent)
+    {
+        std::uint64_t boundary = std::uint64_t{1} << exponent;
+        EXPECT_EQ(qz::LatencyBuckets::index(boundary - 1) + 1,
+                  qz::LatencyBuckets::buckets_below_power_of_two(exponent));
+        EXPECT_EQ(qz::LatencyBuckets::index(boundary),
+                  qz::LatencyBuckets::buckets_below_power_of_two(exponent));
+    }
+}
+
+TEST(MetricsTest, ExpositionSumsThreadShards)
+{
+    auto &metrics = qz::ServerMetrics::instance();
+
+    auto record = [&metrics]()
+    {
+        for (int i = 0; i < 100; ++i)
+        {
+            qz::ScopedRequest request(qz::ServerMetrics::Route::Series);
+            request.set_status(404);
+        }
+    };
+    std::thread first(record), second(record);
+    first.join();
+    second.join();
+
+    auto text = metrics.exposition();
+    EXPECT_NE(text.find("chainsim_requests_total{route=\"series\",status=\"404\"} 200"), std::string::npos);
+    EXPECT_NE(text.find("chainsim_requests_in_progress 0"), std::string::npos);
+}
+
+TEST(MetricsTest, ScrapeDoesNotCountItself)
+{
+    auto &metrics = qz::ServerMetrics::instance();
+
+    qz::ScopedRequest scrape(qz::ServerMetrics::Route::Metrics);
+    auto text = metrics.exposition();
+    EXPECT_NE(text.find("chainsim_requests_in_progress 0"), std::string::npos);
+}
+
+TEST(MetricsTest, OpenRequestsOnTheScrapingThreadAreInProgress)
+{
+    auto &metrics = qz::ServerMetrics::instance();
+
+    // A stream stays open on the server thread while later requests, scrapes included, are handled
+    qz::ScopedRequest stream(qz::ServerMetrics::Route::Stream);
+    qz::ScopedRequest scrape(qz::ServerMetrics::Route::Metrics);
+    auto text = metrics.exposition();
+    EXPECT_NE(text.find("chainsim_requests_in_progress 1"), std::string::npos);
+}
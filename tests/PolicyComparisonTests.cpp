@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include "../analysis/PolicyComparison.h"
+#include "../purchase_policies/PurchaseEOQ.h"
+#include "../purchase_policies/PurchaseROP.h"
+#include "../purchase_policies/PurchaseTPOP.h"
+#include "TestSimulation.hpp"
+
+namespace
+{
+    std::unique_ptr<qz::ChainSim> simulation(unsigned seed)
+    {
+        qz::test::TestSimulation setup;
+        setup.seed = seed;
+        setup.record_history = false;
+        setup.track_distributions = false;
+        return setup.create();
+    }
+
+    std::vector<qz::PolicyComparison::PolicyFactory> policies()
+    {
+        return {[]
+                { return std::make_unique<PurchaseROP>(3, 20.0); },
+                []
+                { return std::make_unique<PurchaseEOQ>(3, 20.0, 100.0, 0.2); },
+                []
+                { return std::make_unique<PurchaseTPOP>(3, 20.0, 7); }};
+    }
+}
+
+TEST(PolicyComparisonTest, FusedLanesMatchSeparateRuns)
+{
+    auto factories = policies();
+    std::vector<std::unique_ptr<PurchasePolicy>> owned;
+    std::vector<const PurchasePolicy *> lanes;
+    for (const auto &factory : factories)
+    {
+        owned.push_back(factory());
+        lanes.push_back(owned.back().get());
+    }
+
+    auto fused = simulation(7)->simulate_policies(lanes);
+    ASSERT_EQ(fused.size(), lanes.size());
+    for (std::size_t lane = 0; lane < lanes.size(); ++lane)
+    {
+        auto separate = simulation(7);
+        separate->initialize_simulation();
+        separate->simulate(*lanes[lane]);
+        auto kpis = separate->get_kpis();
+
+        EXPECT_EQ(fused[lane].days, kpis.days);
+        EXPECT_EQ(fused[lane].total_demand, kpis.total_demand);
+        EXPECT_EQ(fused[lane].total_sales, kpis.total_sales);
+        EXPECT_EQ(fused[lane].total_lost_sales, kpis.total_lost_sales);
+        EXPECT_EQ(fused[lane].order_count, kpis.order_count);
+        EXPECT_DOUBLE_EQ(fused[lane].average_inventory, kpis.average_inventory);
+    }
+}
+
+TEST(PolicyComparisonTest, PairedDifferencesAreTighterThanUnpaired)
+{
+    qz::ComparisonOptions options;
+    options.replications = 32;
+    options.threads = 2;
+    qz::PolicyComparison comparison(simulation, {"ROP", "EOQ", "TPOP"}, policies(), options);
+    auto result = comparison.compare();
+
+    ASSERT_EQ(result.policies.size(), 3u);
+    ASSERT_EQ(result.differences.size(), 2u);
+    EXPECT_EQ(result.differences[0].baseline, "ROP");
+
+    // Every policy sees the same demand, so total demand never differs and the KPIs are correlated
+    auto total_demand = qz::PolicyComparison::kpi_names().indexOf("total_demand");
+    EXPECT_EQ(result.differences[0].kpis[total_demand].half_width, 0.0);
+
+    auto inventory = qz::PolicyComparison::kpi_names().indexOf("average_inventory");
+    const auto &difference = result.differences[1];
+    double unpaired = std::hypot(result.policies[0].kpis[inventory].half_width,
+                                 result.policies[2].kpis[inventory].half_width);
+    EXPECT_GT(difference.correlations[inventory], 0.0);
+    EXPECT_LT(difference.kpis[inventory].half_width, unpaired);
+}
+
+TEST(PolicyComparisonTest, ResultsDoNotDependOnThreadCount)
+{
+    qz::ComparisonOptions options;
+    options.replications = 8;
+    options.threads = 1;
+    auto serial = qz::PolicyComparison(simulation, {"ROP", "TPOP"}, {policies()[0], policies()[2]}, options).compare();
+    options.threads = 4;
+    auto parallel = qz::PolicyComparison(simulation, {"ROP", "TPOP"}, {policies()[0], policies()[2]}, options).compare();
+
+    for (std::size_t k = 0; k < serial.differences[0].kpis.size(); ++k)
+        EXPECT_DOUBLE_EQ(serial.differences[0].kpis[k].mean, parallel.differences[0].kpis[k].mean);
+}
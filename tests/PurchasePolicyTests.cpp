@@ -2,24 +2,17 @@
 #include "../purchase_policies/PurchaseROP.h"
 #include "../purchase_policies/PurchaseEOQ.h"
 #include "../purchase_policies/PurchaseTPOP.h"
-#include <unordered_map>
 #include <vector>
 #include <cmath>
 
 class PurchasePolicyTest : public ::testing::Test
 {
 protected:
-    void SetUp() override
+    // What a policy sees on `day`: inventory on hand and units ordered but not yet received
+    static InventoryPosition at(quint64 day, qint64 on_hand, qint64 pipeline = 0)
     {
-        records["inventory_quantity"] = std::vector<long>(30, 0);
-        records["demand_quantity"] = std::vector<long>(30, 50);
-        records["procurement_quantity"] = std::vector<long>(30, 0);
-        records["purchase_quantity"] = std::vector<long>(30, 0);
-        records["sale_quantity"] = std::vector<long>(30, 0);
-        records["lost_sale_quantity"] = std::vector<long>(30, 0);
+        return InventoryPosition{day, on_hand, pipeline};
     }
-
-    std::unordered_map<std::string, std::vector<long>> records;
 };
 
 TEST_F(PurchasePolicyTest, ROPBasicFunctionality)
@@ -27,13 +20,11 @@ TEST_F(PurchasePolicyTest, ROPBasicFunctionality)
     PurchaseROP policy(5, 50.0);
 
     // Test when inventory is below reorder point
-    records["inventory_quantity"][10] = 100;
-    auto purchase = policy.get_purchase(records, 10);
+    auto purchase = policy.get_purchase(at(10, 100));
     EXPECT_GT(purchase, 0);
 
     // Test when inventory is above reorder point
-    records["inventory_quantity"][11] = 1000;
-    purchase = policy.get_purchase(records, 11);
+    purchase = policy.get_purchase(at(11, 1000));
     EXPECT_EQ(purchase, 0);
 }
 
@@ -46,8 +37,7 @@ TEST_F(PurchasePolicyTest, ROPReorderPoint)
 
     for (auto level : testLevels)
     {
-        records["inventory_quantity"][0] = level;
-        auto purchase = policy.get_purchase(records, 0);
+        auto purchase = policy.get_purchase(at(0, level));
 
         if (level <= 500)
         { // Assuming reorder point is around 250
@@ -65,8 +55,7 @@ TEST_F(PurchasePolicyTest, EOQBasicFunctionality)
     PurchaseEOQ policy(5, 50.0, 100.0, 0.2);
 
     // Test initial order when inventory is low
-    records["inventory_quantity"][0] = 100;
-    auto purchase = policy.get_purchase(records, 0);
+    auto purchase = policy.get_purchase(at(0, 100));
 
     // EOQ formula: sqrt((2 * annual demand * ordering cost) / holding cost)
     double expected_eoq = std::sqrt((2 * 50.0 * 365 * 100.0) / 0.2);
@@ -77,12 +66,8 @@ TEST_F(PurchasePolicyTest, EOQWithPipelineInventory)
 {
     PurchaseEOQ policy(5, 50.0, 100.0, 0.2);
 
-    // Set up pipeline inventory
-    records["inventory_quantity"][10] = 200;
-    records["procurement_quantity"][11] = 100;
-    records["procurement_quantity"][12] = 100;
-
-    auto purchase = policy.get_purchase(records, 10);
+    // Two deliveries of 100 are on their way
+    auto purchase = policy.get_purchase(at(10, 200, 200));
 
     // With sufficient pipeline inventory, should not order
     EXPECT_EQ(purchase, 0);
@@ -104,8 +89,7 @@ TEST_F(PurchasePolicyTest, TPOPBasicFunctionality)
     // Test ordering pattern
     for (unsigned day = 0; day < 30; ++day)
     {
-        records["inventory_quantity"][day] = 200; // Set consistent inventory level
-        auto purchase = policy.get_purchase(records, day);
+        auto purchase = policy.get_purchase(at(day, 200)); // Consistent inventory level
 
         if (day % 7 == 0)
         { // Review day
@@ -123,8 +107,7 @@ TEST_F(PurchasePolicyTest, TPOPTargetLevel)
     PurchaseTPOP policy(5, 50.0, 7);
 
     // Test target level calculation
-    records["inventory_quantity"][7] = 100; // Low inventory on review day
-    auto purchase = policy.get_purchase(records, 7);
+    auto purchase = policy.get_purchase(at(7, 100)); // Low inventory on review day
 
     // Target level should cover review period + lead time + safety stock
     double expected_min = 50.0 * (7 + 5); // Minimum coverage needed
@@ -135,12 +118,8 @@ TEST_F(PurchasePolicyTest, TPOPWithPipelineInventory)
 {
     PurchaseTPOP policy(5, 50.0, 7);
 
-    // Set up pipeline inventory
-    records["inventory_quantity"][7] = 200;
-    records["procurement_quantity"][8] = 100;
-    records["procurement_quantity"][9] = 100;
-
-    auto purchase = policy.get_purchase(records, 7);
+    // Two deliveries of 100 are on their way
+    auto purchase = policy.get_purchase(at(7, 200, 200));
 
     // Order quantity should consider pipeline inventory
     double expected_without_pipeline = 50.0 * (7 + 5); // Basic coverage
@@ -159,17 +138,11 @@ TEST_F(PurchasePolicyTest, ROPWithVariableDemand)
 {
     PurchaseROP policy(5, 50.0);
 
-    // Test with increasing demand pattern
-    for (unsigned day = 0; day < 30; ++day)
-    {
-        records["demand_quantity"][day] = 50 + day; // Linear increase
-    }
-
-    // Verify more frequent ordering with higher demand
+    // Demand outpacing receipts keeps the shelf empty, so the policy keeps reordering
     int order_count = 0;
     for (unsigned day = 0; day < 30; ++day)
     {
-        if (policy.get_purchase(records, day) > 0)
+        if (policy.get_purchase(at(day, 0)) > 0)
         {
             order_count++;
         }
@@ -183,16 +156,13 @@ TEST_F(PurchasePolicyTest, ROPEdgeCases)
     PurchaseROP policy(5, 50.0);
 
     // Test with zero inventory
-    records["inventory_quantity"][0] = 0;
-    EXPECT_GT(policy.get_purchase(records, 0), 0);
+    EXPECT_GT(policy.get_purchase(at(0, 0)), 0);
 
     // Test with very high inventory
-    records["inventory_quantity"][1] = 10000;
-    EXPECT_EQ(policy.get_purchase(records, 1), 0);
+    EXPECT_EQ(policy.get_purchase(at(1, 10000)), 0);
 
     // Test with inventory exactly at reorder point
-    records["inventory_quantity"][2] = 250; // Assuming reorder point is 250
-    auto purchase = policy.get_purchase(records, 2);
+    auto purchase = policy.get_purchase(at(2, 250)); // Assuming reorder point is 250
     EXPECT_GT(purchase, 0);
 }
 
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "../utils/Histogram.hpp"
+#include "../utils/KpiAccumulator.hpp"
+#include "../utils/QuantileSketch.hpp"
+
+namespace
+{
+    // Fraction of values at or below x
+    double rank_of(const std::vector<double> &sorted, double x)
+    {
+        return static_cast<double>(std::upper_bound(sorted.begin(), sorted.end(), x) - sorted.begin()) /
+               static_cast<double>(sorted.size());
+    }
+}
+
+TEST(QuantileSketchTest, RankErrorIsBoundedAndMemoryIsConstant)
+{
+    std::mt19937_64 rng(42);
+    std::gamma_distribution<double> demand(2.0, 25.0);
+
+    qz::QuantileSketch sketch;
+    std::vector<double> values;
+    for (int i = 0; i < 1000000; ++i)
+    {
+        double x = demand(rng);
+        sketch.add(x);
+        values.push_back(x);
+    }
+    std::sort(values.begin(), values.end());
+
+    EXPECT_EQ(sketch.count(), values.size());
+    EXPECT_LT(sketch.retained(), 1000u);
+    EXPECT_DOUBLE_EQ(sketch.min(), values.front());
+    EXPECT_DOUBLE_EQ(sketch.max(), values.back());
+    for (double q : {0.05, 0.25, 0.5, 0.75, 0.95, 0.99})
+    {
+        EXPECT_NEAR(rank_of(values, sketch.quantile(q)), q, 0.01) << "q = " << q;
+    }
+}
+
+TEST(QuantileSketchTest, MergedSketchesMatchOneSketch)
+{
+    std::mt19937_64 rng(7);
+    std::poisson_distribution<int> demand(40);
+
+    std::vector<qz::QuantileSketch> parts(8);
+    std::vector<double> values;
+    for (int i = 0; i < 400000; ++i)
+    {
+        double x = demand(rng);
+        parts[i % parts.size()].add(x);
+        values.push_back(x);
+    }
+
+    qz::QuantileSketch merged;
+    for (const auto &part : parts)
+        merged.merge(part);
+
+    EXPECT_EQ(merged.count(), values.size());
+    EXPECT_LT(merged.retained(), 1000u);
+    // Demand is discrete, so q must fall within (or within 1% of) the ranks the answer covers
+    std::sort(values.begin(), values.end());
+    for (double q : {0.05, 0.5, 0.95, 0.99})
+    {
+        double x = merged.quantile(q);
+        EXPECT_LE(rank_of(values, x - 1.0) - 0.01, q) << "q = " << q;
+        EXPECT_GE(rank_of(values, x) + 0.01, q) << "q = " << q;
+    }
+}
+
+TEST(QuantileSketchTest, HistogramsMergeBinByBin)
+{
+    qz::Histogram low, high;
+    for (int i = 0; i < 16; ++i)
+        low.add(i);
+    high.add(1000);
+    high.add(-5); // Clamped into the first bin
+
+    low.merge(high);
+    EXPECT_EQ(low.count(), 18u);
+
+    auto bins = low.bins();
+    ASSERT_EQ(bins.size(), 17u);
+    EXPECT_EQ(bins.front().lower, 0u);
+    EXPECT_EQ(bins.front().count, 2u);
+    EXPECT_LE(bins.back().lower, 1000u);
+    EXPECT_GT(bins.back().upper, 1000u);
+}
+
+TEST(QuantileSketchTest, CycleServiceCoversCompletedCycles)
+{
+    qz::KpiAccumulator kpis;
+    kpis.add_day(10, 5, 0, 0, 20);      // Day 0 opens cycle 1
+    kpis.add_day(5, 5, 5, 0, 0);        // 5 of 10 served so far
+    kpis.add_day(0, 10, 5, 5, 0, 0);    // 10 of 20 served
+    kpis.add_day(10, 10, 10, 0, 0, 20); // Delivery closes cycle 1 at 50%
+    kpis.add_day(0, 10, 10, 0, 0, 0);
+    kpis.add_day(15, 5, 5, 0, 0, 20);   // Delivery closes cycle 2 at 100%
+
+    const auto &cycles = kpis.distributions().cycle_service;
+    EXPECT_EQ(cycles.count(), 2u);
+    EXPECT_DOUBLE_EQ(cycles.min(), 50.0);
+    EXPECT_DOUBLE_EQ(cycles.max(), 100.0);
+    EXPECT_EQ(kpis.distributions().inventory.count(), 6u);
+    EXPECT_DOUBLE_EQ(kpis.distributions().lost_sales.quantile(1.0), 5.0);
+}
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include "../analysis/ReplicationRunner.h"
+#include "../purchase_policies/PurchaseROP.h"
+#include "TestSimulation.hpp"
+
+namespace
+{
+    qz::ReplicationRunner::SimulationFactory simulations()
+    {
+        return [](unsigned seed)
+        {
+            qz::test::TestSimulation setup;
+            setup.seed = seed;
+            setup.record_history = false;
+            return setup.create();
+        };
+    }
+
+    qz::ReplicationRunner::PolicyFactory policies()
+    {
+        return []
+        { return std::make_unique<PurchaseROP>(3, 20.0); };
+    }
+}
+
+TEST(ReplicationRunnerTest, ParsesAbsoluteAndRelativeTargets)
+{
+    auto targets = qz::ReplicationRunner::parse_targets("service_level:0.5, average_inventory:2%");
+    ASSERT_EQ(targets.size(), 2u);
+    EXPECT_EQ(targets[0].kpi, "service_level");
+    EXPECT_DOUBLE_EQ(targets[0].half_width, 0.5);
+    EXPECT_FALSE(targets[0].relative);
+    EXPECT_EQ(targets[1].kpi, "average_inventory");
+    EXPECT_DOUBLE_EQ(targets[1].half_width, 0.02);
+    EXPECT_TRUE(targets[1].relative);
+
+    EXPECT_THROW(qz::ReplicationRunner::parse_targets("service_level"), std::invalid_argument);
+    EXPECT_THROW(qz::ReplicationRunner(simulations(), policies(), {{"profit", 1.0, false}}), std::invalid_argument);
+}
+
+TEST(ReplicationRunnerTest, StopsOnceTargetIsMet)
+{
+    qz::ReplicationOptions options;
+    options.threads = 2;
+    qz::ReplicationRunner runner(simulations(), policies(), qz::ReplicationRunner::parse_targets("average_inventory:2%"), options);
+
+    auto result = runner.run();
+    ASSERT_TRUE(result.converged);
+    EXPECT_GE(result.replications, options.min_replications);
+    EXPECT_LT(result.replications, options.max_replications);
+
+    auto estimate = result.estimates[qz::ReplicationRunner::kpi_names().indexOf("average_inventory")];
+    EXPECT_TRUE(estimate.targeted);
+    EXPECT_TRUE(estimate.target_met);
+    EXPECT_LE(estimate.relative_half_width, 0.02);
+}
+
+TEST(ReplicationRunnerTest, ReportsShortfallWhenBudgetRunsOut)
+{
+    qz::ReplicationOptions options;
+    options.max_replications = 12;
+    qz::ReplicationRunner runner(simulations(), policies(), qz::ReplicationRunner::parse_targets("average_inventory:0.001"), options);
+
+    auto result = runner.run();
+    EXPECT_FALSE(result.converged);
+    EXPECT_EQ(result.replications, 12u);
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include "../purchase_policies/PurchaseEOQ.h"
+#include "TestSimulation.hpp"
+
+namespace
+{
+    std::unique_ptr<qz::ChainSim> resumable_simulation(bool resumable = true)
+    {
+        qz::test::TestSimulation setup;
+        setup.days = 400;
+        setup.lead_time = 4;
+        setup.seed = 11;
+        setup.starting_inventory = 120;
+        setup.resumable = resumable;
+        return setup.create();
+    }
+
+    void expect_same_run(const qz::ChainSim &actual, const qz::ChainSim &expected)
+    {
+        EXPECT_EQ(actual.get_current_day(), expected.get_current_day());
+        EXPECT_EQ(actual.get_simulation_records(), expected.get_simulation_records());
+
+        auto a = actual.get_kpis(), e = expected.get_kpis();
+        EXPECT_EQ(a.days, e.days);
+        EXPECT_EQ(a.total_sales, e.total_sales);
+        EXPECT_EQ(a.total_lost_sales, e.total_lost_sales);
+        EXPECT_EQ(a.total_purchases, e.total_purchases);
+        EXPECT_EQ(a.order_count, e.order_count);
+        EXPECT_DOUBLE_EQ(a.average_inventory, e.average_inventory);
+        EXPECT_DOUBLE_EQ(a.inventory_stddev, e.inventory_stddev);
+        EXPECT_DOUBLE_EQ(actual.get_distributions().inventory.quantile(0.5),
+                         expected.get_distributions().inventory.quantile(0.5));
+    }
+}
+
+TEST(ResimulationTest, PolicyChangeMatchesAFreshRun)
+{
+    PurchaseEOQ before(4, PurchaseEOQ::Parameters{90, 150});
+    PurchaseEOQ after(4, PurchaseEOQ::Parameters{90, 180}); // Same reorder point, larger orders
+
+    auto simulation = resumable_simulation();
+    simulation->initialize_simulation();
+    simulation->simulate_days(before, 300);
+
+    auto first = simulation->first_affected_day(after);
+    EXPECT_GT(first, 1u); // Days before the first order are reused
+    EXPECT_LT(first, 301u);
+    simulation->resimulate_from(after, first);
+
+    auto fresh = resumable_simulation();
+    fresh->initialize_simulation();
+    fresh->simulate_days(after, 300);
+    expect_same_run(*simulation, *fresh);
+
+    // The rewound run keeps going from where it was
+    simulation->simulate(after);
+    fresh->simulate(after);
+    expect_same_run(*simulation, *fresh);
+}
+
+TEST(ResimulationTest, ChangeFromADayMatchesASwitchedRun)
+{
+    PurchaseEOQ before(4, PurchaseEOQ::Parameters{90, 150});
+    PurchaseEOQ after(4, PurchaseEOQ::Parameters{60, 150});
+
+    auto simulation = resumable_simulation();
+    simulation->initialize_simulation();
+    simulation->simulate(before);
+    auto first = simulation->first_affected_day(after, 200);
+    EXPECT_GE(first, 200u);
+    simulation->resimulate_from(after, first);
+
+    auto switched = resumable_simulation();
+    switched->initialize_simulation();
+    switched->simulate_days(before, 199);
+    switched->simulate(after);
+    expect_same_run(*simulation, *switched);
+}
+
+TEST(ResimulationTest, UnchangedPolicyReusesEveryDay)
+{
+    PurchaseEOQ policy(4, 20.0, 100.0, 0.2);
+    auto simulation = resumable_simulation();
+    simulation->initialize_simulation();
+    simulation->simulate(policy);
+
+    EXPECT_EQ(simulation->first_affected_day(PurchaseEOQ(4, 20.0, 100.0, 0.2)), simulation->get_current_day());
+}
+
+TEST(ResimulationTest, NeedsAResumableRun)
+{
+    PurchaseEOQ policy(4, 20.0, 100.0, 0.2);
+    auto simulation = resumable_simulation(false);
+    simulation->initialize_simulation();
+    simulation->simulate_days(policy, 50);
+
+    EXPECT_THROW(simulation->resimulate_from(policy, 10), std::invalid_argument);
+}
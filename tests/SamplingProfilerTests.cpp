@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include "../utils/SamplingProfiler.hpp"
+#include <chrono>
+#include <cmath>
+#include <sstream>
+
+// Exported (tests link with -rdynamic) so the profile can name it
+extern "C" __attribute__((noinline)) double chainsim_profiler_test_spin(double seconds)
+{
+    auto until = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+    double x = 0.0;
+    while (std::chrono::steady_clock::now() < until)
+    {
+        for (int i = 0; i < 1000; ++i)
+            x += std::sqrt(x + i);
+    }
+    return x;
+}
+
+TEST(SamplingProfilerTest, FoldsSamplesOfBusyCode)
+{
+    auto &profiler = qz::SamplingProfiler::instance();
+    profiler.start(500);
+    EXPECT_TRUE(profiler.active());
+    volatile double sink = chainsim_profiler_test_spin(0.3);
+    (void)sink;
+    auto profile = profiler.stop();
+    EXPECT_FALSE(profiler.active());
+
+    // About 150 ticks of CPU time; allow for coarse timers
+    EXPECT_GT(profile.samples, 50u);
+    EXPECT_EQ(profile.dropped, 0u);
+    EXPECT_EQ(profile.hz, 500u);
+    EXPECT_NE(profile.folded.find("chainsim_profiler_test_spin"), std::string::npos);
+
+    // Every line is "frames count" and the counts add up to the samples
+    std::istringstream lines(profile.folded);
+    std::string line;
+    std::uint64_t total = 0;
+    while (std::getline(lines, line))
+    {
+        auto space = line.rfind(' ');
+        ASSERT_NE(space, std::string::npos);
+        total += std::stoull(line.substr(space + 1));
+    }
+    EXPECT_EQ(total, profile.samples);
+}
+
+TEST(SamplingProfilerTest, BoundsTheSampleBuffer)
+{
+    auto &profiler = qz::SamplingProfiler::instance();
+    profiler.start(1000, 10);
+    volatile double sink = chainsim_profiler_test_spin(0.1);
+    (void)sink;
+    auto profile = profiler.stop();
+    EXPECT_LE(profile.samples, 10u);
+    EXPECT_GT(profile.dropped, 0u);
+}
+
+TEST(SamplingProfilerTest, RejectsOverlappingProfilesAndBadRates)
+{
+    auto &profiler = qz::SamplingProfiler::instance();
+    EXPECT_THROW(profiler.start(0), std::invalid_argument);
+    EXPECT_THROW(profiler.start(qz::SamplingProfiler::kMaxHz + 1), std::invalid_argument);
+
+    profiler.start(100);
+    EXPECT_THROW(profiler.start(100), std::invalid_argument);
+    profiler.stop();
+    EXPECT_NO_THROW(profiler.start(100));
+    profiler.stop();
+}
@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include "../analysis/SensitivityAnalysis.h"
+
+namespace
+{
+    // Ishigami function: S = (0.314, 0.442, 0), ST = (0.558, 0.442, 0.244) over [-pi, pi]^3
+    std::vector<double> ishigami(const std::vector<double> &x, unsigned seed)
+    {
+        // A second, noisy output that only depends on x1
+        std::mt19937 rng(seed);
+        std::normal_distribution<double> noise(0.0, 0.5);
+        return {std::sin(x[0]) + 7.0 * std::pow(std::sin(x[1]), 2) + 0.1 * std::pow(x[2], 4) * std::sin(x[0]),
+                x[0] + noise(rng)};
+    }
+
+    std::vector<qz::SensitivityParameter> ishigami_ranges()
+    {
+        return {{"x1", -M_PI, M_PI}, {"x2", -M_PI, M_PI}, {"x3", -M_PI, M_PI}};
+    }
+}
+
+TEST(SensitivityAnalysisTest, RecoversIshigamiIndices)
+{
+    qz::SensitivityOptions options;
+    options.samples = 4096;
+    qz::SensitivityAnalysis analysis(ishigami_ranges(), {"ishigami", "noisy"}, ishigami, options);
+    auto result = analysis.analyze();
+
+    ASSERT_EQ(result.outputs.size(), 2u);
+    EXPECT_EQ(result.evaluations, 4096u * 5);
+    const auto &parameters = result.outputs[0].parameters;
+    const double first_order[] = {0.314, 0.442, 0.0};
+    const double total[] = {0.558, 0.442, 0.244};
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+        EXPECT_NEAR(parameters[i].first_order.estimate, first_order[i], 0.03) << parameters[i].parameter.toStdString();
+        EXPECT_NEAR(parameters[i].total.estimate, total[i], 0.03) << parameters[i].parameter.toStdString();
+        EXPECT_LE(parameters[i].total.lower, parameters[i].total.estimate);
+        EXPECT_GE(parameters[i].total.upper, parameters[i].total.estimate);
+    }
+}
+
+TEST(SensitivityAnalysisTest, CommonSeedsCancelNoiseOfUnusedParameters)
+{
+    qz::SensitivityOptions options;
+    options.samples = 512;
+    auto result = qz::SensitivityAnalysis(ishigami_ranges(), {"ishigami", "noisy"}, ishigami, options).analyze();
+
+    // A row's points share their seed, so swapping in x2 or x3 changes nothing
+    const auto &noisy = result.outputs[1].parameters;
+    EXPECT_EQ(noisy[1].total.estimate, 0.0);
+    EXPECT_EQ(noisy[2].total.estimate, 0.0);
+    EXPECT_GT(noisy[0].total.estimate, 0.85);
+}
+
+TEST(SensitivityAnalysisTest, IntegerParametersCoverTheirRangeEvenly)
+{
+    qz::SensitivityParameter lead_time{"average_lead_time", 3, 10, true};
+    std::vector<int> counts(11, 0);
+    for (int i = 0; i < 8000; ++i)
+        ++counts[static_cast<int>(lead_time.value(i / 8000.0))];
+    for (int value = 3; value <= 10; ++value)
+        EXPECT_EQ(counts[value], 1000);
+}
+
+TEST(SensitivityAnalysisTest, ParsesRanges)
+{
+    auto parameters = qz::SensitivityAnalysis::parse_parameters("average_lead_time:3:10, holding_cost:0.1:0.3");
+    ASSERT_EQ(parameters.size(), 2u);
+    EXPECT_EQ(parameters[1].name, "holding_cost");
+    EXPECT_DOUBLE_EQ(parameters[1].lower, 0.1);
+    EXPECT_DOUBLE_EQ(parameters[1].upper, 0.3);
+
+    EXPECT_THROW(qz::SensitivityAnalysis::parse_parameters("average_demand:40"), std::invalid_argument);
+    EXPECT_THROW(qz::SensitivityAnalysis::parse_parameters("a:1:2,a:3:4"), std::invalid_argument);
+}
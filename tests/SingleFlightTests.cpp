@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include "../utils/SingleFlight.hpp"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(SingleFlightTest, ConcurrentCallsShareOneComputation)
+{
+    qz::SingleFlight<std::string, std::shared_ptr<const int>> flight;
+    std::atomic<int> computations{0};
+    std::atomic<bool> release{false};
+
+    constexpr int kCallers = 8;
+    std::vector<std::shared_ptr<const int>> values(kCallers);
+    std::atomic<int> shared{0};
+    std::vector<std::thread> callers;
+    for (int i = 0; i < kCallers; ++i)
+    {
+        callers.emplace_back([&, i]()
+                             {
+                                 auto result = flight.run("scenario", [&]()
+                                                          {
+                                                              ++computations;
+                                                              while (!release)
+                                                                  std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                                                              return std::make_shared<const int>(42);
+                                                          });
+                                 values[i] = result.value;
+                                 shared += result.shared; });
+    }
+
+    // Let every caller join the flight before the computation finishes
+    while (computations == 0)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    release = true;
+    for (auto &caller : callers)
+        caller.join();
+
+    EXPECT_EQ(computations, 1);
+    EXPECT_EQ(shared, kCallers - 1);
+    for (const auto &value : values)
+        EXPECT_EQ(value, values[0]); // The very same object
+    EXPECT_EQ(flight.in_flight(), 0u);
+}
+
+TEST(SingleFlightTest, FinishedCallsAreNotCached)
+{
+    qz::SingleFlight<std::string, int> flight;
+    int computations = 0;
+    auto compute = [&]()
+    { return ++computations; };
+
+    EXPECT_EQ(flight.run("a", compute).value, 1);
+    EXPECT_EQ(flight.run("a", compute).value, 2);
+    EXPECT_FALSE(flight.run("b", compute).shared);
+}
+
+TEST(SingleFlightTest, ExceptionsReachEveryCaller)
+{
+    qz::SingleFlight<std::string, int> flight;
+    EXPECT_THROW(flight.run("bad", []() -> int
+                            { throw std::invalid_argument("Lead time must be greater than zero"); }),
+                 std::invalid_argument);
+    EXPECT_EQ(flight.in_flight(), 0u);
+    EXPECT_EQ(flight.run("bad", []()
+                         { return 1; })
+                  .value,
+              1);
+}
@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+#include <set>
+#include <vector>
+#include "../utils/SobolSequence.hpp"
+
+TEST(SobolSequenceTest, FirstDimensionIsVanDerCorput)
+{
+    qz::SobolSequence sobol(1);
+    const std::vector<double> expected = {0.5, 0.75, 0.25, 0.375, 0.875, 0.625, 0.125};
+    for (double x : expected)
+        EXPECT_DOUBLE_EQ(sobol.next()[0], x);
+}
+
+TEST(SobolSequenceTest, EveryDimensionIsStratified)
+{
+    // Each block of 2^m points (with the skipped origin, points 0 .. 2^m - 1) puts one point in
+    // every interval of width 2^-m, in every dimension
+    constexpr unsigned kPoints = 1024;
+    qz::SobolSequence sobol(qz::SobolSequence::kMaxDimensions);
+    std::vector<std::set<unsigned>> cells(sobol.dimensions(), std::set<unsigned>{0});
+    for (unsigned i = 1; i < kPoints; ++i)
+    {
+        const auto &point = sobol.next();
+        for (unsigned d = 0; d < sobol.dimensions(); ++d)
+        {
+            ASSERT_GE(point[d], 0.0);
+            ASSERT_LT(point[d], 1.0);
+            cells[d].insert(static_cast<unsigned>(point[d] * kPoints));
+        }
+    }
+    for (unsigned d = 0; d < sobol.dimensions(); ++d)
+        EXPECT_EQ(cells[d].size(), kPoints) << "dimension " << d;
+}
+
+TEST(SobolSequenceTest, MatchesJoeKuoReferencePoints)
+{
+    // Unscrambled Joe-Kuo points 1 .. 7, as published with the direction numbers
+    const std::vector<std::vector<double>> expected = {
+        {0.5, 0.5, 0.5, 0.5},
+        {0.75, 0.25, 0.25, 0.25},
+        {0.25, 0.75, 0.75, 0.75},
+        {0.375, 0.375, 0.625, 0.875},
+        {0.875, 0.875, 0.125, 0.375},
+        {0.625, 0.125, 0.875, 0.625},
+        {0.125, 0.625, 0.375, 0.125},
+    };
+    qz::SobolSequence sobol(4);
+    for (const auto &point : expected)
+    {
+        const auto &actual = sobol.next();
+        for (std::size_t d = 0; d < point.size(); ++d)
+            EXPECT_DOUBLE_EQ(actual[d], point[d]);
+    }
+}
+
+TEST(SobolSequenceTest, RejectsUnsupportedDimensions)
+{
+    EXPECT_THROW(qz::SobolSequence(0), std::invalid_argument);
+    EXPECT_THROW(qz::SobolSequence(qz::SobolSequence::kMaxDimensions + 1), std::invalid_argument);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "../ChainSimBuilder.h"
+
+namespace qz::test
+{
+    // The engine setup the simulation tests share; a test changes only the fields it varies
+    struct TestSimulation
+    {
+        QString name{"Test"};
+        quint64 days{365};
+        quint64 lead_time{3};
+        QString distribution{"normal"};
+        double demand{20.0};
+        double stddev{6.0};
+        unsigned seed{7};
+        quint64 starting_inventory{100};
+        bool record_history{true};
+        bool track_distributions{true};
+        bool resumable{false};
+
+        [[nodiscard]] ChainSimConfig config() const
+        {
+            ChainSimBuilder builder;
+            builder.setSimulationName(name)
+                .setSimulationLength(days)
+                .setLeadTime(lead_time)
+                .setDemandDistribution(distribution)
+                .setAverageDemand(demand)
+                .setDemandStdDev(stddev)
+                .setSeed(seed)
+                .setStartingInventory(starting_inventory)
+                .setRecordHistory(record_history)
+                .setTrackDistributions(track_distributions)
+                .setResumable(resumable);
+            return builder.config();
+        }
+
+        [[nodiscard]] std::unique_ptr<ChainSim> create() const
+        {
+            return ChainSimBuilder().setConfig(config()).create();
+        }
+    };
+}
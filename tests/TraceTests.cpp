@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include "../utils/Trace.hpp"
+#include <thread>
+
+namespace
+{
+    // The tracer is a process-wide singleton; every test starts from an empty, enabled one
+    class TraceTest : public ::testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            qz::Tracer::instance().clear();
+            qz::Tracer::instance().set_enabled(true);
+        }
+
+        void TearDown() override { qz::Tracer::instance().set_enabled(false); }
+
+        static std::size_t event_count()
+        {
+            std::size_t count = 0;
+            for (const auto &track : qz::Tracer::instance().snapshot())
+                count += track.events.size();
+            return count;
+        }
+    };
+}
+
+TEST_F(TraceTest, SpansRecordNameCategoryAndDuration)
+{
+    {
+        qz::TraceSpan outer("request", "test");
+        qz::TraceSpan inner("simulate", "test");
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+
+    std::vector<qz::TraceEvent> events;
+    for (const auto &track : qz::Tracer::instance().snapshot())
+        events.insert(events.end(), track.events.begin(), track.events.end());
+    ASSERT_EQ(events.size(), 2u);
+
+    // Inner spans close first and lie within their parent
+    EXPECT_STREQ(events[0].name, "simulate");
+    EXPECT_STREQ(events[1].name, "request");
+    EXPECT_STREQ(events[1].category, "test");
+    EXPECT_GE(events[0].duration_ns, 2'000'000);
+    EXPECT_LE(events[1].start_ns, events[0].start_ns);
+    EXPECT_GE(events[1].start_ns + events[1].duration_ns, events[0].start_ns + events[0].duration_ns);
+}
+
+TEST_F(TraceTest, DisabledSpansRecordNothing)
+{
+    qz::Tracer::instance().set_enabled(false);
+    {
+        qz::TraceSpan span("ignored", "test");
+    }
+    EXPECT_EQ(event_count(), 0u);
+}
+
+TEST_F(TraceTest, RingKeepsTheNewestEvents)
+{
+    static const char *const kNames[] = {"old", "new"};
+    for (std::size_t i = 0; i < qz::Tracer::kCapacity + 10; ++i)
+        qz::Tracer::instance().record({kNames[i >= 10], "test", static_cast<std::int64_t>(i), 1});
+
+    EXPECT_EQ(event_count(), qz::Tracer::kCapacity);
+    for (const auto &track : qz::Tracer::instance().snapshot())
+    {
+        for (const auto &event : track.events)
+            EXPECT_STREQ(event.name, "new");
+    }
+}
+
+TEST_F(TraceTest, ThreadsGetTheirOwnNamedTracks)
+{
+    {
+        qz::TraceSpan span("main", "test");
+    }
+    std::thread worker([]
+                       {
+                           qz::Tracer::instance().set_thread_name("worker \"1\"");
+                           qz::TraceSpan span("work", "test"); });
+    worker.join();
+
+    int tracks_with_events = 0;
+    for (const auto &track : qz::Tracer::instance().snapshot())
+        tracks_with_events += track.events.empty() ? 0 : 1;
+    EXPECT_EQ(tracks_with_events, 2);
+
+    auto json = qz::Tracer::instance().to_json();
+    EXPECT_EQ(json.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0), 0u);
+    EXPECT_NE(json.find("\"name\":\"work\",\"cat\":\"test\",\"ph\":\"X\""), std::string::npos);
+    EXPECT_NE(json.find("\"args\":{\"name\":\"worker \\\"1\\\"\"}"), std::string::npos);
+}
+
+TEST_F(TraceTest, ExitedThreadsHandTheirRingsOn)
+{
+    {
+        qz::TraceSpan span("main", "test");
+    }
+    auto tracks = qz::Tracer::instance().snapshot().size();
+
+    // Naming a thread does not allocate a ring while nothing is recorded
+    qz::Tracer::instance().set_enabled(false);
+    std::thread([]
+                { qz::Tracer::instance().set_thread_name("idle"); })
+        .join();
+    EXPECT_EQ(qz::Tracer::instance().snapshot().size(), tracks);
+    qz::Tracer::instance().set_enabled(true);
+
+    // Batches of short-lived threads, as parallel_for starts for every call
+    for (int batch = 0; batch < 50; ++batch)
+    {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+            threads.emplace_back([]
+                                 { qz::TraceSpan span("replication", "test"); });
+        for (auto &thread : threads)
+            thread.join();
+    }
+
+    EXPECT_LE(qz::Tracer::instance().snapshot().size(), tracks + 4);
+    EXPECT_EQ(event_count(), 1u + 50 * 4);
+}
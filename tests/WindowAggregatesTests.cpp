@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include "../utils/WindowAggregates.hpp"
+#include <random>
+
+namespace
+{
+    std::vector<std::int64_t> random_column(std::size_t count, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<std::int64_t> values(-20, 100);
+        std::vector<std::int64_t> column(count);
+        for (auto &value : column)
+            value = values(rng);
+        return column;
+    }
+}
+
+TEST(WindowAggregatesTest, RollingWindowsMatchADirectSum)
+{
+    auto column = random_column(200, 1);
+    auto prefix = qz::prefix_sums(column.data(), column.size());
+
+    for (std::size_t window : {1u, 7u, 30u, 250u})
+    {
+        for (auto [first, last] : {std::pair<std::size_t, std::size_t>{0, 199}, {3, 40}, {150, 150}})
+        {
+            auto sums = qz::rolling_sums(prefix, window, first, last);
+            auto means = qz::rolling_means(prefix, window, first, last);
+            ASSERT_EQ(sums.size(), last - first + 1);
+            for (std::size_t day = first; day <= last; ++day)
+            {
+                std::int64_t expected = 0;
+                std::size_t days = 0;
+                for (std::size_t d = day + 1; d-- > 0 && days < window; ++days)
+                    expected += column[d];
+                EXPECT_EQ(sums[day - first], expected) << "window " << window << " day " << day;
+                EXPECT_DOUBLE_EQ(means[day - first], static_cast<double>(expected) / static_cast<double>(days));
+            }
+        }
+    }
+}
+
+TEST(WindowAggregatesTest, CumulativeAndPeriodTotals)
+{
+    std::vector<std::int64_t> column{5, 0, 0, 3, 0, 0, 0, 4, 1, 0};
+    auto prefix = qz::prefix_sums(column.data(), column.size());
+
+    EXPECT_EQ(qz::cumulative_sums(prefix, 0, 9), (std::vector<std::int64_t>{5, 5, 5, 8, 8, 8, 8, 12, 13, 13}));
+    EXPECT_EQ(qz::cumulative_sums(prefix, 7, 8), (std::vector<std::int64_t>{12, 13}));
+    EXPECT_EQ(qz::period_sums(prefix, 7, 0, 9), (std::vector<std::int64_t>{8, 5}));
+    EXPECT_EQ(qz::period_sums(prefix, 3, 1, 8), (std::vector<std::int64_t>{3, 0, 5}));
+}
+
+TEST(WindowAggregatesTest, FillRateIsServedOverDemand)
+{
+    std::vector<std::int64_t> sales{0, 10, 5, 0, 10}, demand{0, 10, 10, 0, 10};
+    auto served = qz::prefix_sums(sales.data(), sales.size());
+    auto total = qz::prefix_sums(demand.data(), demand.size());
+
+    auto rate = qz::rolling_percent(served, total, 2, 0, 4);
+    EXPECT_DOUBLE_EQ(rate[0], 100.0); // No demand yet
+    EXPECT_DOUBLE_EQ(rate[1], 100.0);
+    EXPECT_DOUBLE_EQ(rate[2], 75.0);
+    EXPECT_DOUBLE_EQ(rate[3], 50.0);
+    EXPECT_DOUBLE_EQ(rate[4], 100.0);
+}
+
+TEST(WindowAggregatesTest, ParsesSpecs)
+{
+    auto specs = qz::parse_window_specs(qz::kDefaultWindowSpecs);
+    ASSERT_EQ(specs.size(), 5u);
+    EXPECT_EQ(specs[0].kind, qz::WindowSpec::Kind::FillRate);
+    EXPECT_EQ(specs[0].days, 7u);
+    EXPECT_EQ(specs[2].column, "inventory_quantity");
+    EXPECT_EQ(specs[2].days, 30u);
+    EXPECT_EQ(specs[3].kind, qz::WindowSpec::Kind::Cumulative);
+    EXPECT_EQ(specs[4].kind, qz::WindowSpec::Kind::PeriodSum);
+    EXPECT_EQ(specs[4].name, "period_sum:purchase_quantity:7");
+
+    EXPECT_THROW(qz::parse_window_specs(""), std::invalid_argument);
+    EXPECT_THROW(qz::parse_window_specs("rolling_mean:inventory_quantity"), std::invalid_argument);
+    EXPECT_THROW(qz::parse_window_specs("rolling_mean:inventory_quantity:0"), std::invalid_argument);
+    EXPECT_THROW(qz::parse_window_specs("fill_rate:7x"), std::invalid_argument);
+    EXPECT_THROW(qz::parse_window_specs("median:inventory_quantity:7"), std::invalid_argument);
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include "../utils/WireProtocol.hpp"
+
+namespace
+{
+    qz::wire::SimulateRequest sample_request()
+    {
+        qz::wire::SimulateRequest request;
+        request.id = 42;
+        request.policy = qz::wire::Policy::EOQ;
+        request.distribution = qz::wire::Distribution::Gamma;
+        request.flags = qz::wire::kSummaryOnly;
+        request.simulation_length = 365;
+        request.lead_time = 5;
+        request.seed = 7;
+        request.starting_inventory = 1ull << 40;
+        request.average_demand = 50.0;
+        request.gamma_shape = 25.0;
+        request.gamma_scale = 2.0;
+        request.ordering_cost = 100.0;
+        request.holding_cost = 0.2;
+        return request;
+    }
+}
+
+TEST(WireProtocolTest, RequestsRoundTrip)
+{
+    std::string frame;
+    qz::wire::encode_request(frame, sample_request());
+    ASSERT_EQ(frame.size(), qz::wire::kLengthBytes + qz::wire::kSimulateBytes);
+    EXPECT_EQ(qz::wire::frame_size(frame.data(), frame.size(), qz::wire::kMaxRequestBytes), frame.size());
+
+    auto request = qz::wire::decode_request(frame.data() + 4, frame.size() - 4);
+    EXPECT_EQ(request.id, 42u);
+    EXPECT_EQ(request.policy, qz::wire::Policy::EOQ);
+    EXPECT_EQ(request.distribution, qz::wire::Distribution::Gamma);
+    EXPECT_EQ(request.flags, qz::wire::kSummaryOnly);
+    EXPECT_EQ(request.simulation_length, 365u);
+    EXPECT_EQ(request.starting_inventory, 1ull << 40);
+    EXPECT_DOUBLE_EQ(request.gamma_shape, 25.0);
+    EXPECT_DOUBLE_EQ(request.holding_cost, 0.2);
+}
+
+TEST(WireProtocolTest, FramesWaitForTheirLastByte)
+{
+    // Two pipelined requests, fed one byte at a time
+    std::string stream;
+    qz::wire::encode_request(stream, sample_request());
+    qz::wire::encode_request(stream, sample_request());
+    auto one = qz::wire::kLengthBytes + qz::wire::kSimulateBytes;
+
+    for (std::size_t available = 0; available < one; ++available)
+        EXPECT_EQ(qz::wire::frame_size(stream.data(), available, qz::wire::kMaxRequestBytes), 0u);
+    EXPECT_EQ(qz::wire::frame_size(stream.data(), stream.size(), qz::wire::kMaxRequestBytes), one);
+    EXPECT_EQ(qz::wire::frame_size(stream.data() + one, stream.size() - one, qz::wire::kMaxRequestBytes), one);
+
+    // A length no request can have is rejected before its payload arrives
+    std::string oversized("\xff\xff\xff\x7f", 4);
+    EXPECT_THROW(qz::wire::frame_size(oversized.data(), oversized.size(), qz::wire::kMaxRequestBytes),
+                 std::invalid_argument);
+}
+
+TEST(WireProtocolTest, MalformedRequestsKeepTheirId)
+{
+    std::string frame;
+    auto request = sample_request();
+    qz::wire::encode_request(frame, request);
+    frame[4 + 5] = 9; // No such policy
+
+    EXPECT_THROW(qz::wire::decode_request(frame.data() + 4, frame.size() - 4), std::invalid_argument);
+    EXPECT_THROW(qz::wire::decode_request(frame.data() + 4, frame.size() - 5), std::invalid_argument);
+    EXPECT_EQ(qz::wire::peek_id(frame.data() + 4, frame.size() - 4), 42u);
+    EXPECT_EQ(qz::wire::peek_id(frame.data() + 4, 3), 0u);
+}
+
+TEST(WireProtocolTest, ResultsAndErrorsRoundTrip)
+{
+    qz::SimulationKpis kpis;
+    kpis.days = 3;
+    kpis.total_lost_sales = -1;
+    kpis.service_level = 97.25;
+    kpis.min_inventory = -5;
+    const std::int64_t inventory[] = {100, -5, 1ll << 50};
+
+    std::string out;
+    qz::wire::Writer writer(out);
+    qz::wire::begin_result(writer, 7, kpis, 1);
+    qz::wire::write_column(writer, "inventory_quantity", inventory, 3);
+    writer.end_frame();
+    qz::wire::encode_error(out, 8, "Lead time must be less than simulation length");
+
+    auto first = qz::wire::frame_size(out.data(), out.size(), SIZE_MAX);
+    auto result = qz::wire::decode_response(out.data() + 4, first - 4);
+    EXPECT_EQ(result.type, qz::wire::MessageType::Result);
+    EXPECT_EQ(result.id, 7u);
+    EXPECT_EQ(result.kpis.days, 3u);
+    EXPECT_EQ(result.kpis.total_lost_sales, -1);
+    EXPECT_DOUBLE_EQ(result.kpis.service_level, 97.25);
+    EXPECT_EQ(result.kpis.min_inventory, -5);
+    ASSERT_EQ(result.columns.size(), 1u);
+    EXPECT_EQ(result.columns[0].first, "inventory_quantity");
+    EXPECT_EQ(result.columns[0].second, std::vector<std::int64_t>(std::begin(inventory), std::end(inventory)));
+
+    auto rest = out.size() - first;
+    auto error = qz::wire::decode_response(out.data() + first + 4, rest - 4);
+    EXPECT_EQ(error.type, qz::wire::MessageType::Error);
+    EXPECT_EQ(error.id, 8u);
+    EXPECT_EQ(error.error, "Lead time must be less than simulation length");
+}
+
+TEST(WireProtocolTest, ResultSizeBoundsTheFrame)
+{
+    const std::int64_t values[] = {1, 2, 3, 4};
+    std::string out;
+    qz::wire::Writer writer(out);
+    qz::wire::begin_result(writer, 1, qz::SimulationKpis{}, 2);
+    EXPECT_EQ(out.size() - qz::wire::kLengthBytes, qz::wire::kResultHeaderBytes);
+
+    qz::wire::write_column(writer, "demand_quantity", values, 4);
+    qz::wire::write_column(writer, "sale_quantity", values, 4);
+    writer.end_frame();
+    EXPECT_LE(out.size() - qz::wire::kLengthBytes, qz::wire::result_bytes(2, 4));
+
+    // Six columns of ten million days fit in a Result, six of 36.5 million do not
+    EXPECT_LE(qz::wire::result_bytes(6, 10'000'000), qz::wire::kMaxResultBytes);
+    EXPECT_GT(qz::wire::result_bytes(6, 36'500'000), qz::wire::kMaxResultBytes);
+}
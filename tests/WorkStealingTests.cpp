@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+#include "../utils/WorkStealing.hpp"
+#include <chrono>
+#include <set>
+#include <stdexcept>
+
+TEST(WorkStealingTest, RunsEveryIndexExactlyOnce)
+{
+    for (std::size_t count : {0u, 1u, 7u, 1000u})
+    {
+        std::vector<std::atomic<int>> runs(count);
+        qz::work_stealing_for(count, 4, [&](std::size_t i)
+                              { runs[i].fetch_add(1); });
+        for (std::size_t i = 0; i < count; ++i)
+            EXPECT_EQ(runs[i].load(), 1) << "index " << i << " of " << count;
+    }
+}
+
+TEST(WorkStealingTest, IdleThreadsStealFromABusyBlock)
+{
+    // All the slow items sit in the first thread's block; without stealing they would run serially
+    constexpr std::size_t kCount = 64;
+    std::mutex mutex;
+    std::set<std::thread::id> slow_threads;
+    qz::work_stealing_for(kCount, 4, [&](std::size_t i)
+                          {
+                              if (i < kCount / 4)
+                              {
+                                  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                                  std::lock_guard<std::mutex> lock(mutex);
+                                  slow_threads.insert(std::this_thread::get_id());
+                              } });
+    EXPECT_GT(slow_threads.size(), 1u);
+}
+
+TEST(WorkStealingTest, RethrowsTheFirstException)
+{
+    EXPECT_THROW(qz::work_stealing_for(1000, 4, [](std::size_t i)
+                                       {
+                                           if (i == 10)
+                                               throw std::runtime_error("scenario failed"); }),
+                 std::runtime_error);
+}
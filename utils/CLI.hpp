@@ -19,6 +19,33 @@ namespace qz
             QStringList() << "s" << "server",
             "Run in server mode listening on port 47761");
 
+        QCommandLineOption sessionPortOption(
+            "session_port",
+            "WebSocket port for interactive simulation sessions (server mode)",
+            "port",
+            "47762");
+
+        QCommandLineOption binaryPortOption(
+            "binary_port",
+            "TCP port for the framed binary protocol (server mode, 0 = off)",
+            "port",
+            "47763");
+
+        QCommandLineOption binarySocketOption(
+            "binary_socket",
+            "Unix domain socket for the framed binary protocol (server mode)",
+            "path");
+
+        QCommandLineOption serverThreadsOption(
+            "server_threads",
+            "HTTP worker threads sharing the server port (0 = one per core)",
+            "threads",
+            "1");
+
+        QCommandLineOption profilerOption(
+            "profiler",
+            "Enable the /debug/profile sampling profiler endpoint (server mode; ENABLE_PROFILER=1 also enables it)");
+
         // Add options
         QCommandLineOption logLevelOption(
             "log_level",
@@ -44,6 +71,36 @@ namespace qz
             "std",
             "10.0");
 
+        QCommandLineOption demandDistributionOption(
+            "demand_distribution",
+            "Demand distribution: (normal | gamma | poisson | uniform | fixed)",
+            "distribution",
+            "normal");
+
+        QCommandLineOption gammaShapeOption(
+            "gamma_shape",
+            "Shape of gamma-distributed demand",
+            "shape",
+            "25.0");
+
+        QCommandLineOption gammaScaleOption(
+            "gamma_scale",
+            "Scale of gamma-distributed demand",
+            "scale",
+            "2.0");
+
+        QCommandLineOption uniformMinOption(
+            "uniform_min",
+            "Lower bound of uniformly distributed demand",
+            "min",
+            "30.0");
+
+        QCommandLineOption uniformMaxOption(
+            "uniform_max",
+            "Upper bound of uniformly distributed demand",
+            "max",
+            "70.0");
+
         QCommandLineOption avgLeadTimeOption(
             "average_lead_time",
             "Average lead time",
@@ -102,8 +159,156 @@ namespace qz
             "deterministic",
             "Simulate without random sampling, use fixed leadtime/demand/etc.");
 
+        QCommandLineOption summaryOnlyOption(
+            "summary_only",
+            "Print KPIs computed during the run instead of writing per-day records");
+
+        QCommandLineOption optimizeOption(
+            "optimize",
+            "Search the policy's parameters for the lowest expected cost meeting the service-level target");
+
+        QCommandLineOption stockoutCostOption(
+            "stockout_cost",
+            "Cost per unit of lost sales (optimizer)",
+            "cost",
+            "10.0");
+
+        QCommandLineOption targetServiceLevelOption(
+            "target_service_level",
+            "Minimum average service level in percent (optimizer)",
+            "percent",
+            "95.0");
+
+        QCommandLineOption replicationsOption(
+            "replications",
+            "Replications per candidate, with common random numbers (optimizer)",
+            "count",
+            "16");
+
+        QCommandLineOption optimizerIterationsOption(
+            "optimizer_iterations",
+            "Maximum Nelder-Mead iterations (optimizer)",
+            "count",
+            "100");
+
+        QCommandLineOption analyticalOption(
+            "analytical",
+            "Print exact steady-state KPIs from the inventory Markov chain (Poisson or fixed demand), "
+            "simulating only if the chain is too large");
+
+        QCommandLineOption precisionOption(
+            "precision",
+            "Replicate until every KPI's confidence interval is this tight, "
+            "e.g. service_level:0.5,average_inventory:2% (absolute, or relative with %)",
+            "targets");
+
+        QCommandLineOption minReplicationsOption(
+            "min_replications",
+            "Replications before the first precision check (--precision)",
+            "count",
+            "10");
+
+        QCommandLineOption maxReplicationsOption(
+            "max_replications",
+            "Replication budget (--precision)",
+            "count",
+            "1000");
+
+        QCommandLineOption stockoutRiskOption(
+            "stockout_risk",
+            "Estimate the probability of a stockout in the last --window days with importance sampling");
+
+        QCommandLineOption tiltOption(
+            "tilt",
+            "Demand mean factor while importance sampling (0 = chosen by a cross-entropy pilot)",
+            "factor",
+            "0");
+
+        QCommandLineOption windowOption(
+            "window",
+            "Days at the end of the run covered by --stockout_risk (0 = lead time + 1)",
+            "days",
+            "0");
+
+        QCommandLineOption sensitivityOption(
+            "sensitivity",
+            "Sobol indices of the KPIs over parameter ranges, "
+            "e.g. average_lead_time:3:10,average_demand:40:60,holding_cost:0.1:0.3",
+            "ranges");
+
+        QCommandLineOption samplesOption(
+            "samples",
+            "Sobol design rows for --sensitivity (rounded up to a power of two)",
+            "count",
+            "256");
+
+        QCommandLineOption compareOption(
+            "compare",
+            "Compare policies on the same demand paths, e.g. ROP,EOQ,TPOP (first is the baseline; uses --replications)",
+            "policies");
+
+        QCommandLineOption explainDaysOption(
+            "explain_days",
+            "Trace purchase decisions and print how they were reached for these days, e.g. 10,20-25",
+            "days");
+
+        QCommandLineOption aggregateOption(
+            "aggregate",
+            "Print windowed aggregates of the run as JSON, e.g. "
+            "fill_rate:7,rolling_mean:inventory_quantity:30,cumulative:lost_sale_quantity,period_sum:purchase_quantity:7; "
+            "the CSV is written only when --output_file is given",
+            "aggregates");
+
+        QCommandLineOption aggregateFromOption(
+            "aggregate_from",
+            "First day of the --aggregate series (default 0)",
+            "day");
+
+        QCommandLineOption aggregateToOption(
+            "aggregate_to",
+            "Last day of the --aggregate series (default the last simulated day)",
+            "day");
+
+        QCommandLineOption manifestOption(
+            "manifest",
+            "Run every scenario of a JSON-lines or CSV manifest (columns/keys as /simulate parameters; "
+            "the other options are defaults)",
+            "file");
+
+        QCommandLineOption outputDirOption(
+            "output_dir",
+            "Directory for manifest outputs: shard-NN/<id>.csv records and summary.csv",
+            "dir",
+            "manifest_output");
+
+        QCommandLineOption threadsOption(
+            "threads",
+            "Worker threads for manifest scenarios (0 = one per core)",
+            "threads",
+            "0");
+
+        QCommandLineOption shardsOption(
+            "shards",
+            "Record directories manifest outputs are spread over",
+            "count",
+            "16");
+
+        QCommandLineOption noResumeOption(
+            "no_resume",
+            "Rerun manifest scenarios already listed in summary.csv instead of skipping them");
+
+        QCommandLineOption traceFileOption(
+            "trace_file",
+            "Record timing spans and write them as Chrome trace-event JSON to this file on exit",
+            "file");
+
         // Add all options to parser
         parser.addOption(serverOption);
+        parser.addOption(sessionPortOption);
+        parser.addOption(binaryPortOption);
+        parser.addOption(binarySocketOption);
+        parser.addOption(serverThreadsOption);
+        parser.addOption(profilerOption);
         parser.addOption(logLevelOption);
         parser.addOption(simLengthOption);
         parser.addOption(avgDemandOption);
@@ -118,6 +323,37 @@ namespace qz
         parser.addOption(outputFileOption);
         parser.addOption(policyOption);
         parser.addOption(deterministicOption);
+        parser.addOption(summaryOnlyOption);
+        parser.addOption(optimizeOption);
+        parser.addOption(analyticalOption);
+        parser.addOption(stockoutCostOption);
+        parser.addOption(targetServiceLevelOption);
+        parser.addOption(replicationsOption);
+        parser.addOption(optimizerIterationsOption);
+        parser.addOption(precisionOption);
+        parser.addOption(minReplicationsOption);
+        parser.addOption(maxReplicationsOption);
+        parser.addOption(stockoutRiskOption);
+        parser.addOption(tiltOption);
+        parser.addOption(windowOption);
+        parser.addOption(sensitivityOption);
+        parser.addOption(samplesOption);
+        parser.addOption(compareOption);
+        parser.addOption(explainDaysOption);
+        parser.addOption(aggregateOption);
+        parser.addOption(aggregateFromOption);
+        parser.addOption(aggregateToOption);
+        parser.addOption(traceFileOption);
+        parser.addOption(demandDistributionOption);
+        parser.addOption(gammaShapeOption);
+        parser.addOption(gammaScaleOption);
+        parser.addOption(uniformMinOption);
+        parser.addOption(uniformMaxOption);
+        parser.addOption(manifestOption);
+        parser.addOption(outputDirOption);
+        parser.addOption(threadsOption);
+        parser.addOption(shardsOption);
+        parser.addOption(noResumeOption);
 
         // Process the command line arguments
         parser.process(app);
@@ -11,6 +11,9 @@ class ChainLogger
 public:
     explicit ChainLogger(quint32 loggingLevel = 1) : m_logging_level{loggingLevel} {}
 
+    // Lets callers skip formatting messages that would be dropped anyway
+    [[nodiscard]] bool enabled() const { return m_logging_level >= 1; }
+
     void info(const QString &message) const
     {
         if (m_logging_level < 1)
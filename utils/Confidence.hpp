@@ -0,0 +1,91 @@
+#ifndef CHAINSIM_CONFIDENCE_HPP
+#define CHAINSIM_CONFIDENCE_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include "KpiAccumulator.hpp"
+
+namespace qz
+{
+
+    // Inverse standard normal CDF (Acklam's rational approximation, relative error < 1.2e-9)
+    inline double normal_quantile(double p)
+    {
+        if (p <= 0.0 || p >= 1.0)
+            throw std::invalid_argument("Quantile probability must be in (0, 1)");
+
+        static constexpr double a[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                                       1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+        static constexpr double b[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                                       6.680131188771972e+01, -1.328068155288572e+01};
+        static constexpr double c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                                       -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+        static constexpr double d[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                                       3.754408661907416e+00};
+        constexpr double p_low = 0.02425;
+
+        if (p < p_low)
+        {
+            double q = std::sqrt(-2.0 * std::log(p));
+            return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+                   ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+        }
+        if (p > 1.0 - p_low)
+            return -normal_quantile(1.0 - p);
+
+        double q = p - 0.5;
+        double r = q * q;
+        return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+               (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+    }
+
+    /* Student-t quantile via the Cornish-Fisher expansion around the normal quantile.
+     * Within 1% of the exact value from 3 degrees of freedom on; 1 and 2 are solved exactly.
+     */
+    inline double t_quantile(double p, std::uint64_t degrees_of_freedom)
+    {
+        if (degrees_of_freedom == 0)
+            throw std::invalid_argument("Student-t quantile needs at least one degree of freedom");
+
+        constexpr double kPi = 3.14159265358979323846;
+        if (degrees_of_freedom == 1)
+            return std::tan(kPi * (p - 0.5));
+        if (degrees_of_freedom == 2)
+        {
+            double alpha = 4.0 * p * (1.0 - p);
+            return 2.0 * (p - 0.5) * std::sqrt(2.0 / alpha);
+        }
+
+        double z = normal_quantile(p);
+        double n = static_cast<double>(degrees_of_freedom);
+        double z2 = z * z;
+        return z + (z2 + 1.0) * z / (4.0 * n) +
+               ((5.0 * z2 + 16.0) * z2 + 3.0) * z / (96.0 * n * n) +
+               (((3.0 * z2 + 19.0) * z2 + 17.0) * z2 - 15.0) * z / (384.0 * n * n * n);
+    }
+
+    struct ConfidenceInterval
+    {
+        double mean{0.0};
+        double half_width{0.0};
+
+        [[nodiscard]] double lower() const { return mean - half_width; }
+        [[nodiscard]] double upper() const { return mean + half_width; }
+    };
+
+    // Two-sided t interval for the mean of i.i.d. observations (e.g. independent replications)
+    inline ConfidenceInterval confidence_interval(const RunningStats &stats, double level = 0.95)
+    {
+        ConfidenceInterval interval{stats.mean(), 0.0};
+        if (stats.count() < 2)
+            return interval;
+
+        double t = t_quantile(0.5 + level / 2.0, stats.count() - 1);
+        interval.half_width = t * stats.stddev() / std::sqrt(static_cast<double>(stats.count()));
+        return interval;
+    }
+
+} // namespace qz
+
+#endif // CHAINSIM_CONFIDENCE_HPP
@@ -0,0 +1,82 @@
+#ifndef CHAINSIM_DECISIONTRACE_HPP
+#define CHAINSIM_DECISIONTRACE_HPP
+
+#include <QString>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include "purchase_policies/PurchasePolicy.h"
+
+namespace qz
+{
+
+    /* Every purchase decision of a run as fixed-size DecisionRecords, in day order.
+     * Storage is reserved for the whole horizon up front, so recording a day is one copy of a
+     * few words; the explanation text is rendered later by the policy for the days requested.
+     */
+    class DecisionTrace
+    {
+    public:
+        void reset(std::size_t days)
+        {
+            m_records.clear();
+            m_records.reserve(days);
+        }
+
+        void add(const DecisionRecord &record) { m_records.push_back(record); }
+
+        // Forgets the decisions of `day` and later, e.g. before those days are simulated again
+        void truncate(quint64 day)
+        {
+            m_records.erase(std::lower_bound(m_records.begin(), m_records.end(), day,
+                                             [](const DecisionRecord &record, quint64 d)
+                                             { return record.day < d; }),
+                            m_records.end());
+        }
+
+        [[nodiscard]] std::size_t size() const { return m_records.size(); }
+        [[nodiscard]] bool empty() const { return m_records.empty(); }
+        [[nodiscard]] std::size_t bytes() const { return m_records.size() * sizeof(DecisionRecord); }
+
+        // The decision taken on `day`, or nullptr if that day was not traced
+        [[nodiscard]] const DecisionRecord *find(quint64 day) const
+        {
+            auto it = std::lower_bound(m_records.begin(), m_records.end(), day,
+                                       [](const DecisionRecord &record, quint64 d)
+                                       { return record.day < d; });
+            return it != m_records.end() && it->day == day ? &*it : nullptr;
+        }
+
+        // Parses "10,20-25" into sorted, distinct days; at most `limit` of them
+        static std::vector<quint64> parse_days(const QString &spec, std::size_t limit = 1000)
+        {
+            std::vector<quint64> days;
+            for (const auto &item : spec.split(',', Qt::SkipEmptyParts))
+            {
+                auto bounds = item.trimmed().split('-');
+                bool first_ok = false, last_ok = bounds.size() == 1;
+                quint64 first = bounds[0].trimmed().toULongLong(&first_ok);
+                quint64 last = bounds.size() == 2 ? bounds[1].trimmed().toULongLong(&last_ok) : first;
+                if (bounds.size() > 2 || !first_ok || !last_ok || last < first)
+                {
+                    throw std::invalid_argument("Days look like 10,20-25, got " + item.toStdString());
+                }
+                if (last - first >= limit || days.size() + (last - first + 1) > limit)
+                {
+                    throw std::invalid_argument("At most " + std::to_string(limit) + " days can be explained at once");
+                }
+                for (quint64 day = first; day <= last; ++day)
+                    days.push_back(day);
+            }
+            std::sort(days.begin(), days.end());
+            days.erase(std::unique(days.begin(), days.end()), days.end());
+            return days;
+        }
+
+    private:
+        std::vector<DecisionRecord> m_records;
+    };
+
+} // namespace qz
+
+#endif // CHAINSIM_DECISIONTRACE_HPP
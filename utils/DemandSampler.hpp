@@ -4,6 +4,7 @@
 #include <random>
 #include <memory>
 #include <cmath>
+#include <stdexcept>
 
 namespace qz
 {
@@ -14,6 +15,19 @@ namespace qz
         virtual ~DemandSampler() = default;
         virtual double sample() = 0;
         [[nodiscard]] virtual double getMean() const = 0;
+        // Restarts the draws as a sampler constructed with `seed` would make them
+        virtual void reseed(unsigned) {}
+
+        /* Importance sampling: draw from the exponentially tilted distribution whose (untruncated)
+         * mean is `mean_factor` times the nominal one; 1 restores the nominal distribution.
+         * logLikelihoodRatio(x) is log f(x) / g(x) for a draw x, f nominal and g tilted.
+         */
+        virtual void setTilt(double mean_factor)
+        {
+            if (mean_factor != 1.0)
+                throw std::invalid_argument("Demand distribution does not support importance sampling");
+        }
+        [[nodiscard]] virtual double logLikelihoodRatio(double) const { return 0.0; }
     };
 
     class FixedDemandSampler : public DemandSampler
@@ -48,11 +62,41 @@ namespace qz
 
         [[nodiscard]] double getMean() const override { return m_mean; }
 
+        void reseed(unsigned seed) override
+        {
+            m_generator.seed(seed);
+            m_distribution.reset();
+        }
+
+        // N(mu, sigma) tilted by theta is N(mu + theta sigma^2, sigma); both are truncated at 0
+        void setTilt(double mean_factor) override
+        {
+            if (!(mean_factor > 0.0))
+                throw std::invalid_argument("Tilt must be positive");
+            double tilted_mean = m_mean * mean_factor;
+            m_theta = (tilted_mean - m_mean) / (m_stddev * m_stddev);
+            m_log_normalizer = m_theta * m_mean + 0.5 * m_theta * m_theta * m_stddev * m_stddev +
+                               std::log(positive_probability(tilted_mean) / positive_probability(m_mean));
+            m_distribution.param(std::normal_distribution<double>::param_type(tilted_mean, m_stddev));
+        }
+
+        [[nodiscard]] double logLikelihoodRatio(double x) const override
+        {
+            return -m_theta * x + m_log_normalizer;
+        }
+
     private:
+        [[nodiscard]] double positive_probability(double mean) const
+        {
+            return 0.5 * std::erfc(-mean / (m_stddev * std::sqrt(2.0)));
+        }
+
         double m_mean;
         double m_stddev;
         std::mt19937 m_generator;
         std::normal_distribution<double> m_distribution;
+        double m_theta{0.0};
+        double m_log_normalizer{0.0};
     };
 
     class GammaDemandSampler : public DemandSampler
@@ -69,11 +113,34 @@ namespace qz
 
         [[nodiscard]] double getMean() const override { return m_shape * m_scale; }
 
+        void reseed(unsigned seed) override
+        {
+            m_generator.seed(seed);
+            m_distribution.reset();
+        }
+
+        // Gamma(k, s) tilted by theta is Gamma(k, s / (1 - theta s)), i.e. the scale times the factor
+        void setTilt(double mean_factor) override
+        {
+            if (!(mean_factor > 0.0))
+                throw std::invalid_argument("Tilt must be positive");
+            m_theta = (1.0 - 1.0 / mean_factor) / m_scale;
+            m_log_normalizer = m_shape * std::log(mean_factor);
+            m_distribution.param(std::gamma_distribution<double>::param_type(m_shape, m_scale * mean_factor));
+        }
+
+        [[nodiscard]] double logLikelihoodRatio(double x) const override
+        {
+            return -m_theta * x + m_log_normalizer;
+        }
+
     private:
         double m_shape;
         double m_scale;
         std::mt19937 m_generator;
         std::gamma_distribution<double> m_distribution;
+        double m_theta{0.0};
+        double m_log_normalizer{0.0};
     };
 
     class PoissonDemandSampler : public DemandSampler
@@ -90,10 +157,33 @@ namespace qz
 
         [[nodiscard]] double getMean() const override { return m_mean; }
 
+        void reseed(unsigned seed) override
+        {
+            m_generator.seed(seed);
+            m_distribution.reset();
+        }
+
+        // Poisson(lambda) tilted by theta is Poisson(lambda e^theta)
+        void setTilt(double mean_factor) override
+        {
+            if (!(mean_factor > 0.0))
+                throw std::invalid_argument("Tilt must be positive");
+            m_theta = std::log(mean_factor);
+            m_log_normalizer = m_mean * (mean_factor - 1.0);
+            m_distribution = std::poisson_distribution<int>(m_mean * mean_factor);
+        }
+
+        [[nodiscard]] double logLikelihoodRatio(double x) const override
+        {
+            return -m_theta * x + m_log_normalizer;
+        }
+
     private:
         double m_mean;
         std::mt19937 m_generator;
         std::poisson_distribution<int> m_distribution;
+        double m_theta{0.0};
+        double m_log_normalizer{0.0};
     };
 
     class UniformDemandSampler : public DemandSampler
@@ -110,6 +200,12 @@ namespace qz
 
         [[nodiscard]] double getMean() const override { return (m_max + m_min) / 2.0; }
 
+        void reseed(unsigned seed) override
+        {
+            m_generator.seed(seed);
+            m_distribution.reset();
+        }
+
     private:
         double m_min;
         double m_max;
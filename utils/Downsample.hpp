@@ -0,0 +1,122 @@
+#ifndef CHAINSIM_DOWNSAMPLE_HPP
+#define CHAINSIM_DOWNSAMPLE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace qz
+{
+
+    /* Largest-Triangle-Three-Buckets (Steinarsson, 2013).
+     * Returns the indices of at most `threshold` points of values[0, count) that preserve the
+     * visual shape of the series; the first and last points are always kept.
+     */
+    template <typename T>
+    std::vector<std::size_t> lttb_indices(const T *values, std::size_t count, std::size_t threshold)
+    {
+        std::vector<std::size_t> indices;
+        if (threshold >= count || threshold < 3)
+        {
+            indices.resize(count);
+            for (std::size_t i = 0; i < count; ++i)
+                indices[i] = i;
+            return indices;
+        }
+
+        indices.reserve(threshold);
+        const double every = static_cast<double>(count - 2) / static_cast<double>(threshold - 2);
+
+        std::size_t a = 0;
+        indices.push_back(a);
+
+        for (std::size_t bucket = 0; bucket < threshold - 2; ++bucket)
+        {
+            // Average of the next bucket is the third vertex of the triangle
+            auto next_start = static_cast<std::size_t>(std::floor((bucket + 1) * every)) + 1;
+            auto next_end = std::min(static_cast<std::size_t>(std::floor((bucket + 2) * every)) + 1, count);
+            double avg_x = 0.0, avg_y = 0.0;
+            for (std::size_t i = next_start; i < next_end; ++i)
+            {
+                avg_x += static_cast<double>(i);
+                avg_y += static_cast<double>(values[i]);
+            }
+            auto next_size = static_cast<double>(next_end - next_start);
+            avg_x /= next_size;
+            avg_y /= next_size;
+
+            auto start = static_cast<std::size_t>(std::floor(bucket * every)) + 1;
+            auto end = static_cast<std::size_t>(std::floor((bucket + 1) * every)) + 1;
+
+            const auto ax = static_cast<double>(a);
+            const auto ay = static_cast<double>(values[a]);
+            double max_area = -1.0;
+            std::size_t chosen = start;
+            for (std::size_t i = start; i < end; ++i)
+            {
+                double area = std::abs((ax - avg_x) * (static_cast<double>(values[i]) - ay) -
+                                       (ax - static_cast<double>(i)) * (avg_y - ay));
+                if (area > max_area)
+                {
+                    max_area = area;
+                    chosen = i;
+                }
+            }
+
+            indices.push_back(chosen);
+            a = chosen;
+        }
+
+        indices.push_back(count - 1);
+        return indices;
+    }
+
+    /* Min/max decimation: splits the series into buckets and keeps each bucket's extremes in
+     * index order, so peaks and stockouts survive downsampling (LTTB may skip them).
+     */
+    template <typename T>
+    std::vector<std::size_t> minmax_indices(const T *values, std::size_t count, std::size_t threshold)
+    {
+        std::vector<std::size_t> indices;
+        if (threshold >= count || threshold < 4)
+        {
+            indices.resize(count);
+            for (std::size_t i = 0; i < count; ++i)
+                indices[i] = i;
+            return indices;
+        }
+
+        indices.reserve(threshold);
+        indices.push_back(0);
+
+        const std::size_t buckets = (threshold - 2) / 2;
+        const double every = static_cast<double>(count - 2) / static_cast<double>(buckets);
+        for (std::size_t bucket = 0; bucket < buckets; ++bucket)
+        {
+            auto start = static_cast<std::size_t>(std::floor(bucket * every)) + 1;
+            auto end = std::min(static_cast<std::size_t>(std::floor((bucket + 1) * every)) + 1, count - 1);
+            if (start >= end)
+                continue;
+
+            std::size_t lo = start, hi = start;
+            for (std::size_t i = start + 1; i < end; ++i)
+            {
+                if (values[i] < values[lo])
+                    lo = i;
+                if (values[i] > values[hi])
+                    hi = i;
+            }
+
+            indices.push_back(std::min(lo, hi));
+            if (lo != hi)
+                indices.push_back(std::max(lo, hi));
+        }
+
+        indices.push_back(count - 1);
+        return indices;
+    }
+
+} // namespace qz
+
+#endif // CHAINSIM_DOWNSAMPLE_HPP
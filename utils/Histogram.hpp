@@ -0,0 +1,109 @@
+#ifndef CHAINSIM_HISTOGRAM_HPP
+#define CHAINSIM_HISTOGRAM_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace qz
+{
+
+    /* Log-linear (HDR-style) buckets over non-negative integers: values below 16 get their own
+     * bucket, above that every power of two is split into 16 sub-buckets (~6% resolution).
+     */
+    struct LogLinearBuckets
+    {
+        static constexpr int kSubBucketBits = 4;
+        static constexpr int kSubBuckets = 1 << kSubBucketBits;
+        static constexpr int kMaxExponent = 40; // ~1.1e12; as microseconds, ~12.7 days
+        static constexpr int kCount = (kMaxExponent - kSubBucketBits + 2) * kSubBuckets;
+
+        static int index(std::uint64_t value)
+        {
+            if (value < kSubBuckets)
+                return static_cast<int>(value);
+
+            int msb = 63 - __builtin_clzll(value);
+            if (msb > kMaxExponent)
+                return kCount - 1;
+
+            int group = msb - kSubBucketBits + 1;
+            int sub = static_cast<int>((value >> (msb - kSubBucketBits)) & (kSubBuckets - 1));
+            return group * kSubBuckets + sub;
+        }
+
+        // Exclusive upper bound of a bucket
+        static std::uint64_t upper_bound(int index)
+        {
+            if (index < kSubBuckets)
+                return static_cast<std::uint64_t>(index) + 1;
+
+            int group = index / kSubBuckets;
+            int sub = index % kSubBuckets;
+            return static_cast<std::uint64_t>(kSubBuckets + sub + 1) << (group - 1);
+        }
+
+        // Inclusive lower bound of a bucket
+        static std::uint64_t lower_bound(int index)
+        {
+            return index == 0 ? 0 : upper_bound(index - 1);
+        }
+
+        // Number of buckets holding values below 2^exponent (exponent >= 4)
+        static int buckets_below_power_of_two(int exponent)
+        {
+            return (exponent - kSubBucketBits + 1) * kSubBuckets;
+        }
+    };
+
+    /* Fixed-bin histogram of daily quantities over LogLinearBuckets.
+     * Exact below 16 units, which is where lost sales usually are. Every histogram has the same
+     * bins, so merging two is an element-wise sum whatever ranges they saw.
+     */
+    class Histogram
+    {
+    public:
+        void add(std::int64_t value)
+        {
+            ++m_counts[LogLinearBuckets::index(static_cast<std::uint64_t>(std::max<std::int64_t>(0, value)))];
+            ++m_count;
+        }
+
+        void merge(const Histogram &other)
+        {
+            for (int i = 0; i < LogLinearBuckets::kCount; ++i)
+                m_counts[i] += other.m_counts[i];
+            m_count += other.m_count;
+        }
+
+        [[nodiscard]] std::uint64_t count() const { return m_count; }
+
+        // Non-empty bins as (inclusive lower bound, exclusive upper bound, count)
+        struct Bin
+        {
+            std::uint64_t lower;
+            std::uint64_t upper;
+            std::uint64_t count;
+        };
+
+        [[nodiscard]] std::vector<Bin> bins() const
+        {
+            std::vector<Bin> bins;
+            for (int i = 0; i < LogLinearBuckets::kCount; ++i)
+            {
+                if (m_counts[i] > 0)
+                    bins.push_back({LogLinearBuckets::lower_bound(i), LogLinearBuckets::upper_bound(i), m_counts[i]});
+            }
+            return bins;
+        }
+
+    private:
+        std::array<std::uint64_t, LogLinearBuckets::kCount> m_counts{};
+        std::uint64_t m_count{0};
+    };
+
+} // namespace qz
+
+#endif // CHAINSIM_HISTOGRAM_HPP
@@ -0,0 +1,183 @@
+#ifndef CHAINSIM_JSONWRITER_HPP
+#define CHAINSIM_JSONWRITER_HPP
+
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace qz
+{
+
+    /* Streaming JSON writer appending straight into a (usually arena-backed) string.
+     * Unlike building a QJsonObject, no intermediate node is allocated per value, which matters
+     * for responses carrying thousands of numbers.
+     */
+    class JsonWriter
+    {
+    public:
+        explicit JsonWriter(std::pmr::string &out) : m_out{out} {}
+
+        void begin_object()
+        {
+            separate();
+            m_out.push_back('{');
+            push();
+        }
+
+        void end_object()
+        {
+            m_out.push_back('}');
+            --m_depth;
+        }
+
+        void begin_array()
+        {
+            separate();
+            m_out.push_back('[');
+            push();
+        }
+
+        void end_array()
+        {
+            m_out.push_back(']');
+            --m_depth;
+        }
+
+        void key(std::string_view name)
+        {
+            separate();
+            write_string(name);
+            m_out.push_back(':');
+            m_after_key = true;
+        }
+
+        template <typename T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, int> = 0>
+        void value(T number)
+        {
+            separate();
+            write_integer(static_cast<std::int64_t>(number));
+        }
+
+        void value(double number)
+        {
+            separate();
+            std::array<char, 32> buffer{};
+            auto [end, ec] = std::to_chars(buffer.data(), buffer.data() + buffer.size(), number);
+            m_out.append(buffer.data(), ec == std::errc() ? end - buffer.data() : 0);
+        }
+
+        void value(bool flag)
+        {
+            separate();
+            m_out.append(flag ? "true" : "false");
+        }
+
+        void value(std::string_view text)
+        {
+            separate();
+            write_string(text);
+        }
+
+        void value(const char *text)
+        {
+            value(std::string_view(text));
+        }
+
+        // Whole integer column in one go: the common payload of simulation responses
+        template <typename T>
+        void integer_array(const T *values, std::size_t count)
+        {
+            begin_array();
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                if (i > 0)
+                    m_out.push_back(',');
+                write_integer(static_cast<std::int64_t>(values[i]));
+            }
+            m_first[m_depth - 1] = false;
+            end_array();
+        }
+
+    private:
+        static constexpr int kMaxDepth = 32;
+
+        void push()
+        {
+            m_first[m_depth++] = true;
+        }
+
+        // Emits the comma between members/elements; a value directly after a key needs none
+        void separate()
+        {
+            if (m_after_key)
+            {
+                m_after_key = false;
+                return;
+            }
+            if (m_depth == 0)
+                return;
+            if (!m_first[m_depth - 1])
+                m_out.push_back(',');
+            m_first[m_depth - 1] = false;
+        }
+
+        void write_integer(std::int64_t number)
+        {
+            std::array<char, 24> buffer{};
+            auto [end, ec] = std::to_chars(buffer.data(), buffer.data() + buffer.size(), number);
+            m_out.append(buffer.data(), end - buffer.data());
+        }
+
+        void write_string(std::string_view text)
+        {
+            static constexpr char kHex[] = "0123456789abcdef";
+            m_out.push_back('"');
+            for (char c : text)
+            {
+                switch (c)
+                {
+                case '"':
+                    m_out.append("\\\"");
+                    break;
+                case '\\':
+                    m_out.append("\\\\");
+                    break;
+                case '\n':
+                    m_out.append("\\n");
+                    break;
+                case '\r':
+                    m_out.append("\\r");
+                    break;
+                case '\t':
+                    m_out.append("\\t");
+                    break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20)
+                    {
+                        m_out.append("\\u00");
+                        m_out.push_back(kHex[(c >> 4) & 0xF]);
+                        m_out.push_back(kHex[c & 0xF]);
+                    }
+                    else
+                    {
+                        m_out.push_back(c);
+                    }
+                }
+            }
+            m_out.push_back('"');
+        }
+
+        std::pmr::string &m_out;
+        std::array<bool, kMaxDepth> m_first{};
+        int m_depth{0};
+        bool m_after_key{false};
+    };
+
+} // namespace qz
+
+#endif // CHAINSIM_JSONWRITER_HPP
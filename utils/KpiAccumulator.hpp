@@ -0,0 +1,198 @@
+#ifndef CHAINSIM_KPIACCUMULATOR_HPP
+#define CHAINSIM_KPIACCUMULATOR_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include "Histogram.hpp"
+#include "QuantileSketch.hpp"
+
+namespace qz
+{
+
+    /* Welford's online mean/variance with min and max.
+     * Numerically stable for long horizons, where summing squares would lose precision.
+     */
+    class RunningStats
+    {
+    public:
+        void add(double x)
+        {
+            ++m_count;
+            double delta = x - m_mean;
+            m_mean += delta / static_cast<double>(m_count);
+            m_m2 += delta * (x - m_mean);
+            m_min = std::min(m_min, x);
+            m_max = std::max(m_max, x);
+        }
+
+        // Chan et al. combination, e.g. to pool replications run on different threads
+        void merge(const RunningStats &other)
+        {
+            if (other.m_count == 0)
+                return;
+            if (m_count == 0)
+            {
+                *this = other;
+                return;
+            }
+            auto n = static_cast<double>(m_count + other.m_count);
+            double delta = other.m_mean - m_mean;
+            m_mean += delta * static_cast<double>(other.m_count) / n;
+            m_m2 += other.m_m2 + delta * delta * static_cast<double>(m_count) * static_cast<double>(other.m_count) / n;
+            m_count += other.m_count;
+            m_min = std::min(m_min, other.m_min);
+            m_max = std::max(m_max, other.m_max);
+        }
+
+        [[nodiscard]] std::uint64_t count() const { return m_count; }
+        [[nodiscard]] double mean() const { return m_mean; }
+        // Sample variance (n - 1), 0 until there are two observations
+        [[nodiscard]] double variance() const { return m_count > 1 ? m_m2 / static_cast<double>(m_count - 1) : 0.0; }
+        [[nodiscard]] double stddev() const { return std::sqrt(variance()); }
+        [[nodiscard]] double min() const { return m_count > 0 ? m_min : 0.0; }
+        [[nodiscard]] double max() const { return m_count > 0 ? m_max : 0.0; }
+
+    private:
+        std::uint64_t m_count{0};
+        double m_mean{0.0};
+        double m_m2{0.0};
+        double m_min{std::numeric_limits<double>::infinity()};
+        double m_max{-std::numeric_limits<double>::infinity()};
+    };
+
+    // The KPIs reported for one run, same definitions as simulation_records_analysis.py
+    struct SimulationKpis
+    {
+        std::uint64_t days{0};
+        std::int64_t total_demand{0};
+        std::int64_t total_sales{0};
+        std::int64_t total_lost_sales{0};
+        std::int64_t total_purchases{0};
+        std::uint64_t order_count{0};
+        std::uint64_t stockout_days{0};
+        double service_level{0.0}; // Percent of demand served
+        double average_inventory{0.0};
+        double inventory_stddev{0.0};
+        double average_demand{0.0};
+        double demand_stddev{0.0};
+        double inventory_turns{0.0};
+        std::int64_t peak_inventory{0};
+        std::int64_t min_inventory{0};
+    };
+
+    /* Distributions behind the means: quantile sketches plus fixed-bin histograms.
+     * A cycle runs from one delivery to the next; its service is the percent of that cycle's
+     * demand that was served. Everything merges in O(sketch size), e.g. across replications.
+     */
+    struct KpiDistributions
+    {
+        QuantileSketch inventory;
+        QuantileSketch lost_sales;
+        QuantileSketch cycle_service;
+        Histogram inventory_histogram;
+        Histogram lost_sales_histogram;
+
+        void merge(const KpiDistributions &other)
+        {
+            inventory.merge(other.inventory);
+            lost_sales.merge(other.lost_sales);
+            cycle_service.merge(other.cycle_service);
+            inventory_histogram.merge(other.inventory_histogram);
+            lost_sales_histogram.merge(other.lost_sales_histogram);
+        }
+    };
+
+    /* Updated once per simulated day so a run's KPIs never require the per-day records.
+     * Memory is constant in the horizon.
+     */
+    class KpiAccumulator
+    {
+    public:
+        // `procurement` is the delivery received that day, which starts a new replenishment cycle
+        void add_day(std::int64_t inventory, std::int64_t demand, std::int64_t sales,
+                     std::int64_t lost_sales, std::int64_t purchase, std::int64_t procurement = 0)
+        {
+            if (m_track_distributions)
+            {
+                if (procurement > 0 && m_inventory.count() > 0)
+                {
+                    m_distributions.cycle_service.add(
+                        m_cycle_demand > 0 ? 100.0 * static_cast<double>(m_cycle_sales) / static_cast<double>(m_cycle_demand)
+                                           : 100.0);
+                    m_cycle_demand = 0;
+                    m_cycle_sales = 0;
+                }
+                m_cycle_demand += demand;
+                m_cycle_sales += sales;
+
+                m_distributions.inventory.add(static_cast<double>(inventory));
+                m_distributions.lost_sales.add(static_cast<double>(lost_sales));
+                m_distributions.inventory_histogram.add(inventory);
+                m_distributions.lost_sales_histogram.add(lost_sales);
+            }
+
+            m_inventory.add(static_cast<double>(inventory));
+            m_demand.add(static_cast<double>(demand));
+            m_total_demand += demand;
+            m_total_sales += sales;
+            m_total_lost_sales += lost_sales;
+            m_total_purchases += purchase;
+            m_order_count += purchase > 0 ? 1 : 0;
+            m_stockout_days += lost_sales > 0 ? 1 : 0;
+        }
+
+        // Without distributions only the means and totals are kept, which is cheaper per day
+        void reset(bool track_distributions = true)
+        {
+            *this = KpiAccumulator();
+            m_track_distributions = track_distributions;
+        }
+
+        // Completed cycles only: the one still open at the end of the run is not counted
+        [[nodiscard]] const KpiDistributions &distributions() const { return m_distributions; }
+
+        [[nodiscard]] SimulationKpis summary() const
+        {
+            SimulationKpis kpis;
+            kpis.days = m_inventory.count();
+            kpis.total_demand = m_total_demand;
+            kpis.total_sales = m_total_sales;
+            kpis.total_lost_sales = m_total_lost_sales;
+            kpis.total_purchases = m_total_purchases;
+            kpis.order_count = m_order_count;
+            kpis.stockout_days = m_stockout_days;
+            kpis.service_level = m_total_demand > 0
+                                     ? 100.0 * static_cast<double>(m_total_sales) / static_cast<double>(m_total_demand)
+                                     : 100.0;
+            kpis.average_inventory = m_inventory.mean();
+            kpis.inventory_stddev = m_inventory.stddev();
+            kpis.average_demand = m_demand.mean();
+            kpis.demand_stddev = m_demand.stddev();
+            kpis.inventory_turns = m_inventory.mean() > 0
+                                       ? static_cast<double>(m_total_sales) / m_inventory.mean()
+                                       : 0.0;
+            kpis.peak_inventory = static_cast<std::int64_t>(m_inventory.max());
+            kpis.min_inventory = static_cast<std::int64_t>(m_inventory.min());
+            return kpis;
+        }
+
+    private:
+        RunningStats m_inventory;
+        RunningStats m_demand;
+        std::int64_t m_total_demand{0};
+        std::int64_t m_total_sales{0};
+        std::int64_t m_total_lost_sales{0};
+        std::int64_t m_total_purchases{0};
+        std::uint64_t m_order_count{0};
+        std::uint64_t m_stockout_days{0};
+        bool m_track_distributions{true};
+        KpiDistributions m_distributions;
+        std::int64_t m_cycle_demand{0};
+        std::int64_t m_cycle_sales{0};
+    };
+
+} // namespace qz
+
+#endif // CHAINSIM_KPIACCUMULATOR_HPP
@@ -0,0 +1,354 @@
+#ifndef CHAINSIM_METRICS_HPP
+#define CHAINSIM_METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Histogram.hpp"
+#include "Trace.hpp"
+
+namespace qz
+{
+
+    // Latencies are recorded in microseconds
+    using LatencyBuckets = LogLinearBuckets;
+
+    /* Server metrics in Prometheus text format.
+     * Every thread writes only to its own shard with plain relaxed load/store pairs (no locked
+     * instructions, no shared cache lines); a scrape sums all shards. The registry mutex is
+     * only taken when a thread records its first sample and during scrapes.
+     */
+    class ServerMetrics
+    {
+    public:
+        enum class Route
+        {
+            Simulate,
+            Stream,
+            Series,
+            Metrics,
+            Optimize,
+            Evaluate,
+            Replicate,
+            StockoutRisk,
+            Sensitivity,
+            Compare,
+            Explain,
+            Aggregate,
+            Debug,
+            Binary,
+            Other,
+            Count
+        };
+
+        enum class Phase
+        {
+            Parse,
+            Simulate,
+            Serialize,
+            Write,
+            Count
+        };
+
+        static ServerMetrics &instance()
+        {
+            static ServerMetrics metrics;
+            return metrics;
+        }
+
+        void request_started(Route route)
+        {
+            // Scrapes are left out of requests in progress, so a scrape never reports itself
+            if (route == Route::Metrics)
+                return;
+            auto &s = shard();
+            bump(s.started, 1);
+        }
+
+        void request_finished(Route route, int status, std::chrono::nanoseconds busy)
+        {
+            auto &s = shard();
+            bump(s.requests[static_cast<int>(route)][status_index(status)], 1);
+            if (route != Route::Metrics)
+                bump(s.finished, 1);
+            bump(s.busy_ns, static_cast<std::uint64_t>(busy.count()));
+        }
+
+        void record_phase(Phase phase, std::chrono::nanoseconds elapsed)
+        {
+            auto &s = shard();
+            auto ns = static_cast<std::uint64_t>(elapsed.count());
+            bump(s.phase_buckets[static_cast<int>(phase)][LatencyBuckets::index(ns / 1000)], 1);
+            bump(s.phase_sum_ns[static_cast<int>(phase)], ns);
+        }
+
+        void record_simulated_days(std::uint64_t days, std::chrono::nanoseconds elapsed)
+        {
+            auto &s = shard();
+            bump(s.simulated_days, days);
+            bump(s.simulate_ns, static_cast<std::uint64_t>(elapsed.count()));
+        }
+
+        // A request answered with the result of an identical one already in flight
+        void record_coalesced()
+        {
+            bump(shard().coalesced, 1);
+        }
+
+        static const char *route_label(Route route)
+        {
+            static constexpr const char *kRoutes[] = {"simulate", "stream", "series", "metrics", "optimize", "evaluate", "replicate", "stockout_risk", "sensitivity", "compare", "explain", "aggregate", "debug", "binary", "other"};
+            return kRoutes[static_cast<int>(route)];
+        }
+
+        static const char *phase_label(Phase phase)
+        {
+            static constexpr const char *kPhases[] = {"parse", "simulate", "serialize", "write"};
+            return kPhases[static_cast<int>(phase)];
+        }
+
+        [[nodiscard]] std::string exposition() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto now = std::chrono::steady_clock::now();
+
+            std::ostringstream out;
+            out << "# HELP chainsim_requests_total Completed HTTP and binary-protocol requests by route and status.\n"
+                << "# TYPE chainsim_requests_total counter\n";
+            for (int route = 0; route < kRouteCount; ++route)
+            {
+                for (int status = 0; status < kStatusCount; ++status)
+                {
+                    std::uint64_t total = 0;
+                    for (const auto &s : m_shards)
+                        total += s->requests[route][status].load(std::memory_order_relaxed);
+                    if (total == 0)
+                        continue;
+                    out << "chainsim_requests_total{route=\"" << route_label(static_cast<Route>(route)) << "\",status=\""
+                        << status_label(status) << "\"} " << total << "\n";
+                }
+            }
+
+            out << "# HELP chainsim_request_phase_seconds Request latency split by processing phase.\n"
+                << "# TYPE chainsim_request_phase_seconds histogram\n";
+            for (int phase = 0; phase < kPhaseCount; ++phase)
+            {
+                std::vector<std::uint64_t> buckets(LatencyBuckets::kCount, 0);
+                std::uint64_t sum_ns = 0;
+                for (const auto &s : m_shards)
+                {
+                    for (int i = 0; i < LatencyBuckets::kCount; ++i)
+                        buckets[i] += s->phase_buckets[phase][i].load(std::memory_order_relaxed);
+                    sum_ns += s->phase_sum_ns[phase].load(std::memory_order_relaxed);
+                }
+
+                // Export power-of-two boundaries from 16us to ~33s; they align with the fine buckets
+                std::uint64_t cumulative = 0;
+                int next = 0;
+                for (int exponent = LatencyBuckets::kSubBucketBits; exponent <= 25; ++exponent)
+                {
+                    int limit = LatencyBuckets::buckets_below_power_of_two(exponent);
+                    for (; next < limit; ++next)
+                        cumulative += buckets[next];
+                    out << "chainsim_request_phase_seconds_bucket{phase=\"" << phase_label(static_cast<Phase>(phase)) << "\",le=\""
+                        << static_cast<double>(std::uint64_t{1} << exponent) / 1e6 << "\"} " << cumulative << "\n";
+                }
+                for (; next < LatencyBuckets::kCount; ++next)
+                    cumulative += buckets[next];
+                out << "chainsim_request_phase_seconds_bucket{phase=\"" << phase_label(static_cast<Phase>(phase)) << "\",le=\"+Inf\"} "
+                    << cumulative << "\n"
+                    << "chainsim_request_phase_seconds_sum{phase=\"" << phase_label(static_cast<Phase>(phase)) << "\"} "
+                    << static_cast<double>(sum_ns) / 1e9 << "\n"
+                    << "chainsim_request_phase_seconds_count{phase=\"" << phase_label(static_cast<Phase>(phase)) << "\"} "
+                    << cumulative << "\n";
+
+                for (double q : {0.5, 0.9, 0.99, 0.999})
+                {
+                    out << "chainsim_request_phase_quantile_seconds{phase=\"" << phase_label(static_cast<Phase>(phase))
+                        << "\",quantile=\"" << q << "\"} " << quantile(buckets, cumulative, q) << "\n";
+                }
+            }
+
+            std::uint64_t started = 0, finished = 0, days = 0, simulate_ns = 0, coalesced = 0;
+            for (const auto &s : m_shards)
+            {
+                coalesced += s->coalesced.load(std::memory_order_relaxed);
+                started += s->started.load(std::memory_order_relaxed);
+                finished += s->finished.load(std::memory_order_relaxed);
+                days += s->simulated_days.load(std::memory_order_relaxed);
+                simulate_ns += s->simulate_ns.load(std::memory_order_relaxed);
+            }
+            auto in_progress = started >= finished ? started - finished : 0;
+
+            out << "# HELP chainsim_simulated_days_total Days simulated by the engine.\n"
+                << "# TYPE chainsim_simulated_days_total counter\n"
+                << "chainsim_simulated_days_total " << days << "\n"
+                << "# HELP chainsim_engine_days_per_second Engine throughput while simulating.\n"
+                << "# TYPE chainsim_engine_days_per_second gauge\n"
+                << "chainsim_engine_days_per_second "
+                << (simulate_ns == 0 ? 0.0 : static_cast<double>(days) * 1e9 / static_cast<double>(simulate_ns)) << "\n"
+                << "# HELP chainsim_coalesced_requests_total Requests answered with the result of an identical in-flight request.\n"
+                << "# TYPE chainsim_coalesced_requests_total counter\n"
+                << "chainsim_coalesced_requests_total " << coalesced << "\n"
+                << "# HELP chainsim_requests_in_progress Requests being handled, excluding /metrics scrapes.\n"
+                << "# TYPE chainsim_requests_in_progress gauge\n"
+                << "chainsim_requests_in_progress " << in_progress << "\n"
+                << "# HELP chainsim_worker_utilization Fraction of wall time each worker thread spent on requests.\n"
+                << "# TYPE chainsim_worker_utilization gauge\n";
+
+            for (std::size_t worker = 0; worker < m_shards.size(); ++worker)
+            {
+                const auto &s = m_shards[worker];
+                auto alive = std::chrono::duration_cast<std::chrono::nanoseconds>(now - s->created).count();
+                double busy = static_cast<double>(s->busy_ns.load(std::memory_order_relaxed));
+                out << "chainsim_worker_utilization{worker=\"" << worker << "\"} "
+                    << (alive > 0 ? busy / static_cast<double>(alive) : 0.0) << "\n";
+            }
+
+            return out.str();
+        }
+
+    private:
+        static constexpr int kRouteCount = static_cast<int>(Route::Count);
+        static constexpr int kPhaseCount = static_cast<int>(Phase::Count);
+        static constexpr int kStatusCount = 6;
+
+        struct Shard
+        {
+            std::array<std::array<std::atomic<std::uint64_t>, kStatusCount>, kRouteCount> requests{};
+            std::array<std::array<std::atomic<std::uint64_t>, LatencyBuckets::kCount>, kPhaseCount> phase_buckets{};
+            std::array<std::atomic<std::uint64_t>, kPhaseCount> phase_sum_ns{};
+            std::atomic<std::uint64_t> started{0};
+            std::atomic<std::uint64_t> finished{0};
+            std::atomic<std::uint64_t> busy_ns{0};
+            std::atomic<std::uint64_t> simulated_days{0};
+            std::atomic<std::uint64_t> simulate_ns{0};
+            std::atomic<std::uint64_t> coalesced{0};
+            std::chrono::steady_clock::time_point created{std::chrono::steady_clock::now()};
+        };
+
+        ServerMetrics() = default;
+
+        // Only the owning thread writes a shard, so a relaxed load/store pair is enough
+        static void bump(std::atomic<std::uint64_t> &counter, std::uint64_t value)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+
+        Shard &shard()
+        {
+            thread_local Shard *local = nullptr;
+            if (!local)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_shards.push_back(std::make_unique<Shard>());
+                local = m_shards.back().get();
+            }
+            return *local;
+        }
+
+        static int status_index(int status)
+        {
+            switch (status)
+            {
+            case 200:
+                return 0;
+            case 204:
+                return 1;
+            case 400:
+                return 2;
+            case 404:
+                return 3;
+            case 500:
+                return 4;
+            default:
+                return 5;
+            }
+        }
+
+        static const char *status_label(int index)
+        {
+            static constexpr const char *kLabels[] = {"200", "204", "400", "404", "500", "other"};
+            return kLabels[index];
+        }
+
+        static double quantile(const std::vector<std::uint64_t> &buckets, std::uint64_t total, double q)
+        {
+            if (total == 0)
+                return 0.0;
+
+            auto rank = static_cast<std::uint64_t>(q * static_cast<double>(total - 1)) + 1;
+            std::uint64_t cumulative = 0;
+            for (int i = 0; i < LatencyBuckets::kCount; ++i)
+            {
+                cumulative += buckets[i];
+                if (cumulative >= rank)
+                    return static_cast<double>(LatencyBuckets::upper_bound(i)) / 1e6;
+            }
+            return static_cast<double>(LatencyBuckets::upper_bound(LatencyBuckets::kCount - 1)) / 1e6;
+        }
+
+        mutable std::mutex m_mutex;
+        std::vector<std::unique_ptr<Shard>> m_shards;
+    };
+
+    // Records the lifetime of the enclosing scope as one request phase, and as a trace span
+    class ScopedPhase
+    {
+    public:
+        explicit ScopedPhase(ServerMetrics::Phase phase)
+            : m_span{ServerMetrics::phase_label(phase), "phase"}, m_phase{phase},
+              m_start{std::chrono::steady_clock::now()} {}
+
+        ~ScopedPhase()
+        {
+            ServerMetrics::instance().record_phase(m_phase, std::chrono::steady_clock::now() - m_start);
+        }
+
+        ScopedPhase(const ScopedPhase &) = delete;
+        ScopedPhase &operator=(const ScopedPhase &) = delete;
+
+    private:
+        TraceSpan m_span;
+        ServerMetrics::Phase m_phase;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    // Counts a request from acceptance to response, including the time it kept its worker busy;
+    // traces show it as a span named after the route
+    class ScopedRequest
+    {
+    public:
+        explicit ScopedRequest(ServerMetrics::Route route)
+            : m_span{ServerMetrics::route_label(route), "request"}, m_route{route},
+              m_start{std::chrono::steady_clock::now()}
+        {
+            ServerMetrics::instance().request_started(route);
+        }
+
+        ~ScopedRequest()
+        {
+            ServerMetrics::instance().request_finished(m_route, m_status, std::chrono::steady_clock::now() - m_start);
+        }
+
+        void set_status(int status) { m_status = status; }
+
+        ScopedRequest(const ScopedRequest &) = delete;
+        ScopedRequest &operator=(const ScopedRequest &) = delete;
+
+    private:
+        TraceSpan m_span;
+        ServerMetrics::Route m_route;
+        int m_status{200};
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+} // namespace qz
+
+#endif // CHAINSIM_METRICS_HPP
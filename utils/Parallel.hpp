@@ -0,0 +1,88 @@
+#ifndef CHAINSIM_PARALLEL_HPP
+#define CHAINSIM_PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace qz
+{
+
+    // 0 means one thread per core
+    inline unsigned resolve_thread_count(unsigned threads)
+    {
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        return threads;
+    }
+
+    /* Runs fn(i) for i in [0, count) on up to `threads` threads.
+     * Indices are handed out one at a time, so uneven work (e.g. replications of different
+     * horizons) still balances. The first exception thrown by fn is rethrown on the caller.
+     */
+    template <typename Fn>
+    void parallel_for(std::size_t count, unsigned threads, Fn &&fn)
+    {
+        threads = static_cast<unsigned>(std::min<std::size_t>(resolve_thread_count(threads), count));
+        if (threads <= 1)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+                fn(i);
+            return;
+        }
+
+        std::atomic<std::size_t> next{0};
+        std::exception_ptr error;
+        std::mutex error_mutex;
+
+        auto worker = [&]()
+        {
+            for (std::size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1))
+            {
+                try
+                {
+                    fn(i);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!error)
+                        error = std::current_exception();
+                    next.store(count); // Stop handing out work
+                }
+            }
+        };
+
+        std::vector<std::thread> pool;
+        pool.reserve(threads - 1);
+        for (unsigned t = 1; t < threads; ++t)
+            pool.emplace_back(worker);
+        worker();
+        for (auto &thread : pool)
+            thread.join();
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    /* parallel_for that keeps fn(i) as element i of the result.
+     * Replications are indexed by seed, so callers pooling the results in order get the same
+     * estimates whichever thread ran which replication.
+     */
+    template <typename Fn>
+    auto parallel_map(std::size_t count, unsigned threads, Fn &&fn)
+    {
+        std::vector<std::invoke_result_t<Fn &, std::size_t>> results(count);
+        parallel_for(count, threads, [&](std::size_t i)
+                     { results[i] = fn(i); });
+        return results;
+    }
+
+} // namespace qz
+
+#endif // CHAINSIM_PARALLEL_HPP
@@ -0,0 +1,162 @@
+#ifndef CHAINSIM_QUANTILESKETCH_HPP
+#define CHAINSIM_QUANTILESKETCH_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace qz
+{
+
+    /* KLL quantile sketch (Karnin, Lang, Liberty 2016).
+     *
+     * Level h holds samples that each stand for 2^h observations. Once the sketch is full, the
+     * lowest level over its capacity is sorted and every other sample is promoted to the level
+     * above (lazy compaction, so each sort covers many additions). Memory
+     * stays around 3k samples however many observations are added, with a rank error of about
+     * 1.7/k (~1% for the default k = 200). Merging appends level by level and compacts, which is
+     * O(sketch size); merged sketches give the same guarantees as if one sketch had seen
+     * everything. The compaction offsets come from a fixed-seed generator, so the same inputs
+     * always give the same sketch.
+     */
+    class QuantileSketch
+    {
+    public:
+        explicit QuantileSketch(std::uint32_t k = 200) : m_k(std::max<std::uint32_t>(8, k))
+        {
+            add_level();
+        }
+
+        void add(double x)
+        {
+            m_levels[0].push_back(x);
+            ++m_count;
+            ++m_retained;
+            m_min = std::min(m_min, x);
+            m_max = std::max(m_max, x);
+            if (m_retained >= m_total_capacity)
+                compact();
+        }
+
+        void merge(const QuantileSketch &other)
+        {
+            if (other.m_count == 0)
+                return;
+            while (m_levels.size() < other.m_levels.size())
+                add_level();
+            for (std::size_t h = 0; h < other.m_levels.size(); ++h)
+                m_levels[h].insert(m_levels[h].end(), other.m_levels[h].begin(), other.m_levels[h].end());
+            m_count += other.m_count;
+            m_retained += other.m_retained;
+            m_min = std::min(m_min, other.m_min);
+            m_max = std::max(m_max, other.m_max);
+            while (m_retained >= m_total_capacity)
+                compact();
+        }
+
+        [[nodiscard]] std::uint64_t count() const { return m_count; }
+        [[nodiscard]] double min() const { return m_count > 0 ? m_min : 0.0; }
+        [[nodiscard]] double max() const { return m_count > 0 ? m_max : 0.0; }
+
+        // Smallest retained value whose weighted rank reaches q of the observations, q in [0, 1]
+        [[nodiscard]] double quantile(double q) const
+        {
+            if (m_count == 0)
+                return 0.0;
+            if (q <= 0.0)
+                return m_min;
+            if (q >= 1.0)
+                return m_max;
+
+            std::vector<std::pair<double, std::uint64_t>> weighted;
+            for (std::size_t h = 0; h < m_levels.size(); ++h)
+                for (double x : m_levels[h])
+                    weighted.emplace_back(x, std::uint64_t{1} << h);
+            std::sort(weighted.begin(), weighted.end());
+
+            std::uint64_t total = 0;
+            for (const auto &item : weighted)
+                total += item.second;
+
+            auto target = static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(total)));
+            std::uint64_t rank = 0;
+            for (const auto &item : weighted)
+            {
+                rank += item.second;
+                if (rank >= target)
+                    return item.first;
+            }
+            return m_max;
+        }
+
+        // Retained samples, for sizing; independent of the number of observations
+        [[nodiscard]] std::size_t retained() const { return m_retained; }
+
+    private:
+        // Lower levels get geometrically smaller capacities (2/3 per level below the top, at least 8)
+        void add_level()
+        {
+            m_levels.emplace_back();
+            m_capacities.resize(m_levels.size());
+            m_total_capacity = 0;
+            for (std::size_t h = 0; h < m_levels.size(); ++h)
+            {
+                auto depth = static_cast<double>(m_levels.size() - 1 - h);
+                m_capacities[h] = std::max<std::size_t>(8, static_cast<std::size_t>(std::ceil(m_k * std::pow(2.0 / 3.0, depth))));
+                m_total_capacity += m_capacities[h];
+            }
+        }
+
+        // Halves the lowest level over its capacity
+        void compact()
+        {
+            std::size_t h = 0;
+            while (m_levels[h].size() < m_capacities[h])
+                ++h;
+            if (h + 1 == m_levels.size())
+                add_level();
+
+            auto &level = m_levels[h];
+            std::sort(level.begin(), level.end());
+
+            // An odd sample out stays behind, so weight is conserved exactly
+            bool odd = level.size() % 2 == 1;
+            double kept = odd ? level.back() : 0.0;
+            std::size_t pairs = level.size() / 2;
+            std::size_t offset = next_bit();
+            auto &above = m_levels[h + 1];
+            for (std::size_t i = 0; i < pairs; ++i)
+                above.push_back(level[2 * i + offset]);
+
+            level.clear();
+            if (odd)
+                level.push_back(kept);
+            m_retained -= pairs;
+        }
+
+        // xorshift64, fixed seed: unbiased offsets that are still reproducible run to run
+        std::size_t next_bit()
+        {
+            m_random ^= m_random << 13;
+            m_random ^= m_random >> 7;
+            m_random ^= m_random << 17;
+            return static_cast<std::size_t>(m_random >> 63);
+        }
+
+        std::uint32_t m_k;
+        std::vector<std::vector<double>> m_levels;
+        std::vector<std::size_t> m_capacities;
+        std::size_t m_total_capacity{0};
+        std::size_t m_retained{0};
+        std::uint64_t m_count{0};
+        double m_min{std::numeric_limits<double>::infinity()};
+        double m_max{-std::numeric_limits<double>::infinity()};
+        std::uint64_t m_random{0x9E3779B97F4A7C15ull};
+    };
+
+} // namespace qz
+
+#endif // CHAINSIM_QUANTILESKETCH_HPP
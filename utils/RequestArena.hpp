@@ -0,0 +1,144 @@
+#ifndef CHAINSIM_REQUESTARENA_HPP
+#define CHAINSIM_REQUESTARENA_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+namespace qz
+{
+
+    /* Monotonic per-request arena.
+     * Allocations bump a pointer inside one retained buffer and are all released at once by
+     * reset(). When a request outgrows the buffer, the overflow comes from the heap and the
+     * buffer is enlarged on the next reset, so steady-state requests never touch the allocator.
+     */
+    class RequestArena
+    {
+    public:
+        static constexpr std::size_t kInitialBytes = 64 * 1024;
+        static constexpr std::size_t kMaxRetainedBytes = 32 * 1024 * 1024;
+
+        explicit RequestArena(std::size_t initial_bytes = kInitialBytes)
+            : m_buffer(initial_bytes)
+        {
+            m_resource.emplace(m_buffer.data(), m_buffer.size(), &m_upstream);
+        }
+
+        RequestArena(const RequestArena &) = delete;
+        RequestArena &operator=(const RequestArena &) = delete;
+
+        [[nodiscard]] std::pmr::memory_resource *resource() { return &*m_resource; }
+        [[nodiscard]] std::size_t capacity() const { return m_buffer.size(); }
+
+        void reset()
+        {
+            std::size_t overflow = m_upstream.allocated();
+            m_resource->release();
+            m_upstream.clear();
+
+            if (overflow > 0 && m_buffer.size() < kMaxRetainedBytes)
+            {
+                std::size_t grown = std::min(kMaxRetainedBytes, m_buffer.size() + overflow);
+                m_resource.reset();
+                m_buffer.assign(grown, std::byte{0});
+                m_resource.emplace(m_buffer.data(), m_buffer.size(), &m_upstream);
+            }
+        }
+
+    private:
+        // Heap fallback that remembers how much the arena overflowed
+        class CountingResource : public std::pmr::memory_resource
+        {
+        public:
+            [[nodiscard]] std::size_t allocated() const { return m_allocated; }
+            void clear() { m_allocated = 0; }
+
+        private:
+            void *do_allocate(std::size_t bytes, std::size_t alignment) override
+            {
+                m_allocated += bytes;
+                return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+            }
+
+            void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override
+            {
+                std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+            }
+
+            [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+            {
+                return this == &other;
+            }
+
+            std::size_t m_allocated{0};
+        };
+
+        std::vector<std::byte> m_buffer;
+        CountingResource m_upstream;
+        std::optional<std::pmr::monotonic_buffer_resource> m_resource;
+    };
+
+    /* Thread-local pool of arenas. A lease hands out a warm arena and returns it, reset, when it
+     * goes out of scope. Each server thread therefore reuses the same few buffers for every request.
+     */
+    class ArenaPool
+    {
+    public:
+        static constexpr std::size_t kMaxPooled = 4;
+
+        class Lease
+        {
+        public:
+            explicit Lease(std::unique_ptr<RequestArena> arena) : m_arena(std::move(arena)) {}
+            ~Lease()
+            {
+                if (m_arena)
+                    ArenaPool::release(std::move(m_arena));
+            }
+
+            Lease(Lease &&) noexcept = default;
+            Lease &operator=(Lease &&) noexcept = default;
+            Lease(const Lease &) = delete;
+            Lease &operator=(const Lease &) = delete;
+
+            RequestArena *operator->() { return m_arena.get(); }
+            RequestArena &operator*() { return *m_arena; }
+
+        private:
+            std::unique_ptr<RequestArena> m_arena;
+        };
+
+        static Lease acquire()
+        {
+            auto &pool = free_list();
+            if (pool.empty())
+                return Lease(std::make_unique<RequestArena>());
+
+            auto arena = std::move(pool.back());
+            pool.pop_back();
+            return Lease(std::move(arena));
+        }
+
+    private:
+        static std::vector<std::unique_ptr<RequestArena>> &free_list()
+        {
+            thread_local std::vector<std::unique_ptr<RequestArena>> pool;
+            return pool;
+        }
+
+        static void release(std::unique_ptr<RequestArena> arena)
+        {
+            arena->reset();
+            auto &pool = free_list();
+            if (pool.size() < kMaxPooled)
+                pool.push_back(std::move(arena));
+        }
+    };
+
+} // namespace qz
+
+#endif // CHAINSIM_REQUESTARENA_HPP
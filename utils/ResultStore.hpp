@@ -0,0 +1,83 @@
+#ifndef CHAINSIM_RESULTSTORE_HPP
+#define CHAINSIM_RESULTSTORE_HPP
+
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRandomGenerator>
+#include <QString>
+#include <QVector>
+#include <memory>
+#include "DecisionTrace.hpp"
+
+namespace qz
+{
+
+    // A finished simulation kept server-side so clients can query slices of it later
+    struct StoredResult
+    {
+        using simulation_records_t = QMap<QString, QVector<qint64>>;
+
+        QString id;
+        simulation_records_t records;
+        DecisionTrace decisions;                      // Empty unless the run traced its decisions
+        std::shared_ptr<const PurchasePolicy> policy; // Renders the decisions on request
+    };
+
+    /* Bounded, thread-safe store of recent simulation results.
+     * Least recently used results are evicted once `capacity` is reached.
+     */
+    class ResultStore
+    {
+    public:
+        explicit ResultStore(qsizetype capacity = 64) : m_capacity{capacity} {}
+
+        std::shared_ptr<const StoredResult> insert(StoredResult::simulation_records_t records,
+                                                   DecisionTrace decisions = {},
+                                                   std::shared_ptr<const PurchasePolicy> policy = nullptr)
+        {
+            auto result = std::make_shared<StoredResult>();
+            result->id = QString::number(QRandomGenerator::global()->generate64(), 16);
+            result->records = std::move(records);
+            result->decisions = std::move(decisions);
+            result->policy = std::move(policy);
+            insert(result);
+            return result;
+        }
+
+        void insert(const std::shared_ptr<const StoredResult> &result)
+        {
+            QMutexLocker lock(&m_mutex);
+            m_results.insert(result->id, result);
+            m_order.removeOne(result->id);
+            m_order.append(result->id);
+            while (m_order.size() > m_capacity)
+            {
+                m_results.remove(m_order.takeFirst());
+            }
+        }
+
+        std::shared_ptr<const StoredResult> find(const QString &id)
+        {
+            QMutexLocker lock(&m_mutex);
+            auto it = m_results.constFind(id);
+            if (it == m_results.constEnd())
+                return nullptr;
+
+            m_order.removeOne(id);
+            m_order.append(id);
+            return it.value();
+        }
+
+    private:
+        qsizetype m_capacity;
+        QMutex m_mutex;
+        QHash<QString, std::shared_ptr<const StoredResult>> m_results;
+        QList<QString> m_order; // Least recently used first
+    };
+
+} // namespace qz
+
+#endif // CHAINSIM_RESULTSTORE_HPP
@@ -0,0 +1,253 @@
+#ifndef CHAINSIM_SAMPLINGPROFILER_HPP
+#define CHAINSIM_SAMPLINGPROFILER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__linux__)
+#include <csignal>
+#include <ctime>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <sys/prctl.h>
+#endif
+
+namespace qz
+{
+
+    struct ProfileResult
+    {
+        std::string folded;     // "thread;outer;...;inner count" per line, for flamegraph.pl or speedscope
+        std::uint64_t samples{0};
+        std::uint64_t dropped{0}; // Ticks that found the sample buffer full
+        unsigned hz{0};
+    };
+
+    /* CPU sampling profiler for the whole process, driven by SIGPROF.
+     *
+     * A CLOCK_PROCESS_CPUTIME_ID timer raises SIGPROF `hz` times per CPU-second, on whichever
+     * thread is running, so threads are sampled in proportion to the CPU they use. The handler
+     * only claims a slot of a buffer allocated before the timer starts, copies the return
+     * addresses with backtrace() and the thread name with prctl; symbolization and folding run
+     * after the timer is deleted. backtrace() is not formally async-signal-safe, but it only
+     * allocates when it first loads the unwinder, which start() forces outside the handler.
+     *
+     * Idle, the profiler costs nothing: there is no timer, and the handler (installed on first
+     * use and kept, so a late signal never falls back to SIGPROF's default of terminating the
+     * process) returns at once. Active, memory is bounded by the buffer and CPU by `hz`.
+     */
+    class SamplingProfiler
+    {
+    public:
+        static constexpr int kMaxDepth = 64;
+        static constexpr unsigned kMaxHz = 1000;
+        static constexpr std::size_t kMaxSamples = 1 << 15;
+
+        static SamplingProfiler &instance()
+        {
+            static SamplingProfiler profiler;
+            return profiler;
+        }
+
+        static constexpr bool supported()
+        {
+#if defined(__linux__)
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        [[nodiscard]] bool active() const { return m_active.load(); }
+
+        // Starts sampling; at most `max_samples` stacks are kept, later ticks are counted as dropped
+        void start(unsigned hz, std::size_t max_samples = kMaxSamples)
+        {
+            if (!supported())
+            {
+                throw std::invalid_argument("The sampling profiler needs Linux");
+            }
+            if (hz == 0 || hz > kMaxHz)
+            {
+                throw std::invalid_argument("Sampling rate must be between 1 and " + std::to_string(kMaxHz) + " Hz");
+            }
+            if (m_active.exchange(true))
+            {
+                throw std::invalid_argument("A profile is already being recorded");
+            }
+
+#if defined(__linux__)
+            m_samples = std::make_unique<Sample[]>(std::min(max_samples, kMaxSamples));
+            m_capacity = std::min(max_samples, kMaxSamples);
+            m_next.store(0);
+            m_dropped.store(0);
+            m_hz = hz;
+
+            void *warm_up[1];
+            backtrace(warm_up, 1); // Loads the unwinder now rather than inside the handler
+
+            struct sigaction action{};
+            action.sa_sigaction = &SamplingProfiler::handle_signal;
+            action.sa_flags = SA_SIGINFO | SA_RESTART;
+            sigemptyset(&action.sa_mask);
+            sigaction(SIGPROF, &action, nullptr);
+
+            sigevent event{};
+            event.sigev_notify = SIGEV_SIGNAL;
+            event.sigev_signo = SIGPROF;
+            itimerspec interval{};
+            auto period_ns = 1000000000L / static_cast<long>(hz);
+            interval.it_interval.tv_sec = period_ns / 1000000000L;
+            interval.it_interval.tv_nsec = period_ns % 1000000000L;
+            interval.it_value = interval.it_interval;
+            if (timer_create(CLOCK_PROCESS_CPUTIME_ID, &event, &m_timer) != 0)
+            {
+                m_samples.reset();
+                m_active.store(false);
+                throw std::runtime_error("timer_create failed: errno " + std::to_string(errno));
+            }
+            m_recording.store(true);
+            timer_settime(m_timer, 0, &interval, nullptr);
+#endif
+        }
+
+        // Stops sampling and folds the recorded stacks
+        ProfileResult stop()
+        {
+            ProfileResult result;
+            if (!m_active.load())
+                return result;
+
+#if defined(__linux__)
+            timer_delete(m_timer);
+            m_recording.store(false);
+            while (m_in_handler.load() != 0)
+            {
+                // A handler that saw m_recording set is still writing its sample
+            }
+
+            result.hz = m_hz;
+            result.dropped = m_dropped.load();
+            auto recorded = std::min<std::size_t>(m_next.load(), m_capacity);
+
+            std::map<std::string, std::uint64_t> stacks;
+            std::unordered_map<void *, std::string> symbols;
+            for (std::size_t i = 0; i < recorded; ++i)
+            {
+                const auto &sample = m_samples[i];
+                if (!sample.ready.load(std::memory_order_acquire))
+                    continue;
+
+                std::string stack = sample.thread[0] ? sample.thread : "thread";
+                // Frame 0 is the handler and frame 1 the kernel's signal trampoline
+                for (int f = sample.depth - 1; f >= kSkippedFrames; --f)
+                {
+                    // Return addresses point after the call; the interrupted PC (first kept frame) does not
+                    auto *address = static_cast<char *>(sample.frames[f]) - (f > kSkippedFrames ? 1 : 0);
+                    auto it = symbols.find(address);
+                    if (it == symbols.end())
+                        it = symbols.emplace(address, symbolize(address)).first;
+                    stack.push_back(';');
+                    stack += it->second;
+                }
+                ++stacks[stack];
+                ++result.samples;
+            }
+
+            for (const auto &[stack, count] : stacks)
+                result.folded += stack + " " + std::to_string(count) + "\n";
+
+            m_samples.reset();
+#endif
+            m_active.store(false);
+            return result;
+        }
+
+    private:
+        static constexpr int kSkippedFrames = 2;
+
+        struct Sample
+        {
+            void *frames[kMaxDepth];
+            int depth{0};
+            char thread[16]{}; // Linux thread names are at most 15 characters
+            std::atomic<bool> ready{false};
+        };
+
+        SamplingProfiler() = default;
+
+#if defined(__linux__)
+        static void handle_signal(int, siginfo_t *, void *)
+        {
+            auto saved_errno = errno;
+            auto &self = instance();
+            self.m_in_handler.fetch_add(1);
+            if (self.m_recording.load())
+            {
+                auto index = self.m_next.fetch_add(1, std::memory_order_relaxed);
+                if (index < self.m_capacity)
+                {
+                    auto &sample = self.m_samples[index];
+                    sample.depth = backtrace(sample.frames, kMaxDepth);
+                    prctl(PR_GET_NAME, sample.thread, 0, 0, 0);
+                    sample.ready.store(true, std::memory_order_release);
+                }
+                else
+                {
+                    self.m_dropped.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            self.m_in_handler.fetch_sub(1);
+            errno = saved_errno;
+        }
+
+        // Demangled function name, or module+offset when the symbol is not exported
+        static std::string symbolize(void *address)
+        {
+            Dl_info info{};
+            if (!dladdr(address, &info))
+                return "[unknown]";
+            if (info.dli_sname)
+            {
+                int status = 0;
+                char *demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+                std::string name = status == 0 && demangled ? demangled : info.dli_sname;
+                std::free(demangled);
+                return name;
+            }
+
+            std::string module = info.dli_fname ? info.dli_fname : "[unknown]";
+            module = module.substr(module.find_last_of('/') + 1);
+            char offset[32];
+            std::snprintf(offset, sizeof(offset), "+0x%lx",
+                          static_cast<unsigned long>(static_cast<char *>(address) - static_cast<char *>(info.dli_fbase)));
+            return module + offset;
+        }
+
+        timer_t m_timer{};
+#endif
+
+        std::atomic<bool> m_active{false};
+        std::atomic<bool> m_recording{false};
+        std::atomic<int> m_in_handler{0};
+        std::unique_ptr<Sample[]> m_samples;
+        std::size_t m_capacity{0};
+        std::atomic<std::size_t> m_next{0};
+        std::atomic<std::uint64_t> m_dropped{0};
+        unsigned m_hz{0};
+    };
+
+} // namespace qz
+
+#endif // CHAINSIM_SAMPLINGPROFILER_HPP
@@ -0,0 +1,80 @@
+#ifndef CHAINSIM_SINGLEFLIGHT_HPP
+#define CHAINSIM_SINGLEFLIGHT_HPP
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace qz
+{
+
+    /* Coalesces concurrent calls for the same key into one computation.
+     *
+     * The first caller for a key runs fn() on its own thread; callers arriving with the same key
+     * while it runs block until it finishes and receive the same value (or the same exception).
+     * Nothing is cached: once the computation has finished, the next call for the key runs
+     * again. Value should be cheap to copy, e.g. a shared_ptr to an immutable result.
+     */
+    template <typename Key, typename Value, typename Hash = std::hash<Key>>
+    class SingleFlight
+    {
+    public:
+        struct Result
+        {
+            Value value;
+            bool shared{false}; // Computed by another caller
+        };
+
+        template <typename Fn>
+        Result run(const Key &key, Fn &&fn)
+        {
+            std::promise<Value> promise;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                auto it = m_calls.find(key);
+                if (it != m_calls.end())
+                {
+                    auto call = it->second;
+                    lock.unlock();
+                    return {call.get(), true};
+                }
+                m_calls.emplace(key, promise.get_future().share());
+            }
+
+            try
+            {
+                promise.set_value(fn());
+            }
+            catch (...)
+            {
+                promise.set_exception(std::current_exception());
+            }
+
+            std::shared_future<Value> call;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto it = m_calls.find(key);
+                call = std::move(it->second);
+                m_calls.erase(it);
+            }
+            return {call.get(), false};
+        }
+
+        [[nodiscard]] std::size_t in_flight() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_calls.size();
+        }
+
+    private:
+        mutable std::mutex m_mutex;
+        std::unordered_map<Key, std::shared_future<Value>, Hash> m_calls;
+    };
+
+} // namespace qz
+
+#endif // CHAINSIM_SINGLEFLIGHT_HPP
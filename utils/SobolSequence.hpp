@@ -0,0 +1,108 @@
+#ifndef CHAINSIM_SOBOLSEQUENCE_HPP
+#define CHAINSIM_SOBOLSEQUENCE_HPP
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace qz
+{
+
+    /* Sobol low-discrepancy sequence in [0, 1)^d, generated in Gray-code order (Antonov-Saleev).
+     * Direction numbers are Joe and Kuo's (new-joe-kuo-6.21201) for dimensions 2..21; the first
+     * dimension is the van der Corput sequence. The all-zero first point is skipped.
+     */
+    class SobolSequence
+    {
+    public:
+        static constexpr unsigned kMaxDimensions = 21;
+
+        explicit SobolSequence(unsigned dimensions) : m_point(dimensions), m_state(dimensions, 0), m_directions(dimensions)
+        {
+            if (dimensions == 0 || dimensions > kMaxDimensions)
+            {
+                throw std::invalid_argument("Sobol sequences support 1 to 21 dimensions");
+            }
+
+            struct Primitive
+            {
+                unsigned degree;
+                unsigned coefficients; // Interior coefficients of the primitive polynomial
+                std::array<std::uint32_t, 7> initial;
+            };
+            static constexpr Primitive kPrimitives[kMaxDimensions - 1] = {
+                {1, 0, {1}},
+                {2, 1, {1, 3}},
+                {3, 1, {1, 3, 1}},
+                {3, 2, {1, 1, 1}},
+                {4, 1, {1, 1, 3, 3}},
+                {4, 4, {1, 3, 5, 13}},
+                {5, 2, {1, 1, 5, 5, 17}},
+                {5, 4, {1, 1, 5, 5, 5}},
+                {5, 7, {1, 1, 7, 11, 19}},
+                {5, 11, {1, 1, 5, 1, 1}},
+                {5, 13, {1, 1, 1, 3, 11}},
+                {5, 14, {1, 3, 5, 5, 31}},
+                {6, 1, {1, 3, 3, 9, 7, 49}},
+                {6, 13, {1, 1, 1, 15, 21, 21}},
+                {6, 16, {1, 3, 1, 13, 27, 49}},
+                {6, 19, {1, 1, 1, 15, 7, 5}},
+                {6, 22, {1, 3, 1, 15, 13, 25}},
+                {6, 25, {1, 1, 5, 5, 19, 61}},
+                {7, 1, {1, 3, 7, 11, 23, 15, 103}},
+                {7, 4, {1, 3, 7, 13, 13, 15, 69}},
+            };
+
+            for (unsigned bit = 0; bit < kBits; ++bit)
+                m_directions[0][bit] = std::uint32_t{1} << (kBits - 1 - bit);
+
+            for (unsigned d = 1; d < dimensions; ++d)
+            {
+                const auto &primitive = kPrimitives[d - 1];
+                auto &v = m_directions[d];
+                for (unsigned bit = 0; bit < primitive.degree; ++bit)
+                    v[bit] = primitive.initial[bit] << (kBits - 1 - bit);
+                for (unsigned bit = primitive.degree; bit < kBits; ++bit)
+                {
+                    v[bit] = v[bit - primitive.degree] ^ (v[bit - primitive.degree] >> primitive.degree);
+                    for (unsigned k = 1; k < primitive.degree; ++k)
+                    {
+                        if ((primitive.coefficients >> (primitive.degree - 1 - k)) & 1u)
+                            v[bit] ^= v[bit - k];
+                    }
+                }
+            }
+        }
+
+        [[nodiscard]] unsigned dimensions() const { return static_cast<unsigned>(m_point.size()); }
+
+        // The next point; 2^32 - 1 points are available
+        const std::vector<double> &next()
+        {
+            // The lowest zero bit of the index picks the direction number that changes
+            unsigned bit = 0;
+            for (auto index = m_index; index & 1u; index >>= 1)
+                ++bit;
+            ++m_index;
+
+            for (std::size_t d = 0; d < m_point.size(); ++d)
+            {
+                m_state[d] ^= m_directions[d][bit];
+                m_point[d] = static_cast<double>(m_state[d]) / 4294967296.0;
+            }
+            return m_point;
+        }
+
+    private:
+        static constexpr unsigned kBits = 32;
+
+        std::vector<double> m_point;
+        std::vector<std::uint32_t> m_state;
+        std::vector<std::array<std::uint32_t, kBits>> m_directions;
+        std::uint32_t m_index{0};
+    };
+
+} // namespace qz
+
+#endif // CHAINSIM_SOBOLSEQUENCE_HPP
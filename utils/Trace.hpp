@@ -0,0 +1,316 @@
+#ifndef CHAINSIM_TRACE_HPP
+#define CHAINSIM_TRACE_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Set to 0 to compile every TraceSpan down to nothing
+#ifndef CHAINSIM_ENABLE_TRACING
+#define CHAINSIM_ENABLE_TRACING 1
+#endif
+
+namespace qz
+{
+
+    // A finished span; name and category must be string literals (or otherwise outlive the tracer)
+    struct TraceEvent
+    {
+        const char *name{nullptr};
+        const char *category{nullptr};
+        std::int64_t start_ns{0}; // Since the tracer was created
+        std::int64_t duration_ns{0};
+    };
+
+    /* Scoped timing spans, exported in Chrome trace-event format (chrome://tracing, Perfetto).
+     *
+     * Each thread appends to its own ring of kCapacity events, so a span costs two clock reads
+     * and four relaxed stores; once a ring is full the oldest events are overwritten. Recording
+     * is off until set_enabled(true), and a disabled span only loads one flag. As with
+     * ServerMetrics, the registry mutex is only taken by a thread's first span and by exports.
+     * A ring is allocated by a thread's first recorded span, not before, and returned when the
+     * thread exits; the next new thread takes it over, keeping the events already in it. The
+     * short-lived threads of parallel_for therefore share as many rings as ran at once.
+     */
+    class Tracer
+    {
+    public:
+        static constexpr std::size_t kCapacity = 1 << 14; // Events kept per thread
+
+        static Tracer &instance()
+        {
+            static Tracer tracer;
+            return tracer;
+        }
+
+        void set_enabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+        [[nodiscard]] bool enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+        [[nodiscard]] std::int64_t now_ns() const
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_epoch).count();
+        }
+
+        void record(const TraceEvent &event)
+        {
+            auto &b = buffer();
+            auto head = b.head.load(std::memory_order_relaxed);
+            auto &slot = b.events[head % kCapacity];
+            slot.name.store(event.name, std::memory_order_relaxed);
+            slot.category.store(event.category, std::memory_order_relaxed);
+            slot.start_ns.store(event.start_ns, std::memory_order_relaxed);
+            slot.duration_ns.store(event.duration_ns, std::memory_order_relaxed);
+            b.head.store(head + 1, std::memory_order_release);
+        }
+
+        // Labels the calling thread's track in exported traces, from its first span on
+        void set_thread_name(const std::string &name)
+        {
+            auto &owner = local_owner();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            owner.name = name;
+            if (owner.buffer)
+                owner.buffer->name = name;
+        }
+
+        // The buffered events of one thread, oldest first
+        struct Track
+        {
+            int tid{0};
+            std::string name;
+            std::vector<TraceEvent> events;
+        };
+
+        [[nodiscard]] std::vector<Track> snapshot() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::vector<Track> tracks;
+            for (const auto &b : m_buffers)
+            {
+                Track track{b->tid, b->name, {}};
+                auto head = b->head.load(std::memory_order_acquire);
+                auto first = std::max(b->cleared, head > kCapacity ? head - kCapacity : 0);
+                for (auto i = first; i < head; ++i)
+                {
+                    const auto &slot = b->events[i % kCapacity];
+                    track.events.push_back({slot.name.load(std::memory_order_relaxed),
+                                            slot.category.load(std::memory_order_relaxed),
+                                            slot.start_ns.load(std::memory_order_relaxed),
+                                            slot.duration_ns.load(std::memory_order_relaxed)});
+                }
+
+                // Drop whatever the owner overwrote while it was being copied
+                auto overwritten = b->head.load(std::memory_order_acquire);
+                if (overwritten > first + kCapacity)
+                {
+                    auto lost = std::min<std::size_t>(overwritten - first - kCapacity, track.events.size());
+                    track.events.erase(track.events.begin(), track.events.begin() + static_cast<std::ptrdiff_t>(lost));
+                }
+                tracks.push_back(std::move(track));
+            }
+            return tracks;
+        }
+
+        // Forgets every event buffered so far; later spans are kept
+        void clear()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto &b : m_buffers)
+                b->cleared = b->head.load(std::memory_order_acquire);
+        }
+
+        // {"traceEvents": [...]} with one complete ("X") event per span and a name per thread
+        [[nodiscard]] std::string to_json() const
+        {
+            std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+            bool first = true;
+            auto separator = [&]()
+            {
+                if (!first)
+                    out.push_back(',');
+                first = false;
+            };
+
+            for (const auto &track : snapshot())
+            {
+                separator();
+                out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + std::to_string(track.tid) +
+                       ",\"args\":{\"name\":";
+                append_string(out, track.name.empty() ? "thread " + std::to_string(track.tid) : track.name);
+                out += "}}";
+
+                for (const auto &event : track.events)
+                {
+                    separator();
+                    out += "{\"name\":";
+                    append_string(out, event.name ? event.name : "");
+                    out += ",\"cat\":";
+                    append_string(out, event.category ? event.category : "");
+                    out += ",\"ph\":\"X\",\"pid\":1,\"tid\":" + std::to_string(track.tid) + ",\"ts\":";
+                    append_micros(out, event.start_ns);
+                    out += ",\"dur\":";
+                    append_micros(out, event.duration_ns);
+                    out.push_back('}');
+                }
+            }
+            out += "]}";
+            return out;
+        }
+
+    private:
+        struct Slot
+        {
+            std::atomic<const char *> name{nullptr};
+            std::atomic<const char *> category{nullptr};
+            std::atomic<std::int64_t> start_ns{0};
+            std::atomic<std::int64_t> duration_ns{0};
+        };
+
+        struct Buffer
+        {
+            std::array<Slot, kCapacity> events{};
+            std::atomic<std::size_t> head{0}; // Events ever recorded; only the owner writes it
+            std::size_t cleared{0};           // Events before this were cleared; guarded by m_mutex
+            int tid{0};
+            std::string name; // Guarded by m_mutex
+        };
+
+        // The calling thread's ring and name; hands the ring back when the thread exits
+        struct Owner
+        {
+            Buffer *buffer{nullptr};
+            std::string name;
+
+            ~Owner()
+            {
+                if (buffer)
+                    Tracer::instance().release(*buffer);
+            }
+        };
+
+        Tracer() = default;
+
+        static Owner &local_owner()
+        {
+            thread_local Owner owner;
+            return owner;
+        }
+
+        Buffer &buffer()
+        {
+            auto &owner = local_owner();
+            if (!owner.buffer)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_free.empty())
+                {
+                    owner.buffer = m_free.back();
+                    m_free.pop_back();
+                }
+                else
+                {
+                    m_buffers.push_back(std::make_unique<Buffer>());
+                    owner.buffer = m_buffers.back().get();
+                    owner.buffer->tid = static_cast<int>(m_buffers.size());
+                }
+                owner.buffer->name = owner.name;
+            }
+            return *owner.buffer;
+        }
+
+        void release(Buffer &buffer)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_free.push_back(&buffer);
+        }
+
+        static void append_string(std::string &out, const std::string &text)
+        {
+            out.push_back('"');
+            for (char c : text)
+            {
+                if (c == '"' || c == '\\')
+                {
+                    out.push_back('\\');
+                    out.push_back(c);
+                }
+                else if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out += escaped;
+                }
+                else
+                {
+                    out.push_back(c);
+                }
+            }
+            out.push_back('"');
+        }
+
+        // Trace timestamps are microseconds; keep the nanoseconds as three decimals
+        static void append_micros(std::string &out, std::int64_t ns)
+        {
+            out += std::to_string(ns / 1000);
+            auto fraction = ns % 1000;
+            if (fraction != 0)
+            {
+                char digits[8];
+                std::snprintf(digits, sizeof(digits), ".%03d", static_cast<int>(fraction < 0 ? -fraction : fraction));
+                out += digits;
+            }
+        }
+
+        std::atomic<bool> m_enabled{false};
+        std::chrono::steady_clock::time_point m_epoch{std::chrono::steady_clock::now()};
+        mutable std::mutex m_mutex;
+        std::vector<std::unique_ptr<Buffer>> m_buffers;
+        std::vector<Buffer *> m_free; // Rings of exited threads, waiting for a new owner
+    };
+
+    // Records the lifetime of the enclosing scope as one trace event, if tracing is enabled
+    class TraceSpan
+    {
+    public:
+#if CHAINSIM_ENABLE_TRACING
+        TraceSpan(const char *name, const char *category)
+            : m_name{name}, m_category{category},
+              m_start{Tracer::instance().enabled() ? Tracer::instance().now_ns() : kInactive}
+        {
+        }
+
+        ~TraceSpan()
+        {
+            if (m_start != kInactive)
+            {
+                auto &tracer = Tracer::instance();
+                tracer.record({m_name, m_category, m_start, tracer.now_ns() - m_start});
+            }
+        }
+#else
+        TraceSpan(const char *, const char *) {}
+#endif
+
+        TraceSpan(const TraceSpan &) = delete;
+        TraceSpan &operator=(const TraceSpan &) = delete;
+
+#if CHAINSIM_ENABLE_TRACING
+    private:
+        static constexpr std::int64_t kInactive = -1;
+
+        const char *m_name;
+        const char *m_category;
+        std::int64_t m_start;
+#endif
+    };
+
+} // namespace qz
+
+#endif // CHAINSIM_TRACE_HPP
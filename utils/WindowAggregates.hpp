@@ -0,0 +1,211 @@
+#ifndef CHAINSIM_WINDOWAGGREGATES_HPP
+#define CHAINSIM_WINDOWAGGREGATES_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace qz
+{
+
+    /* Windowed aggregates of a day-indexed column, all derived from its prefix sums.
+     *
+     * prefix[i] is the sum of days [0, i), so any window sum is one subtraction and a whole
+     * series of them is a single pass of independent differences over contiguous arrays, which
+     * the compiler vectorizes. Windows ending on day d cover days (d - window, d], clipped at
+     * day 0, so the first window - 1 days are averaged over the days that exist.
+     */
+
+    template <typename T>
+    std::vector<std::int64_t> prefix_sums(const T *values, std::size_t count)
+    {
+        std::vector<std::int64_t> prefix(count + 1);
+        prefix[0] = 0;
+        for (std::size_t i = 0; i < count; ++i)
+            prefix[i + 1] = prefix[i] + static_cast<std::int64_t>(values[i]);
+        return prefix;
+    }
+
+    // Sums of the windows ending on days [first, last]
+    inline std::vector<std::int64_t> rolling_sums(const std::vector<std::int64_t> &prefix, std::size_t window,
+                                                  std::size_t first, std::size_t last)
+    {
+        std::vector<std::int64_t> sums(last - first + 1);
+        // Days whose window is clipped at day 0 start from prefix[0]
+        std::size_t clipped = std::min(last + 1, std::max(first, window - 1)) - first;
+        for (std::size_t i = 0; i < clipped; ++i)
+            sums[i] = prefix[first + i + 1];
+
+        for (std::size_t i = clipped; i < sums.size(); ++i)
+        {
+            auto end = first + i + 1;
+            sums[i] = prefix[end] - prefix[end - window];
+        }
+        return sums;
+    }
+
+    // Means of the windows ending on days [first, last]
+    inline std::vector<double> rolling_means(const std::vector<std::int64_t> &prefix, std::size_t window,
+                                             std::size_t first, std::size_t last)
+    {
+        auto sums = rolling_sums(prefix, window, first, last);
+        std::vector<double> means(sums.size());
+        for (std::size_t i = 0; i < sums.size(); ++i)
+        {
+            auto days = std::min(window, first + i + 1);
+            means[i] = static_cast<double>(sums[i]) / static_cast<double>(days);
+        }
+        return means;
+    }
+
+    // 100 * numerator / denominator per window; windows without demand are fully served
+    inline std::vector<double> rolling_percent(const std::vector<std::int64_t> &numerator,
+                                               const std::vector<std::int64_t> &denominator,
+                                               std::size_t window, std::size_t first, std::size_t last)
+    {
+        auto served = rolling_sums(numerator, window, first, last);
+        auto total = rolling_sums(denominator, window, first, last);
+        std::vector<double> percent(served.size());
+        for (std::size_t i = 0; i < served.size(); ++i)
+        {
+            percent[i] = total[i] > 0 ? 100.0 * static_cast<double>(served[i]) / static_cast<double>(total[i])
+                                      : 100.0;
+        }
+        return percent;
+    }
+
+    // Running totals from day 0 through each of days [first, last]
+    inline std::vector<std::int64_t> cumulative_sums(const std::vector<std::int64_t> &prefix, std::size_t first,
+                                                     std::size_t last)
+    {
+        return std::vector<std::int64_t>(prefix.begin() + static_cast<std::ptrdiff_t>(first + 1),
+                                         prefix.begin() + static_cast<std::ptrdiff_t>(last + 2));
+    }
+
+    // Totals of consecutive `period`-day buckets starting on day `first`; the last may be shorter
+    inline std::vector<std::int64_t> period_sums(const std::vector<std::int64_t> &prefix, std::size_t period,
+                                                 std::size_t first, std::size_t last)
+    {
+        std::vector<std::int64_t> sums((last - first) / period + 1);
+        for (std::size_t k = 0; k < sums.size(); ++k)
+        {
+            auto begin = first + k * period;
+            auto end = std::min(begin + period, last + 1);
+            sums[k] = prefix[end] - prefix[begin];
+        }
+        return sums;
+    }
+
+    /* One requested aggregate, written `kind:column:days` (`fill_rate:days`, `cumulative:column`):
+     *   rolling_sum:lost_sale_quantity:30   rolling_mean:inventory_quantity:7
+     *   fill_rate:7 (sale over demand quantity, %)   cumulative:lost_sale_quantity
+     *   period_sum:purchase_quantity:7 (one total per 7 days)
+     */
+    struct WindowSpec
+    {
+        enum class Kind
+        {
+            RollingSum,
+            RollingMean,
+            FillRate,
+            Cumulative,
+            PeriodSum
+        };
+
+        Kind kind{Kind::RollingMean};
+        std::string column; // Empty for fill_rate, which reads sale and demand quantities
+        std::size_t days{1};
+        std::string name; // The spec as written; keys the series in responses
+    };
+
+    // Fill rate, 7- and 30-day moving inventory, cumulative lost sales and weekly purchases
+    constexpr const char *kDefaultWindowSpecs =
+        "fill_rate:7,rolling_mean:inventory_quantity:7,rolling_mean:inventory_quantity:30,"
+        "cumulative:lost_sale_quantity,period_sum:purchase_quantity:7";
+
+    // Longest window or period accepted, and most aggregates per request
+    constexpr std::size_t kMaxWindowDays = 36500;
+    constexpr std::size_t kMaxWindowSpecs = 32;
+
+    inline std::vector<WindowSpec> parse_window_specs(std::string_view text)
+    {
+        auto split = [](std::string_view s, char separator)
+        {
+            std::vector<std::string_view> parts;
+            std::size_t start = 0;
+            while (start <= s.size())
+            {
+                auto end = std::min(s.find(separator, start), s.size());
+                parts.push_back(s.substr(start, end - start));
+                start = end + 1;
+            }
+            return parts;
+        };
+
+        auto parse_days = [](std::string_view s, std::string_view spec)
+        {
+            std::size_t days = 0;
+            bool valid = !s.empty() && s.size() <= 6;
+            for (char c : s)
+            {
+                valid = valid && c >= '0' && c <= '9';
+                days = days * 10 + static_cast<std::size_t>(c - '0');
+            }
+            if (!valid || days == 0 || days > kMaxWindowDays)
+                throw std::invalid_argument("Window days must be between 1 and " + std::to_string(kMaxWindowDays) +
+                                            " in '" + std::string(spec) + "'");
+            return days;
+        };
+
+        std::vector<WindowSpec> specs;
+        for (auto item : split(text, ','))
+        {
+            if (item.empty())
+                continue;
+
+            auto fields = split(item, ':');
+            WindowSpec spec;
+            spec.name = std::string(item);
+            auto kind = fields[0];
+            if (kind == "fill_rate" && fields.size() == 2)
+            {
+                spec.kind = WindowSpec::Kind::FillRate;
+                spec.days = parse_days(fields[1], item);
+            }
+            else if (kind == "cumulative" && fields.size() == 2 && !fields[1].empty())
+            {
+                spec.kind = WindowSpec::Kind::Cumulative;
+                spec.column = std::string(fields[1]);
+            }
+            else if ((kind == "rolling_sum" || kind == "rolling_mean" || kind == "period_sum") &&
+                     fields.size() == 3 && !fields[1].empty())
+            {
+                spec.kind = kind == "rolling_sum"    ? WindowSpec::Kind::RollingSum
+                            : kind == "rolling_mean" ? WindowSpec::Kind::RollingMean
+                                                     : WindowSpec::Kind::PeriodSum;
+                spec.column = std::string(fields[1]);
+                spec.days = parse_days(fields[2], item);
+            }
+            else
+            {
+                throw std::invalid_argument("Invalid aggregate '" + std::string(item) +
+                                            "': expected rolling_sum|rolling_mean|period_sum:column:days, "
+                                            "fill_rate:days or cumulative:column");
+            }
+            specs.push_back(std::move(spec));
+        }
+
+        if (specs.empty())
+            throw std::invalid_argument("No aggregates requested");
+        if (specs.size() > kMaxWindowSpecs)
+            throw std::invalid_argument("At most " + std::to_string(kMaxWindowSpecs) + " aggregates per request");
+        return specs;
+    }
+
+} // namespace qz
+
+#endif // CHAINSIM_WINDOWAGGREGATES_HPP
@@ -0,0 +1,395 @@
+#ifndef CHAINSIM_WIREPROTOCOL_HPP
+#define CHAINSIM_WIREPROTOCOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "KpiAccumulator.hpp"
+
+namespace qz::wire
+{
+
+    /* Length-prefixed binary protocol for programmatic /simulate clients.
+     *
+     * Every message is a frame: a u32 payload length followed by the payload. All integers and
+     * doubles are little-endian (IEEE 754). A payload starts with its type (u8) and the request
+     * id (u32) the client chose; responses echo the id, so a client may pipeline any number of
+     * requests on one connection and match the answers, which come back in request order.
+     *
+     *   Simulate  type=1, id, policy u8, distribution u8, flags u8, simulation_length u32,
+     *             lead_time u32, seed u32, starting_inventory u64, average_demand f64,
+     *             std_demand f64, gamma_shape f64, gamma_scale f64, uniform_min f64,
+     *             uniform_max f64, ordering_cost f64, holding_cost f64, purchase_period u32
+     *   Result    type=2, id, the SimulationKpis fields in declaration order (8 bytes each),
+     *             column count u16, then per column: name length u8, name, day count u32, i64 values
+     *   Error     type=3, id, message length u16, UTF-8 message
+     *
+     * Fields that do not apply to the chosen policy or distribution are ignored, exactly as
+     * /simulate ignores the query parameters it does not need. With kSummaryOnly the result
+     * carries no columns.
+     */
+
+    enum class MessageType : std::uint8_t
+    {
+        Simulate = 1,
+        Result = 2,
+        Error = 3
+    };
+
+    enum class Policy : std::uint8_t
+    {
+        ROP = 0,
+        EOQ = 1,
+        TPOP = 2
+    };
+
+    enum class Distribution : std::uint8_t
+    {
+        Fixed = 0,
+        Normal = 1,
+        Gamma = 2,
+        Poisson = 3,
+        Uniform = 4
+    };
+
+    constexpr std::uint8_t kDeterministic = 1u << 0;
+    constexpr std::uint8_t kSummaryOnly = 1u << 1;
+
+    constexpr std::size_t kLengthBytes = 4;
+    constexpr std::size_t kSimulateBytes = 1 + 4 + 3 + 3 * 4 + 8 + 8 * 8 + 4;
+    // Requests are fixed-size; anything much larger is a client speaking another protocol
+    constexpr std::size_t kMaxRequestBytes = 4096;
+    // Type, id, KPIs and column count of a Result frame
+    constexpr std::size_t kResultHeaderBytes = 1 + 4 + 7 * 8 + 6 * 8 + 2 * 8 + 2;
+    // Largest Result a server builds; clients buffer a frame whole, and the prefix stops at 4 GiB
+    constexpr std::uint64_t kMaxResultBytes = std::uint64_t{1} << 30;
+
+    // Upper bound on the payload of a Result with `columns` columns of `days` values
+    constexpr std::uint64_t result_bytes(std::uint64_t columns, std::uint64_t days)
+    {
+        return kResultHeaderBytes + columns * (1 + 0xff + 4 + 8 * days);
+    }
+
+    struct SimulateRequest
+    {
+        std::uint32_t id{0};
+        Policy policy{Policy::ROP};
+        Distribution distribution{Distribution::Normal};
+        std::uint8_t flags{0};
+        std::uint32_t simulation_length{0};
+        std::uint32_t lead_time{0};
+        std::uint32_t seed{0};
+        std::uint64_t starting_inventory{0};
+        double average_demand{0.0};
+        double std_demand{0.0};
+        double gamma_shape{0.0};
+        double gamma_scale{0.0};
+        double uniform_min{0.0};
+        double uniform_max{0.0};
+        double ordering_cost{0.0};
+        double holding_cost{0.0};
+        std::uint32_t purchase_period{0};
+    };
+
+    struct Response
+    {
+        MessageType type{MessageType::Result};
+        std::uint32_t id{0};
+        SimulationKpis kpis;
+        std::vector<std::pair<std::string, std::vector<std::int64_t>>> columns;
+        std::string error;
+    };
+
+    // Appends frames to `out`; a frame's length is patched in when it ends
+    class Writer
+    {
+    public:
+        explicit Writer(std::string &out) : m_out{out} {}
+
+        void begin_frame()
+        {
+            m_frame = m_out.size();
+            m_out.append(kLengthBytes, '\0');
+        }
+
+        void end_frame()
+        {
+            auto size = m_out.size() - m_frame - kLengthBytes;
+            if (size > 0xffffffffu)
+                throw std::invalid_argument("Frame too large for its length prefix");
+            auto length = static_cast<std::uint32_t>(size);
+            for (std::size_t i = 0; i < kLengthBytes; ++i)
+                m_out[m_frame + i] = static_cast<char>((length >> (8 * i)) & 0xff);
+        }
+
+        void u8(std::uint8_t value) { m_out.push_back(static_cast<char>(value)); }
+        void u16(std::uint16_t value) { append(value, 2); }
+        void u32(std::uint32_t value) { append(value, 4); }
+        void u64(std::uint64_t value) { append(value, 8); }
+        void i64(std::int64_t value) { append(static_cast<std::uint64_t>(value), 8); }
+
+        void f64(double value)
+        {
+            std::uint64_t bits;
+            std::memcpy(&bits, &value, sizeof bits);
+            append(bits, 8);
+        }
+
+        void bytes(std::string_view data) { m_out.append(data.data(), data.size()); }
+        void reserve(std::size_t more) { m_out.reserve(m_out.size() + more); }
+
+    private:
+        void append(std::uint64_t value, std::size_t width)
+        {
+            for (std::size_t i = 0; i < width; ++i)
+                m_out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+        }
+
+        std::string &m_out;
+        std::size_t m_frame{0};
+    };
+
+    // Bounds-checked reads from one payload; running past its end throws std::invalid_argument
+    class Reader
+    {
+    public:
+        Reader(const char *data, std::size_t size) : m_data{data}, m_size{size} {}
+
+        std::uint8_t u8() { return static_cast<std::uint8_t>(read(1)); }
+        std::uint16_t u16() { return static_cast<std::uint16_t>(read(2)); }
+        std::uint32_t u32() { return static_cast<std::uint32_t>(read(4)); }
+        std::uint64_t u64() { return read(8); }
+        std::int64_t i64() { return static_cast<std::int64_t>(read(8)); }
+
+        double f64()
+        {
+            auto bits = read(8);
+            double value;
+            std::memcpy(&value, &bits, sizeof value);
+            return value;
+        }
+
+        std::string_view bytes(std::size_t count)
+        {
+            require(count);
+            std::string_view view(m_data + m_offset, count);
+            m_offset += count;
+            return view;
+        }
+
+        [[nodiscard]] std::size_t remaining() const { return m_size - m_offset; }
+
+    private:
+        void require(std::size_t count) const
+        {
+            if (count > m_size - m_offset)
+                throw std::invalid_argument("Truncated message");
+        }
+
+        std::uint64_t read(std::size_t width)
+        {
+            require(width);
+            std::uint64_t value = 0;
+            for (std::size_t i = 0; i < width; ++i)
+                value |= static_cast<std::uint64_t>(static_cast<unsigned char>(m_data[m_offset + i])) << (8 * i);
+            m_offset += width;
+            return value;
+        }
+
+        const char *m_data;
+        std::size_t m_size;
+        std::size_t m_offset{0};
+    };
+
+    /* Size of the complete frame at the front of `data`, or 0 while more bytes are needed.
+     * Throws std::invalid_argument if the announced payload exceeds `max_payload`; the stream
+     * cannot be resynchronized after that, so the connection should be dropped.
+     */
+    inline std::size_t frame_size(const char *data, std::size_t available, std::size_t max_payload)
+    {
+        if (available < kLengthBytes)
+            return 0;
+        auto length = Reader(data, kLengthBytes).u32();
+        if (length > max_payload)
+            throw std::invalid_argument("Frame exceeds the maximum message size");
+        return available - kLengthBytes < length ? 0 : kLengthBytes + length;
+    }
+
+    // The id of a request payload, even one that fails to decode (0 if too short to carry one)
+    inline std::uint32_t peek_id(const char *payload, std::size_t size)
+    {
+        return size < 5 ? 0 : Reader(payload + 1, 4).u32();
+    }
+
+    inline void encode_request(std::string &out, const SimulateRequest &request)
+    {
+        Writer writer(out);
+        writer.begin_frame();
+        writer.u8(static_cast<std::uint8_t>(MessageType::Simulate));
+        writer.u32(request.id);
+        writer.u8(static_cast<std::uint8_t>(request.policy));
+        writer.u8(static_cast<std::uint8_t>(request.distribution));
+        writer.u8(request.flags);
+        writer.u32(request.simulation_length);
+        writer.u32(request.lead_time);
+        writer.u32(request.seed);
+        writer.u64(request.starting_inventory);
+        writer.f64(request.average_demand);
+        writer.f64(request.std_demand);
+        writer.f64(request.gamma_shape);
+        writer.f64(request.gamma_scale);
+        writer.f64(request.uniform_min);
+        writer.f64(request.uniform_max);
+        writer.f64(request.ordering_cost);
+        writer.f64(request.holding_cost);
+        writer.u32(request.purchase_period);
+        writer.end_frame();
+    }
+
+    inline SimulateRequest decode_request(const char *payload, std::size_t size)
+    {
+        if (size != kSimulateBytes)
+            throw std::invalid_argument("Malformed request: wrong size for a simulate message");
+
+        Reader reader(payload, size);
+        if (reader.u8() != static_cast<std::uint8_t>(MessageType::Simulate))
+            throw std::invalid_argument("Unsupported message type");
+
+        SimulateRequest request;
+        request.id = reader.u32();
+        auto policy = reader.u8();
+        auto distribution = reader.u8();
+        if (policy > static_cast<std::uint8_t>(Policy::TPOP))
+            throw std::invalid_argument("Unsupported policy");
+        if (distribution > static_cast<std::uint8_t>(Distribution::Uniform))
+            throw std::invalid_argument("Invalid demand distribution");
+        request.policy = static_cast<Policy>(policy);
+        request.distribution = static_cast<Distribution>(distribution);
+        request.flags = reader.u8();
+        request.simulation_length = reader.u32();
+        request.lead_time = reader.u32();
+        request.seed = reader.u32();
+        request.starting_inventory = reader.u64();
+        request.average_demand = reader.f64();
+        request.std_demand = reader.f64();
+        request.gamma_shape = reader.f64();
+        request.gamma_scale = reader.f64();
+        request.uniform_min = reader.f64();
+        request.uniform_max = reader.f64();
+        request.ordering_cost = reader.f64();
+        request.holding_cost = reader.f64();
+        request.purchase_period = reader.u32();
+        return request;
+    }
+
+    /* Writes a Result frame's header and KPIs; the caller then writes `columns` columns with
+     * write_column and closes the frame with end_frame().
+     */
+    inline void begin_result(Writer &writer, std::uint32_t id, const SimulationKpis &kpis, std::uint16_t columns)
+    {
+        writer.begin_frame();
+        writer.u8(static_cast<std::uint8_t>(MessageType::Result));
+        writer.u32(id);
+        writer.u64(kpis.days);
+        writer.i64(kpis.total_demand);
+        writer.i64(kpis.total_sales);
+        writer.i64(kpis.total_lost_sales);
+        writer.i64(kpis.total_purchases);
+        writer.u64(kpis.order_count);
+        writer.u64(kpis.stockout_days);
+        writer.f64(kpis.service_level);
+        writer.f64(kpis.average_inventory);
+        writer.f64(kpis.inventory_stddev);
+        writer.f64(kpis.average_demand);
+        writer.f64(kpis.demand_stddev);
+        writer.f64(kpis.inventory_turns);
+        writer.i64(kpis.peak_inventory);
+        writer.i64(kpis.min_inventory);
+        writer.u16(columns);
+    }
+
+    // T is any 64-bit integer type (qint64 and std::int64_t differ on some platforms)
+    template <typename T>
+    void write_column(Writer &writer, std::string_view name, const T *values, std::uint32_t count)
+    {
+        static_assert(std::is_integral_v<T> && sizeof(T) == 8, "columns hold 64-bit integers");
+        if (name.size() > 0xff)
+            throw std::invalid_argument("Column name too long");
+        writer.u8(static_cast<std::uint8_t>(name.size()));
+        writer.bytes(name);
+        writer.u32(count);
+        writer.reserve(8 * std::size_t{count});
+        for (std::uint32_t i = 0; i < count; ++i)
+            writer.i64(static_cast<std::int64_t>(values[i]));
+    }
+
+    inline void encode_error(std::string &out, std::uint32_t id, std::string_view message)
+    {
+        message = message.substr(0, 0xffff);
+        Writer writer(out);
+        writer.begin_frame();
+        writer.u8(static_cast<std::uint8_t>(MessageType::Error));
+        writer.u32(id);
+        writer.u16(static_cast<std::uint16_t>(message.size()));
+        writer.bytes(message);
+        writer.end_frame();
+    }
+
+    // Client side: decodes a Result or Error payload
+    inline Response decode_response(const char *payload, std::size_t size)
+    {
+        Reader reader(payload, size);
+        Response response;
+        auto type = reader.u8();
+        response.id = reader.u32();
+        if (type == static_cast<std::uint8_t>(MessageType::Error))
+        {
+            response.type = MessageType::Error;
+            response.error = std::string(reader.bytes(reader.u16()));
+            return response;
+        }
+        if (type != static_cast<std::uint8_t>(MessageType::Result))
+            throw std::invalid_argument("Unsupported message type");
+
+        auto &kpis = response.kpis;
+        kpis.days = reader.u64();
+        kpis.total_demand = reader.i64();
+        kpis.total_sales = reader.i64();
+        kpis.total_lost_sales = reader.i64();
+        kpis.total_purchases = reader.i64();
+        kpis.order_count = reader.u64();
+        kpis.stockout_days = reader.u64();
+        kpis.service_level = reader.f64();
+        kpis.average_inventory = reader.f64();
+        kpis.inventory_stddev = reader.f64();
+        kpis.average_demand = reader.f64();
+        kpis.demand_stddev = reader.f64();
+        kpis.inventory_turns = reader.f64();
+        kpis.peak_inventory = reader.i64();
+        kpis.min_inventory = reader.i64();
+
+        auto columns = reader.u16();
+        response.columns.reserve(columns);
+        for (std::uint16_t c = 0; c < columns; ++c)
+        {
+            std::string name(reader.bytes(reader.u8()));
+            auto count = reader.u32();
+            if (count > reader.remaining() / 8)
+                throw std::invalid_argument("Truncated message");
+            std::vector<std::int64_t> values(count);
+            for (auto &value : values)
+                value = reader.i64();
+            response.columns.emplace_back(std::move(name), std::move(values));
+        }
+        return response;
+    }
+
+} // namespace qz::wire
+
+#endif // CHAINSIM_WIREPROTOCOL_HPP